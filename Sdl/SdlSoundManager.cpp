@@ -22,7 +22,29 @@ void SdlSoundManager::FillAudioBuffer(void *userData, uint8_t *stream, int len)
 {
 	SdlSoundManager* soundManager = (SdlSoundManager*)userData;
 
-	soundManager->ReadFromBuffer(stream, len);
+	if(!AudioProfiler::IsEnabled()) {
+		soundManager->_buffer.Read(stream, len);
+		soundManager->_lastCallbackTime = 0;
+		return;
+	}
+
+	uint64_t start = AudioProfiler::GetTimestamp();
+	if(soundManager->_lastCallbackTime) {
+		uint64_t interval = start - soundManager->_lastCallbackTime;
+		uint64_t period = soundManager->_callbackPeriod;
+		AudioProfiler::Record(AudioStage::CallbackInterval, interval);
+		AudioProfiler::Record(AudioStage::CallbackJitter, interval > period ? interval - period : period - interval);
+	}
+	soundManager->_lastCallbackTime = start;
+
+	//Amount of audio (in ns) left in the buffer when the device asks for more
+	uint32_t bytesPerSample = 2 * (soundManager->_isStereo ? 2 : 1);
+	uint64_t fillLevel = soundManager->_buffer.GetFillLevel();
+	AudioProfiler::Record(AudioStage::RingFill, fillLevel * 1000000000 / (bytesPerSample * soundManager->_sampleRate));
+
+	soundManager->_buffer.Read(stream, len);
+
+	AudioProfiler::Record(AudioStage::DeviceCallback, AudioProfiler::GetTimestamp() - start);
 }
 
 void SdlSoundManager::Release()
@@ -31,12 +53,6 @@ void SdlSoundManager::Release()
 		Stop();
 		SDL_CloseAudioDevice(_audioDeviceID);
 	}
-
-	if(_buffer) {
-		delete[] _buffer;
-		_buffer = nullptr;
-		_bufferSize = 0;
-	}
 }
 
 bool SdlSoundManager::InitializeAudio(uint32_t sampleRate, bool isStereo)
@@ -52,18 +68,26 @@ bool SdlSoundManager::InitializeAudio(uint32_t sampleRate, bool isStereo)
 	_isStereo = isStereo;
 	_previousLatency = _emu->GetSettings()->GetAudioConfig().AudioLatency;
 
-	int bytesPerSample = 2 * (isStereo ? 2 : 1);
-	int32_t requestedByteLatency = (int32_t)((float)(sampleRate * _previousLatency) / 1000.0f * bytesPerSample);
-	_bufferSize = (int32_t)std::ceil((double)requestedByteLatency * 2 / 0x10000) * 0x10000;
-	_buffer = new uint8_t[_bufferSize];
-	memset(_buffer, 0, _bufferSize);
+	//The buffer has room for twice the largest latency that can be requested without reinitializing the device
+	_buffer.Init(std::max(GetByteLatency(_previousLatency) * 2, (uint32_t)0x10000));
+	_bufferSize = _buffer.GetCapacity();
+	_lastUnderrunCount = 0;
+	_playing = false;
+
+	_resampler.Reset();
+	_rateAdjustment = 0.0;
+	_rateDrift = 0.0;
+	_smoothedLatency = 0.0;
+	_lastWriteSize = 0;
+
+	uint32_t callbackSamples = GetCallbackSampleCount(_previousLatency);
 
 	SDL_AudioSpec audioSpec;
 	SDL_memset(&audioSpec, 0, sizeof(audioSpec));
 	audioSpec.freq = sampleRate;
 	audioSpec.format = AUDIO_S16SYS; //16-bit samples
 	audioSpec.channels = isStereo ? 2 : 1;
-	audioSpec.samples = 1024;
+	audioSpec.samples = callbackSamples;
 	audioSpec.callback = &SdlSoundManager::FillAudioBuffer;
 	audioSpec.userdata = this;
 
@@ -75,11 +99,12 @@ bool SdlSoundManager::InitializeAudio(uint32_t sampleRate, bool isStereo)
 		_audioDeviceID = SDL_OpenAudioDevice(nullptr, isCapture, &audioSpec, &obtainedSpec, 0);
 	}
 
-	_writePosition = 0;
-	_readPosition = 0;
-
 	_needReset = false;
 
+	_lastCallbackTime = 0;
+	_callbackSamples = callbackSamples;
+	_callbackPeriod = _audioDeviceID != 0 ? (uint64_t)obtainedSpec.samples * 1000000000 / obtainedSpec.freq : 0;
+
 	return _audioDeviceID != 0;
 }
 
@@ -117,54 +142,87 @@ void SdlSoundManager::SetAudioDevice(string deviceName)
 	}
 }
 
-void SdlSoundManager::ReadFromBuffer(uint8_t* output, uint32_t len)
+uint32_t SdlSoundManager::GetByteLatency(uint32_t latency)
 {
-	if(_readPosition + len < _bufferSize) {
-		memcpy(output, _buffer+_readPosition, len);
-		_readPosition += len;
-	} else {
-		int remainingBytes = (_bufferSize - _readPosition);
-		memcpy(output, _buffer+_readPosition, remainingBytes);
-		memcpy(output+remainingBytes, _buffer, len - remainingBytes);
-		_readPosition = len - remainingBytes;
-	}
+	uint32_t bytesPerSample = 2 * (_isStereo ? 2 : 1);
+	return (uint32_t)((float)(_sampleRate * latency) / 1000.0f * bytesPerSample);
+}
 
-	if(_readPosition >= _writePosition && _readPosition - _writePosition < _bufferSize / 2) {
-		_bufferUnderrunEventCount++;
+uint32_t SdlSoundManager::GetCallbackSampleCount(uint32_t latency)
+{
+	//Smaller callback periods are needed for low latencies (the buffer must not run dry between 2 callbacks)
+	uint32_t callbackSamples = 1024;
+	while(callbackSamples > 256 && callbackSamples * 4 > _sampleRate * latency / 1000) {
+		callbackSamples /= 2;
 	}
+	return callbackSamples;
 }
 
-void SdlSoundManager::WriteToBuffer(uint8_t* input, uint32_t len)
+uint32_t SdlSoundManager::Resample(int16_t* soundBuffer, uint32_t sampleCount)
 {
-	if(_writePosition + len < _bufferSize) {
-		memcpy(_buffer+_writePosition, input, len);
-		_writePosition += len;
-	} else {
-		int remainingBytes = _bufferSize - _writePosition;
-		memcpy(_buffer+_writePosition, input, remainingBytes);
-		memcpy(_buffer, ((uint8_t*)input)+remainingBytes, len - remainingBytes);
-		_writePosition = len - remainingBytes;
+	AudioStageTimer timer(AudioStage::Resample);
+
+	int16_t* input = soundBuffer;
+	if(!_isStereo) {
+		//The resampler only supports stereo samples
+		_stereoBuffer.resize(sampleCount * 2);
+		for(uint32_t i = 0; i < sampleCount; i++) {
+			_stereoBuffer[i * 2] = soundBuffer[i];
+			_stereoBuffer[i * 2 + 1] = soundBuffer[i];
+		}
+		input = _stereoBuffer.data();
+	}
+
+	//Playing the samples at a higher rate than the device's produces more samples, which increases the latency
+	_resampler.SetSampleRates(_sampleRate, _sampleRate * (1.0 + _rateAdjustment));
+
+	uint32_t maxSampleCount = (uint32_t)(sampleCount * (1.0 + MaxRateAdjustment)) + 2;
+	_resampleBuffer.resize(maxSampleCount * 2);
+	uint32_t outSampleCount = _resampler.Resample<false>(input, sampleCount, _resampleBuffer.data(), maxSampleCount);
+
+	if(!_isStereo) {
+		for(uint32_t i = 0; i < outSampleCount; i++) {
+			_resampleBuffer[i] = _resampleBuffer[i * 2];
+		}
 	}
+	return outSampleCount;
 }
+
 void SdlSoundManager::PlayBuffer(int16_t *soundBuffer, uint32_t sampleCount, uint32_t sampleRate, bool isStereo)
 {
 	uint32_t bytesPerSample = 2 * (isStereo ? 2 : 1);
 	uint32_t latency = _emu->GetSettings()->GetAudioConfig().AudioLatency;
-	if(_sampleRate != sampleRate || _isStereo != isStereo || _needReset || _previousLatency != latency) {
+	if(_sampleRate != sampleRate || _isStereo != isStereo || _needReset) {
 		Release();
 		InitializeAudio(sampleRate, isStereo);
+	} else if(_previousLatency != latency) {
+		if(GetByteLatency(latency) * 2 > _buffer.GetCapacity() || GetCallbackSampleCount(latency) < _callbackSamples) {
+			//The buffer is too small for the new latency, or the device's callback period is too long for it
+			Release();
+			InitializeAudio(sampleRate, isStereo);
+		} else {
+			//The rate control moves the latency to the new value
+			_previousLatency = latency;
+		}
 	}
 
-	WriteToBuffer((uint8_t*)soundBuffer, sampleCount * bytesPerSample);
+	uint32_t byteLatency = GetByteLatency(latency);
+	uint32_t emulationSpeed = _emu->GetSettings()->GetEmulationSpeed();
+	if(_playing && emulationSpeed <= 100 && emulationSpeed > 0 && _buffer.GetFillLevel() > byteLatency + GetByteLatency((uint32_t)MaxLatencyExcess)) {
+		//Latency is way off (e.g after fast forwarding), drop this frame's audio rather than waiting for the rate control to catch up
+		return;
+	}
 
-	int32_t byteLatency = (int32_t)((float)(sampleRate * latency) / 1000.0f * bytesPerSample);
-	int32_t playWriteByteLatency = _writePosition - _readPosition;
-	if(playWriteByteLatency < 0) {
-		playWriteByteLatency = _bufferSize - _readPosition + _writePosition;
+	uint32_t outSampleCount = Resample(soundBuffer, sampleCount);
+	{
+		AudioStageTimer timer(AudioStage::RingWrite);
+		_lastWriteSize = _buffer.Write((uint8_t*)_resampleBuffer.data(), outSampleCount * bytesPerSample);
 	}
 
-	if(playWriteByteLatency > byteLatency) {
+	if(!_playing && _buffer.GetFillLevel() > byteLatency) {
 		//Start playing
+		_playing = true;
+		_smoothedLatency = latency;
 		SDL_PauseAudioDevice(_audioDeviceID, 0);
 	}
 }
@@ -172,24 +230,81 @@ void SdlSoundManager::PlayBuffer(int16_t *soundBuffer, uint32_t sampleCount, uin
 void SdlSoundManager::Pause()
 {
 	SDL_PauseAudioDevice(_audioDeviceID, 1);
+	_playing = false;
+
+	//The time until the first callback after resuming is not part of the callback interval/jitter stats
+	SDL_LockAudioDevice(_audioDeviceID);
+	_lastCallbackTime = 0;
+	SDL_UnlockAudioDevice(_audioDeviceID);
 }
 
 void SdlSoundManager::Stop()
 {
 	Pause();
 
-	_readPosition = 0;
-	_writePosition = 0;
+	//Make sure the callback is not running while the read position is moved
+	SDL_LockAudioDevice(_audioDeviceID);
+	_buffer.Clear();
+	SDL_UnlockAudioDevice(_audioDeviceID);
 	ResetStats();
 }
 
+void SdlSoundManager::UpdateRateAdjustment(uint32_t fillLevel)
+{
+	//The fill level peaks when a frame is written, use the level halfway through the frame as the latency
+	uint32_t bytesPerSample = 2 * (_isStereo ? 2 : 1);
+	uint32_t averageFillLevel = fillLevel - std::min(fillLevel, _lastWriteSize / 2);
+	double latency = (double)averageFillLevel / bytesPerSample / _sampleRate * 1000;
+
+	//The fill level also varies by up to a callback period, smooth it out over several frames
+	_smoothedLatency += (latency - _smoothedLatency) * LatencySmoothing;
+
+	double error = (_smoothedLatency - _previousLatency) / MaxRateAdjustmentError * MaxRateAdjustment;
+	_rateDrift = std::clamp(_rateDrift - error * RateDriftGain, -MaxRateAdjustment, MaxRateAdjustment);
+	_rateAdjustment = std::clamp(_rateDrift - error, -MaxRateAdjustment, MaxRateAdjustment);
+}
+
 void SdlSoundManager::ProcessEndOfFrame()
 {
-	ProcessLatency(_readPosition, _writePosition);
+	AudioProfiler::Update();
+
+	//The ring buffer's positions wrap around at 2^32 rather than at the buffer's size, pass the fill level as the gap
+	AudioRingBuffer::Stats stats = _buffer.GetStats();
+	ProcessLatency(0, stats.FillLevel);
+
+	//Report the underruns that occurred in the callback since the last frame
+	uint32_t underrunCount = stats.UnderrunCount - _lastUnderrunCount;
+	_bufferUnderrunEventCount += underrunCount;
+	_lastUnderrunCount = stats.UnderrunCount;
+
+	if(!_playing) {
+		return;
+	}
 
 	uint32_t emulationSpeed = _emu->GetSettings()->GetEmulationSpeed();
-	if(_averageLatency > 0 && emulationSpeed <= 100 && emulationSpeed > 0 && std::abs(_averageLatency - _emu->GetSettings()->GetAudioConfig().AudioLatency) > 50) {
-		//Latency is way off (over 50ms gap), stop audio & start again
-		Stop();
+	if(underrunCount > 0 && stats.FillLevel == 0) {
+		//Buffer ran dry, pause until it is filled back up to the requested latency instead of playing fragments
+		Pause();
+	} else if(emulationSpeed <= 100 && emulationSpeed > 0) {
+		UpdateRateAdjustment(stats.FillLevel);
+	} else {
+		_rateAdjustment = 0.0;
 	}
 }
+
+AudioRingBuffer::Stats SdlSoundManager::GetBufferStats()
+{
+	return _buffer.GetStats();
+}
+
+string SdlSoundManager::ExportAudioProfile(AudioProfileFormat format)
+{
+	return AudioProfiler::Export(format, {
+		{ "sampleRate", _sampleRate },
+		{ "stereo", _isStereo ? 1 : 0 },
+		{ "callbackPeriodUs", _callbackPeriod / 1000.0 },
+		{ "requestedLatencyMs", _previousLatency },
+		{ "averageLatencyMs", _averageLatency },
+		{ "underrunEvents", _bufferUnderrunEventCount }
+	});
+}
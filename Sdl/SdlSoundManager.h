@@ -1,11 +1,26 @@
 ﻿#pragma once
 #include "SDL.h"
 #include "Core/Shared/Audio/BaseSoundManager.h"
+#include "Utilities/Audio/AudioRingBuffer.h"
+#include "Utilities/Audio/SincResampler.h"
+#include "Utilities/Audio/AudioProfiler.h"
 
 class Emulator;
 
 class SdlSoundManager : public BaseSoundManager
 {
+private:
+	//Maximum change to the playback rate used to keep the latency at the requested value (+/- 0.5%)
+	static constexpr double MaxRateAdjustment = 0.005;
+	//Latency error (in ms) at which the maximum adjustment is applied
+	static constexpr double MaxRateAdjustmentError = 10.0;
+	//Portion of the error accumulated each frame, to compensate for a constant drift between the emulation and the device's clock
+	static constexpr double RateDriftGain = 0.002;
+	//Weight of each frame's fill level in the smoothed latency
+	static constexpr double LatencySmoothing = 0.05;
+	//Incoming audio is dropped when the latency is this much (in ms) above the requested value (e.g after fast forwarding)
+	static constexpr double MaxLatencyExcess = 50.0;
+
 public:
 	SdlSoundManager(Emulator* emu);
 	~SdlSoundManager();
@@ -16,6 +31,11 @@ public:
 
 	void ProcessEndOfFrame();
 
+	AudioRingBuffer::Stats GetBufferStats();
+
+	//Per-second timings of each stage of the audio pipeline (see AudioProfiler), with the device's settings
+	string ExportAudioProfile(AudioProfileFormat format);
+
 	string GetAvailableDevices();
 	void SetAudioDevice(string deviceName);
 
@@ -26,8 +46,10 @@ private:
 
 	static void FillAudioBuffer(void *userData, uint8_t *stream, int len);
 
-	void ReadFromBuffer(uint8_t* output, uint32_t len);
-	void WriteToBuffer(uint8_t* output, uint32_t len);
+	uint32_t GetByteLatency(uint32_t latency);
+	uint32_t GetCallbackSampleCount(uint32_t latency);
+	uint32_t Resample(int16_t* soundBuffer, uint32_t sampleCount);
+	void UpdateRateAdjustment(uint32_t fillLevel);
 
 private:
 	Emulator* _emu;
@@ -36,8 +58,23 @@ private:
 	bool _needReset = false;
 
 	uint16_t _previousLatency = 0;
+	uint32_t _callbackSamples = 0; //callback size requested when the device was opened
+
+	//Written by the emulation thread, read by SDL's audio callback thread
+	AudioRingBuffer _buffer;
+	uint32_t _lastUnderrunCount = 0;
+	bool _playing = false;
+
+	//Dynamic rate control: the samples are resampled by up to +/- 0.5% to keep the ring buffer's fill level at the requested latency
+	SincResampler _resampler;
+	vector<int16_t> _stereoBuffer;
+	vector<int16_t> _resampleBuffer;
+	double _rateAdjustment = 0.0;
+	double _rateDrift = 0.0;
+	double _smoothedLatency = 0.0;
+	uint32_t _lastWriteSize = 0;
 
-	uint8_t* _buffer = nullptr;
-	uint32_t _writePosition = 0;
-	uint32_t _readPosition = 0;
+	//Profiling: the device's callback period (ns), and the time of the last callback (callback thread)
+	uint64_t _callbackPeriod = 0;
+	uint64_t _lastCallbackTime = 0;
 };
@@ -0,0 +1,56 @@
+#include "pch.h"
+#include "AudioConverter.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+	#define AUDIOCONVERTER_SSE2
+#endif
+
+void AudioConverter::ToPlanar(const int16_t* stereoBuffer, float* left, float* right, uint32_t sampleCount)
+{
+	uint32_t i = 0;
+#ifdef AUDIOCONVERTER_SSE2
+	for(; i + 4 <= sampleCount; i += 4) {
+		//LRLRLRLR -> 2x LRLR (int32) -> LLLL & RRRR
+		__m128i input = _mm_loadu_si128((const __m128i*)(stereoBuffer + i * 2));
+		__m128 low = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(input, input), 16));
+		__m128 high = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(input, input), 16));
+		_mm_storeu_ps(left + i, _mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0)));
+		_mm_storeu_ps(right + i, _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1)));
+	}
+#endif
+	for(; i < sampleCount; i++) {
+		left[i] = stereoBuffer[i * 2];
+		right[i] = stereoBuffer[i * 2 + 1];
+	}
+}
+
+void AudioConverter::ToInterleaved(const float* left, const float* right, int16_t* stereoBuffer, uint32_t sampleCount)
+{
+	uint32_t i = 0;
+#ifdef AUDIOCONVERTER_SSE2
+	const __m128 minValue = _mm_set1_ps(-32768.0f);
+	const __m128 maxValue = _mm_set1_ps(32767.0f);
+	for(; i + 4 <= sampleCount; i += 4) {
+		__m128i l = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(left + i), minValue), maxValue));
+		__m128i r = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(right + i), minValue), maxValue));
+		_mm_storeu_si128((__m128i*)(stereoBuffer + i * 2), _mm_packs_epi32(_mm_unpacklo_epi32(l, r), _mm_unpackhi_epi32(l, r)));
+	}
+#endif
+	for(; i < sampleCount; i++) {
+		stereoBuffer[i * 2] = (int16_t)std::clamp(left[i], -32768.0f, 32767.0f);
+		stereoBuffer[i * 2 + 1] = (int16_t)std::clamp(right[i], -32768.0f, 32767.0f);
+	}
+}
+
+void AudioConverter::ProcessInterleaved(int16_t* stereoBuffer, size_t sampleCount, const std::function<void(float* left, float* right, uint32_t count)>& process)
+{
+	float left[BlockSize];
+	float right[BlockSize];
+	for(size_t i = 0; i < sampleCount; i += BlockSize) {
+		uint32_t count = (uint32_t)std::min<size_t>(sampleCount - i, BlockSize);
+		ToPlanar(stereoBuffer + i * 2, left, right, count);
+		process(left, right, count);
+		ToInterleaved(left, right, stereoBuffer + i * 2, count);
+	}
+}
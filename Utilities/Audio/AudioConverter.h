@@ -0,0 +1,19 @@
+#pragma once
+#include "pch.h"
+#include <functional>
+
+//Conversions between interleaved int16 stereo samples and planar float samples (one buffer per channel)
+class AudioConverter
+{
+public:
+	//Samples converted at once by ProcessInterleaved
+	static constexpr uint32_t BlockSize = 256;
+
+	static void ToPlanar(const int16_t* stereoBuffer, float* left, float* right, uint32_t sampleCount);
+
+	//Samples are clamped to the int16 range and truncated
+	static void ToInterleaved(const float* left, const float* right, int16_t* stereoBuffer, uint32_t sampleCount);
+
+	//Runs a planar filter on an interleaved buffer, in blocks of up to BlockSize samples
+	static void ProcessInterleaved(int16_t* stereoBuffer, size_t sampleCount, const std::function<void(float* left, float* right, uint32_t count)>& process);
+};
@@ -0,0 +1,148 @@
+#include "pch.h"
+#include "AudioEffectsGraph.h"
+#include "AudioConverter.h"
+
+void AudioEffectsGraph::SetBlockSize(uint32_t blockSize)
+{
+	_blockSize = std::clamp<uint32_t>(blockSize, 1, DelayLine::MaxBlockSize);
+}
+
+void AudioEffectsGraph::SetLowPass(bool enabled, int strength, double volume)
+{
+	_lowPassEnabled = enabled;
+	_lowPassStrength = strength;
+	_volume = volume;
+}
+
+void AudioEffectsGraph::SetReverb(bool enabled, double strength, double delay)
+{
+	_reverbEnabled = enabled;
+	_reverbStrength = strength;
+	_reverbDelay = delay;
+}
+
+void AudioEffectsGraph::SetCrossFeed(bool enabled, int ratio)
+{
+	_crossFeedEnabled = enabled;
+	_crossFeedRatio = ratio;
+}
+
+void AudioEffectsGraph::SetStereoDelay(bool enabled, int32_t delay)
+{
+	_stereoDelayEnabled = enabled;
+	_stereoDelay = delay;
+}
+
+void AudioEffectsGraph::SetStereoPanning(bool enabled, uint32_t angle)
+{
+	_stereoPanningEnabled = enabled;
+	_stereoPanningAngle = angle;
+}
+
+void AudioEffectsGraph::SetStereoComb(bool enabled, int32_t delay, uint32_t strength)
+{
+	_stereoCombEnabled = enabled;
+	_stereoCombDelay = delay;
+	_stereoCombStrength = strength;
+}
+
+void AudioEffectsGraph::SetEqualizer(bool enabled, const vector<double>& bandGains)
+{
+	_equalizerEnabled = enabled && bandGains.size() >= Equalizer::BandCount;
+	if(_equalizerEnabled) {
+		//Reuses the vector's storage when the gains are updated
+		_equalizerGains.assign(bandGains.begin(), bandGains.end());
+	}
+}
+
+void AudioEffectsGraph::ResetReverb()
+{
+	_reverbFilter.ResetFilter();
+}
+
+bool AudioEffectsGraph::IsEnabled()
+{
+	return (
+		_lowPassEnabled || _reverbEnabled || _crossFeedEnabled || _stereoDelayEnabled ||
+		_stereoPanningEnabled || _stereoCombEnabled || _equalizerEnabled
+	);
+}
+
+void AudioEffectsGraph::EndStage(AudioStage stage)
+{
+	if(_profiling) {
+		uint64_t now = AudioProfiler::GetTimestamp();
+		_stageTimes[(int)stage] += now - _stageStart;
+		_stageStart = now;
+	}
+}
+
+void AudioEffectsGraph::ProcessBlock(uint32_t sampleCount, uint32_t sampleRate)
+{
+	if(_profiling) {
+		_stageStart = AudioProfiler::GetTimestamp();
+	}
+
+	if(_lowPassEnabled) {
+		_lowPassFilter.ApplyFilter(_left, _right, sampleCount, _lowPassStrength, _volume);
+		EndStage(AudioStage::LowPassFilter);
+	}
+	if(_reverbEnabled) {
+		_reverbFilter.ApplyFilter(_left, _right, sampleCount, sampleRate, _reverbStrength, _reverbDelay);
+		EndStage(AudioStage::ReverbFilter);
+	}
+	if(_crossFeedEnabled) {
+		_crossFeedFilter.ApplyFilter(_left, _right, sampleCount, _crossFeedRatio);
+		EndStage(AudioStage::CrossFeedFilter);
+	}
+	if(_stereoDelayEnabled) {
+		_stereoDelayFilter.ApplyFilter(_left, _right, sampleCount, sampleRate, _stereoDelay);
+		EndStage(AudioStage::StereoDelayFilter);
+	}
+	if(_stereoPanningEnabled) {
+		_stereoPanningFilter.ApplyFilter(_left, _right, sampleCount, _stereoPanningAngle);
+		EndStage(AudioStage::StereoPanningFilter);
+	}
+	if(_stereoCombEnabled) {
+		_stereoCombFilter.ApplyFilter(_left, _right, sampleCount, sampleRate, _stereoCombDelay, _stereoCombStrength);
+		EndStage(AudioStage::StereoCombFilter);
+	}
+	if(_equalizerEnabled) {
+		_equalizer.ApplyEqualizer(_left, _right, sampleCount);
+		EndStage(AudioStage::Equalizer);
+	}
+}
+
+void AudioEffectsGraph::Process(int16_t* stereoBuffer, size_t sampleCount, uint32_t sampleRate)
+{
+	if(!IsEnabled()) {
+		return;
+	}
+
+	AudioStageTimer timer(AudioStage::Effects);
+	_profiling = AudioProfiler::IsEnabled();
+	if(_profiling) {
+		memset(_stageTimes, 0, sizeof(_stageTimes));
+	}
+
+	if(_equalizerEnabled) {
+		//Only recalculates the filters when the gains or sample rate changed
+		_equalizer.UpdateEqualizers(_equalizerGains, sampleRate);
+	}
+
+	for(size_t i = 0; i < sampleCount; i += _blockSize) {
+		uint32_t count = (uint32_t)std::min<size_t>(sampleCount - i, _blockSize);
+		AudioConverter::ToPlanar(stereoBuffer + i * 2, _left, _right, count);
+		ProcessBlock(count, sampleRate);
+		AudioConverter::ToInterleaved(_left, _right, stereoBuffer + i * 2, count);
+	}
+
+	if(_profiling) {
+		//One value per filter for the whole call, like the other stages
+		for(int i = (int)AudioStage::LowPassFilter; i <= (int)AudioStage::Equalizer; i++) {
+			if(_stageTimes[i] > 0) {
+				AudioProfiler::Record((AudioStage)i, _stageTimes[i]);
+			}
+		}
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include "pch.h"
+#include "LowPassFilter.h"
+#include "ReverbFilter.h"
+#include "CrossFeedFilter.h"
+#include "StereoDelayFilter.h"
+#include "StereoPanningFilter.h"
+#include "StereoCombFilter.h"
+#include "Equalizer.h"
+#include "AudioProfiler.h"
+
+//Runs the enabled audio effects in a single pass: each block of samples is converted to planar float once,
+//goes through every enabled stage (in a fixed order) while it is still in the cache, and is converted back
+//(and clamped) once. Stages can be enabled/disabled at any time without reallocating anything.
+class AudioEffectsGraph
+{
+public:
+	static constexpr uint32_t DefaultBlockSize = 256;
+
+private:
+	LowPassFilter _lowPassFilter;
+	ReverbFilter _reverbFilter;
+	CrossFeedFilter _crossFeedFilter;
+	StereoDelayFilter _stereoDelayFilter;
+	StereoPanningFilter _stereoPanningFilter;
+	StereoCombFilter _stereoCombFilter;
+	Equalizer _equalizer;
+
+	bool _lowPassEnabled = false;
+	int _lowPassStrength = 0;
+	double _volume = 1.0;
+
+	bool _reverbEnabled = false;
+	double _reverbStrength = 0;
+	double _reverbDelay = 0;
+
+	bool _crossFeedEnabled = false;
+	int _crossFeedRatio = 0;
+
+	bool _stereoDelayEnabled = false;
+	int32_t _stereoDelay = 0;
+
+	bool _stereoPanningEnabled = false;
+	uint32_t _stereoPanningAngle = 0;
+
+	bool _stereoCombEnabled = false;
+	int32_t _stereoCombDelay = 0;
+	uint32_t _stereoCombStrength = 0;
+
+	bool _equalizerEnabled = false;
+	vector<double> _equalizerGains;
+
+	uint32_t _blockSize = DefaultBlockSize;
+	float _left[DelayLine::MaxBlockSize];
+	float _right[DelayLine::MaxBlockSize];
+
+	//Time spent in each filter during the current Process call (only measured when the profiler is enabled)
+	bool _profiling = false;
+	uint64_t _stageStart = 0;
+	uint64_t _stageTimes[(int)AudioStage::Count] = {};
+
+	void EndStage(AudioStage stage);
+	void ProcessBlock(uint32_t sampleCount, uint32_t sampleRate);
+
+public:
+	//Clamped to [1, DelayLine::MaxBlockSize]
+	void SetBlockSize(uint32_t blockSize);
+	uint32_t GetBlockSize() { return _blockSize; }
+
+	void SetLowPass(bool enabled, int strength, double volume);
+	void SetReverb(bool enabled, double strength, double delay);
+	void SetCrossFeed(bool enabled, int ratio);
+	void SetStereoDelay(bool enabled, int32_t delay);
+	void SetStereoPanning(bool enabled, uint32_t angle);
+	void SetStereoComb(bool enabled, int32_t delay, uint32_t strength);
+	void SetEqualizer(bool enabled, const vector<double>& bandGains);
+
+	//Clears the reverb's history (e.g when the reverb is turned off)
+	void ResetReverb();
+
+	bool IsEnabled();
+
+	void Process(int16_t* stereoBuffer, size_t sampleCount, uint32_t sampleRate);
+};
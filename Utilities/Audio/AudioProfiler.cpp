@@ -0,0 +1,324 @@
+#include "pch.h"
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include "Utilities/Audio/AudioProfiler.h"
+#include "Utilities/SimpleLock.h"
+
+namespace
+{
+	//Values below 2^SubBucketBits get their own bucket, every power of 2 above is split in SubBucketCount buckets
+	constexpr uint32_t SubBucketBits = 3;
+	constexpr uint32_t SubBucketCount = 1 << SubBucketBits;
+	constexpr uint32_t MaxExponent = 42; //values above 2^43 ns (~2.4 hours) go in the last bucket
+	constexpr uint32_t BucketCount = (MaxExponent - SubBucketBits + 2) * SubBucketCount;
+	constexpr uint64_t WindowLength = 1000000000; //1 second
+
+	struct StageHistogram
+	{
+		//Cumulative
+		atomic<uint64_t> Buckets[BucketCount];
+		atomic<uint64_t> Sum;
+
+		//Since the end of the last window
+		atomic<uint64_t> Min;
+		atomic<uint64_t> Max;
+	};
+
+	struct ProfilerState
+	{
+		atomic<bool> Enabled;
+		atomic<bool> ResetPending;
+		StageHistogram Stages[(int)AudioStage::Count];
+
+		//Only used by the thread that calls Update
+		uint64_t BucketSnapshot[(int)AudioStage::Count][BucketCount];
+		uint64_t SumSnapshot[(int)AudioStage::Count];
+		uint64_t StartTime = 0;
+		uint64_t WindowStart = 0;
+
+		SimpleLock HistoryLock;
+		std::deque<AudioProfiler::Report> History;
+
+		ProfilerState();
+	};
+
+	ProfilerState::ProfilerState()
+	{
+		for(StageHistogram& stage : Stages) {
+			for(atomic<uint64_t>& bucket : stage.Buckets) {
+				bucket = 0;
+			}
+			stage.Sum = 0;
+			stage.Min = UINT64_MAX;
+			stage.Max = 0;
+		}
+
+		const char* enabled = std::getenv("NESPLAY_AUDIO_PROFILER");
+		Enabled = enabled && strcmp(enabled, "0") != 0;
+		ResetPending = true;
+	}
+
+	ProfilerState& GetState()
+	{
+		static ProfilerState state;
+		return state;
+	}
+
+	uint32_t GetBucket(uint64_t value)
+	{
+		if(value < SubBucketCount) {
+			return (uint32_t)value;
+		}
+
+		//Position of the most significant bit
+		uint32_t exponent = 0;
+		for(uint32_t shift = 32; shift > 0; shift >>= 1) {
+			if(value >> (exponent + shift)) {
+				exponent += shift;
+			}
+		}
+
+		if(exponent > MaxExponent) {
+			return BucketCount - 1;
+		}
+		uint32_t subBucket = (uint32_t)(value >> (exponent - SubBucketBits)) & (SubBucketCount - 1);
+		return (exponent - SubBucketBits + 1) * SubBucketCount + subBucket;
+	}
+
+	uint64_t GetBucketValue(uint32_t bucket)
+	{
+		if(bucket < SubBucketCount) {
+			return bucket;
+		}
+
+		//Middle of the bucket's range
+		uint32_t shift = bucket / SubBucketCount - 1;
+		uint64_t start = (uint64_t)(SubBucketCount + bucket % SubBucketCount) << shift;
+		return start + ((1ULL << shift) >> 1);
+	}
+
+	uint64_t GetPercentile(const uint64_t* counts, uint64_t total, double percentile)
+	{
+		uint64_t target = std::max<uint64_t>(1, (uint64_t)(total * percentile + 0.999999));
+		uint64_t count = 0;
+		for(uint32_t i = 0; i < BucketCount; i++) {
+			count += counts[i];
+			if(count >= target) {
+				return GetBucketValue(i);
+			}
+		}
+		return GetBucketValue(BucketCount - 1);
+	}
+
+	void StartWindows(ProfilerState& state, uint64_t now)
+	{
+		for(int i = 0; i < (int)AudioStage::Count; i++) {
+			StageHistogram& stage = state.Stages[i];
+			for(uint32_t j = 0; j < BucketCount; j++) {
+				state.BucketSnapshot[i][j] = stage.Buckets[j].load(std::memory_order_relaxed);
+			}
+			state.SumSnapshot[i] = stage.Sum.load(std::memory_order_relaxed);
+			stage.Min.store(UINT64_MAX, std::memory_order_relaxed);
+			stage.Max.store(0, std::memory_order_relaxed);
+		}
+		state.StartTime = now;
+		state.WindowStart = now;
+	}
+
+	void AppendReport(ProfilerState& state, AudioProfiler::Report& report)
+	{
+		auto lock = state.HistoryLock.AcquireSafe();
+		state.History.push_back(report);
+		while(state.History.size() > AudioProfiler::HistorySeconds) {
+			state.History.pop_front();
+		}
+	}
+}
+
+bool AudioProfiler::IsEnabled()
+{
+	return GetState().Enabled.load(std::memory_order_relaxed);
+}
+
+void AudioProfiler::SetEnabled(bool enabled)
+{
+	ProfilerState& state = GetState();
+	if(enabled && !state.Enabled) {
+		//Start from scratch, the values recorded before were not for the whole window
+		Reset();
+	}
+	state.Enabled = enabled;
+}
+
+void AudioProfiler::Reset()
+{
+	ProfilerState& state = GetState();
+
+	//The histograms are only read by the thread that calls Update, which restarts the windows from the current values
+	state.ResetPending = true;
+
+	auto lock = state.HistoryLock.AcquireSafe();
+	state.History.clear();
+}
+
+uint64_t AudioProfiler::GetTimestamp()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void AudioProfiler::Record(AudioStage stage, uint64_t value)
+{
+	StageHistogram& histogram = GetState().Stages[(int)stage];
+	histogram.Buckets[GetBucket(value)].fetch_add(1, std::memory_order_relaxed);
+	histogram.Sum.fetch_add(value, std::memory_order_relaxed);
+
+	uint64_t min = histogram.Min.load(std::memory_order_relaxed);
+	while(value < min && !histogram.Min.compare_exchange_weak(min, value, std::memory_order_relaxed)) {
+	}
+
+	uint64_t max = histogram.Max.load(std::memory_order_relaxed);
+	while(value > max && !histogram.Max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+	}
+}
+
+void AudioProfiler::Update()
+{
+	ProfilerState& state = GetState();
+	if(!state.Enabled) {
+		return;
+	}
+
+	uint64_t now = GetTimestamp();
+	if(state.ResetPending.exchange(false)) {
+		StartWindows(state, now);
+		return;
+	}
+
+	if(now - state.WindowStart < WindowLength) {
+		return;
+	}
+
+	Report report = {};
+	report.Time = (now - state.StartTime) / 1e9;
+	report.Duration = (now - state.WindowStart) / 1e9;
+
+	uint64_t counts[BucketCount];
+	for(int i = 0; i < (int)AudioStage::Count; i++) {
+		StageHistogram& stage = state.Stages[i];
+
+		//Values recorded during this window
+		uint64_t total = 0;
+		for(uint32_t j = 0; j < BucketCount; j++) {
+			uint64_t count = stage.Buckets[j].load(std::memory_order_relaxed);
+			counts[j] = count - state.BucketSnapshot[i][j];
+			state.BucketSnapshot[i][j] = count;
+			total += counts[j];
+		}
+
+		uint64_t sum = stage.Sum.load(std::memory_order_relaxed);
+		uint64_t windowSum = sum - state.SumSnapshot[i];
+		state.SumSnapshot[i] = sum;
+
+		uint64_t min = stage.Min.exchange(UINT64_MAX, std::memory_order_relaxed);
+		uint64_t max = stage.Max.exchange(0, std::memory_order_relaxed);
+
+		if(total > 0) {
+			StageStats& stats = report.Stages[i];
+			min = std::min(min, max);
+			stats.Count = (uint32_t)total;
+			stats.Min = min;
+			stats.Max = max;
+			stats.Mean = windowSum / total;
+
+			//The percentiles are approximated by the bucket's middle value, keep them within the exact min/max
+			stats.P50 = std::clamp(GetPercentile(counts, total, 0.50), min, max);
+			stats.P99 = std::clamp(GetPercentile(counts, total, 0.99), min, max);
+		}
+	}
+
+	state.WindowStart = now;
+	AppendReport(state, report);
+}
+
+vector<AudioProfiler::Report> AudioProfiler::GetHistory()
+{
+	ProfilerState& state = GetState();
+	auto lock = state.HistoryLock.AcquireSafe();
+	return vector<Report>(state.History.begin(), state.History.end());
+}
+
+string AudioProfiler::GetStageName(AudioStage stage)
+{
+	switch(stage) {
+		case AudioStage::Generation: return "Generation";
+		case AudioStage::Effects: return "Effects";
+		case AudioStage::LowPassFilter: return "LowPassFilter";
+		case AudioStage::ReverbFilter: return "ReverbFilter";
+		case AudioStage::CrossFeedFilter: return "CrossFeedFilter";
+		case AudioStage::StereoDelayFilter: return "StereoDelayFilter";
+		case AudioStage::StereoPanningFilter: return "StereoPanningFilter";
+		case AudioStage::StereoCombFilter: return "StereoCombFilter";
+		case AudioStage::Equalizer: return "Equalizer";
+		case AudioStage::Resample: return "Resample";
+		case AudioStage::RingWrite: return "RingWrite";
+		case AudioStage::DeviceCallback: return "DeviceCallback";
+		case AudioStage::CallbackInterval: return "CallbackInterval";
+		case AudioStage::CallbackJitter: return "CallbackJitter";
+		case AudioStage::RingFill: return "RingFill";
+		default: return "Unknown";
+	}
+}
+
+string AudioProfiler::Export(AudioProfileFormat format, const vector<std::pair<string, double>>& info)
+{
+	vector<Report> history = GetHistory();
+	char line[300];
+	string output;
+
+	if(format == AudioProfileFormat::Csv) {
+		output = "time,duration,stage,count,min_us,p50_us,p99_us,max_us,mean_us\n";
+		for(const Report& report : history) {
+			for(int i = 0; i < (int)AudioStage::Count; i++) {
+				const StageStats& stats = report.Stages[i];
+				if(stats.Count > 0) {
+					snprintf(line, sizeof(line), "%.3f,%.3f,%s,%u,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+						report.Time, report.Duration, GetStageName((AudioStage)i).c_str(), stats.Count,
+						stats.Min / 1000.0, stats.P50 / 1000.0, stats.P99 / 1000.0, stats.Max / 1000.0, stats.Mean / 1000.0);
+					output += line;
+				}
+			}
+		}
+		return output;
+	}
+
+	//All values are in microseconds
+	output = "{\n\t\"info\": {";
+	for(size_t i = 0; i < info.size(); i++) {
+		snprintf(line, sizeof(line), "%s\n\t\t\"%s\": %.6g", i > 0 ? "," : "", info[i].first.c_str(), info[i].second);
+		output += line;
+	}
+	output += info.empty() ? "},\n" : "\n\t},\n";
+
+	output += "\t\"reports\": [";
+	for(size_t i = 0; i < history.size(); i++) {
+		const Report& report = history[i];
+		snprintf(line, sizeof(line), "%s\n\t\t{ \"time\": %.3f, \"duration\": %.3f, \"stages\": {", i > 0 ? "," : "", report.Time, report.Duration);
+		output += line;
+
+		bool first = true;
+		for(int j = 0; j < (int)AudioStage::Count; j++) {
+			const StageStats& stats = report.Stages[j];
+			if(stats.Count > 0) {
+				snprintf(line, sizeof(line), "%s\n\t\t\t\"%s\": { \"count\": %u, \"min\": %.3f, \"p50\": %.3f, \"p99\": %.3f, \"max\": %.3f, \"mean\": %.3f }",
+					first ? "" : ",", GetStageName((AudioStage)j).c_str(), stats.Count,
+					stats.Min / 1000.0, stats.P50 / 1000.0, stats.P99 / 1000.0, stats.Max / 1000.0, stats.Mean / 1000.0);
+				output += line;
+				first = false;
+			}
+		}
+		output += first ? "} }" : "\n\t\t} }";
+	}
+	output += history.empty() ? "]\n}\n" : "\n\t]\n}\n";
+	return output;
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include "pch.h"
+
+//Stages of the audio pipeline, in the order the samples go through them
+enum class AudioStage
+{
+	Generation, //emulated sound chips + mixing (recorded by the mixer)
+	Effects, //whole AudioEffectsGraph pass, including the planar conversions
+	LowPassFilter,
+	ReverbFilter,
+	CrossFeedFilter,
+	StereoDelayFilter,
+	StereoPanningFilter,
+	StereoCombFilter,
+	Equalizer,
+	Resample, //output rate conversion/dynamic rate control
+	RingWrite,
+	DeviceCallback,
+	CallbackInterval, //time between 2 device callbacks
+	CallbackJitter, //difference between the callback interval and the device's period
+	RingFill, //audio buffered in the ring when the device callback runs
+
+	Count
+};
+
+enum class AudioProfileFormat
+{
+	Json,
+	Csv
+};
+
+//Per-stage timings of the audio pipeline, for latency tuning
+//Values (in ns) are recorded into lock-free log-linear histograms (8 buckets per power of 2, i.e within 12.5%) with
+//relaxed atomic increments, so the audio callback never blocks. The histograms are cumulative: once per second,
+//Update() takes the difference with the previous snapshot to get that second's p50/p99 (the min/max of each second
+//are tracked exactly). The last HistorySeconds reports are kept for export.
+//Profiling is disabled by default: enable it with SetEnabled() or the NESPLAY_AUDIO_PROFILER environment variable.
+class AudioProfiler
+{
+public:
+	static constexpr uint32_t HistorySeconds = 600;
+
+	struct StageStats
+	{
+		uint32_t Count;
+		uint64_t Min; //ns
+		uint64_t P50;
+		uint64_t P99;
+		uint64_t Max;
+		uint64_t Mean;
+	};
+
+	struct Report
+	{
+		double Time; //seconds since the profiler was enabled/reset, at the end of this report's window
+		double Duration; //length of the window (Update is called once per frame, so slightly over a second)
+		StageStats Stages[(int)AudioStage::Count];
+	};
+
+	static bool IsEnabled();
+	static void SetEnabled(bool enabled);
+
+	//Clears the histograms and the report history
+	static void Reset();
+
+	static uint64_t GetTimestamp();
+
+	//Lock-free, can be called from any thread
+	static void Record(AudioStage stage, uint64_t value);
+
+	//Closes the current window once a second has elapsed - must always be called by the same thread (e.g once per frame)
+	static void Update();
+
+	static vector<Report> GetHistory();
+
+	static string GetStageName(AudioStage stage);
+
+	//info: extra values included in the JSON output (e.g the device's sample rate & period)
+	static string Export(AudioProfileFormat format, const vector<std::pair<string, double>>& info = {});
+};
+
+//Records the time spent in a scope
+class AudioStageTimer
+{
+private:
+	AudioStage _stage;
+	uint64_t _start;
+
+public:
+	AudioStageTimer(AudioStage stage)
+	{
+		_stage = stage;
+		_start = AudioProfiler::IsEnabled() ? AudioProfiler::GetTimestamp() : 0;
+	}
+
+	~AudioStageTimer()
+	{
+		if(_start) {
+			AudioProfiler::Record(_stage, AudioProfiler::GetTimestamp() - _start);
+		}
+	}
+};
@@ -0,0 +1,95 @@
+#include "pch.h"
+#include <cstring>
+#include "AudioRingBuffer.h"
+
+AudioRingBuffer::AudioRingBuffer() : _writePosition(0), _readPosition(0), _underrunCount(0), _underrunBytes(0), _overrunCount(0), _overrunBytes(0)
+{
+}
+
+void AudioRingBuffer::Init(uint32_t capacity)
+{
+	uint32_t size = 1;
+	while(size < capacity) {
+		size <<= 1;
+	}
+
+	_buffer.assign(size, 0);
+	_mask = size - 1;
+	_writePosition = 0;
+	_readPosition = 0;
+	_underrunCount = 0;
+	_underrunBytes = 0;
+	_overrunCount = 0;
+	_overrunBytes = 0;
+}
+
+void AudioRingBuffer::Clear()
+{
+	_readPosition.store(_writePosition.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+uint32_t AudioRingBuffer::Write(const uint8_t* data, uint32_t len)
+{
+	uint32_t writePos = _writePosition.load(std::memory_order_relaxed);
+	uint32_t readPos = _readPosition.load(std::memory_order_acquire);
+	uint32_t space = (uint32_t)_buffer.size() - (writePos - readPos);
+	if(len > space) {
+		_overrunCount.fetch_add(1, std::memory_order_relaxed);
+		_overrunBytes.fetch_add(len - space, std::memory_order_relaxed);
+		len = space;
+	}
+
+	uint32_t offset = writePos & _mask;
+	uint32_t firstPart = std::min(len, (uint32_t)_buffer.size() - offset);
+	memcpy(_buffer.data() + offset, data, firstPart);
+	memcpy(_buffer.data(), data + firstPart, len - firstPart);
+
+	_writePosition.store(writePos + len, std::memory_order_release);
+	return len;
+}
+
+void AudioRingBuffer::Read(uint8_t* output, uint32_t len)
+{
+	uint32_t readPos = _readPosition.load(std::memory_order_relaxed);
+	uint32_t writePos = _writePosition.load(std::memory_order_acquire);
+	uint32_t available = writePos - readPos;
+	uint32_t count = std::min(len, available);
+
+	uint32_t offset = readPos & _mask;
+	uint32_t firstPart = std::min(count, (uint32_t)_buffer.size() - offset);
+	memcpy(output, _buffer.data() + offset, firstPart);
+	memcpy(output + firstPart, _buffer.data(), count - firstPart);
+
+	if(count < len) {
+		memset(output + count, 0, len - count);
+		_underrunCount.fetch_add(1, std::memory_order_relaxed);
+		_underrunBytes.fetch_add(len - count, std::memory_order_relaxed);
+	}
+
+	_readPosition.store(readPos + count, std::memory_order_release);
+}
+
+uint32_t AudioRingBuffer::Skip(uint32_t len)
+{
+	uint32_t readPos = _readPosition.load(std::memory_order_relaxed);
+	uint32_t count = std::min(len, _writePosition.load(std::memory_order_acquire) - readPos);
+	_readPosition.store(readPos + count, std::memory_order_release);
+	return count;
+}
+
+uint32_t AudioRingBuffer::GetFillLevel() const
+{
+	return _writePosition.load(std::memory_order_acquire) - _readPosition.load(std::memory_order_acquire);
+}
+
+AudioRingBuffer::Stats AudioRingBuffer::GetStats() const
+{
+	Stats stats;
+	stats.FillLevel = GetFillLevel();
+	stats.Capacity = GetCapacity();
+	stats.UnderrunCount = _underrunCount.load(std::memory_order_relaxed);
+	stats.UnderrunBytes = _underrunBytes.load(std::memory_order_relaxed);
+	stats.OverrunCount = _overrunCount.load(std::memory_order_relaxed);
+	stats.OverrunBytes = _overrunBytes.load(std::memory_order_relaxed);
+	return stats;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "pch.h"
+
+//Lock-free ring buffer with a single producer (e.g the emulation thread) and a single consumer (e.g the audio callback)
+//The read/write positions are byte counters that wrap around at 2^32 - the capacity is a power of 2, so the
+//offset in the buffer is the position masked with (capacity - 1) and the fill level is write - read.
+//Each side only modifies its own position: the producer publishes data with a release store of the write position
+//(acquired by the consumer), and the consumer frees space with a release store of the read position.
+class AudioRingBuffer
+{
+public:
+	struct Stats
+	{
+		uint32_t FillLevel; //bytes
+		uint32_t Capacity;
+		uint32_t UnderrunCount; //reads that could not be completed (the missing data is replaced by silence)
+		uint64_t UnderrunBytes;
+		uint32_t OverrunCount; //writes that did not fit (the data that does not fit is dropped)
+		uint64_t OverrunBytes;
+	};
+
+private:
+	vector<uint8_t> _buffer;
+	uint32_t _mask = 0;
+
+	atomic<uint32_t> _writePosition;
+	atomic<uint32_t> _readPosition;
+
+	atomic<uint32_t> _underrunCount;
+	atomic<uint64_t> _underrunBytes;
+	atomic<uint32_t> _overrunCount;
+	atomic<uint64_t> _overrunBytes;
+
+public:
+	AudioRingBuffer();
+
+	//Allocates the buffer (capacity is rounded up to a power of 2) and resets everything - neither side may be running
+	void Init(uint32_t capacity);
+
+	//Discards the buffer's content - must only be called while the consumer is not running
+	void Clear();
+
+	//Producer - returns the number of bytes written
+	uint32_t Write(const uint8_t* data, uint32_t len);
+
+	//Consumer - always fills the output, with silence if there is not enough data
+	void Read(uint8_t* output, uint32_t len);
+
+	//Consumer - discards up to len bytes, returns the number of bytes discarded
+	uint32_t Skip(uint32_t len);
+
+	uint32_t GetFillLevel() const;
+	uint32_t GetCapacity() const { return (uint32_t)_buffer.size(); }
+	Stats GetStats() const;
+};
@@ -0,0 +1,513 @@
+#include "pch.h"
+#include "Utilities/Audio/AudioTrackPlayer.h"
+#include "Utilities/Audio/stb_vorbis.h"
+#include "Utilities/VirtualFile.h"
+
+class AudioTrackDecoder
+{
+public:
+	virtual ~AudioTrackDecoder() {}
+
+	virtual uint32_t GetSampleRate() = 0;
+	virtual uint32_t GetLength() = 0;
+
+	//Moves to the specified sample (the next call to Decode starts exactly at this sample), returns false if out of bounds
+	virtual bool Seek(uint32_t sample) = 0;
+
+	//Decodes up to maxCount stereo samples, returns 0 at the end of the file
+	virtual uint32_t Decode(int16_t* out, uint32_t maxCount) = 0;
+};
+
+class WavTrackDecoder : public AudioTrackDecoder
+{
+private:
+	//Files on the disk are read in chunks as needed, files in archives are extracted in memory
+	ifstream _file;
+	uint64_t _filePosition = 0;
+	vector<uint8_t> _data;
+	bool _inMemory = false;
+	uint64_t _fileSize = 0;
+
+	uint64_t _dataOffset = 0;
+	uint32_t _sampleCount = 0;
+	uint32_t _position = 0;
+
+	uint32_t _sampleRate = 0;
+	uint32_t _channelCount = 0;
+	uint32_t _bitsPerSample = 0;
+	uint32_t _blockAlign = 0;
+	bool _isFloat = false;
+
+	vector<uint8_t> _chunk;
+
+	static uint16_t ReadLe16(uint8_t* data) { return data[0] | (data[1] << 8); }
+	static uint32_t ReadLe32(uint8_t* data) { return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24); }
+
+	bool ReadBytes(uint64_t offset, uint8_t* out, uint32_t len)
+	{
+		if(offset + len > _fileSize) {
+			return false;
+		}
+
+		if(_inMemory) {
+			memcpy(out, _data.data() + offset, len);
+			return true;
+		}
+
+		if(offset != _filePosition) {
+			_file.clear();
+			_file.seekg(offset, std::ios::beg);
+		}
+		_file.read((char*)out, len);
+		_filePosition = offset + _file.gcount();
+		return (uint32_t)_file.gcount() == len;
+	}
+
+	int16_t ReadSample(uint8_t* src)
+	{
+		if(_isFloat) {
+			float value;
+			memcpy(&value, src, sizeof(float));
+			value *= 32768.0f;
+			return value >= 32767.0f ? 32767 : (value > -32768.0f ? (int16_t)value : -32768);
+		}
+
+		switch(_bitsPerSample) {
+			case 8: return (int16_t)((src[0] - 128) * 256);
+			case 16: return (int16_t)ReadLe16(src);
+			default: return (int16_t)ReadLe16(src + _bitsPerSample / 8 - 2); //24/32-bit: keep the 16 most significant bits
+		}
+	}
+
+	bool ReadFormat(uint64_t offset, uint32_t chunkSize)
+	{
+		uint8_t fmt[40] = {};
+		if(chunkSize < 16 || !ReadBytes(offset, fmt, std::min<uint32_t>(chunkSize, sizeof(fmt)))) {
+			return false;
+		}
+
+		uint32_t format = ReadLe16(fmt);
+		if(format == 0xFFFE && chunkSize >= 40) {
+			//WAVE_FORMAT_EXTENSIBLE, the actual format is at the start of the sub format GUID
+			format = ReadLe16(fmt + 24);
+		}
+
+		_channelCount = ReadLe16(fmt + 2);
+		_sampleRate = ReadLe32(fmt + 4);
+		_blockAlign = ReadLe16(fmt + 12);
+		_bitsPerSample = ReadLe16(fmt + 14);
+		_isFloat = format == 3;
+
+		if(_channelCount == 0 || _sampleRate == 0 || _blockAlign < _channelCount * _bitsPerSample / 8) {
+			return false;
+		}
+
+		if(format == 1) {
+			return _bitsPerSample == 8 || _bitsPerSample == 16 || _bitsPerSample == 24 || _bitsPerSample == 32;
+		} else if(format == 3) {
+			return _bitsPerSample == 32;
+		}
+		return false;
+	}
+
+public:
+	bool Init(VirtualFile& file)
+	{
+		if(file.IsArchive() || file.IsLoaded()) {
+			_data = file.GetData();
+			_fileSize = _data.size();
+			_inMemory = true;
+		} else {
+			_file.open(file.GetFilePath(), std::ios::in | std::ios::binary);
+			if(!_file.good()) {
+				return false;
+			}
+			_file.seekg(0, std::ios::end);
+			_fileSize = (uint64_t)_file.tellg();
+			_filePosition = _fileSize;
+		}
+
+		uint8_t header[12];
+		if(!ReadBytes(0, header, 12) || memcmp(header, "RIFF", 4) || memcmp(header + 8, "WAVE", 4)) {
+			return false;
+		}
+
+		//Look for the fmt & data chunks (other chunks, e.g LIST/fact, are skipped)
+		bool formatFound = false;
+		uint64_t offset = 12;
+		uint8_t chunkHeader[8];
+		while(ReadBytes(offset, chunkHeader, 8)) {
+			uint32_t chunkSize = ReadLe32(chunkHeader + 4);
+			offset += 8;
+
+			if(memcmp(chunkHeader, "fmt ", 4) == 0) {
+				if(!ReadFormat(offset, chunkSize)) {
+					return false;
+				}
+				formatFound = true;
+			} else if(memcmp(chunkHeader, "data", 4) == 0) {
+				if(!formatFound) {
+					return false;
+				}
+
+				//Files written while streaming can have a size of 0 or 0xFFFFFFFF, the data then ends with the file
+				uint64_t dataSize = _fileSize - offset;
+				if(chunkSize > 0 && chunkSize < dataSize) {
+					dataSize = chunkSize;
+				}
+				_dataOffset = offset;
+				_sampleCount = (uint32_t)std::min<uint64_t>(dataSize / _blockAlign, UINT32_MAX);
+				return _sampleCount > 0;
+			}
+
+			//Chunks are word-aligned
+			offset += chunkSize + (chunkSize & 1);
+		}
+
+		return false;
+	}
+
+	uint32_t GetSampleRate() override
+	{
+		return _sampleRate;
+	}
+
+	uint32_t GetLength() override
+	{
+		return _sampleCount;
+	}
+
+	bool Seek(uint32_t sample) override
+	{
+		if(sample >= _sampleCount) {
+			return false;
+		}
+		_position = sample;
+		return true;
+	}
+
+	uint32_t Decode(int16_t* out, uint32_t maxCount) override
+	{
+		uint32_t count = std::min(maxCount, _sampleCount - _position);
+		_chunk.resize((size_t)count * _blockAlign);
+		if(count == 0 || !ReadBytes(_dataOffset + (uint64_t)_position * _blockAlign, _chunk.data(), count * _blockAlign)) {
+			//End of file (or truncated file)
+			return 0;
+		}
+
+		//Mono files are played on both channels, only the first 2 channels of multichannel files are played
+		uint32_t rightOffset = _channelCount > 1 ? _bitsPerSample / 8 : 0;
+		for(uint32_t i = 0; i < count; i++) {
+			uint8_t* src = _chunk.data() + i * _blockAlign;
+			out[i * 2] = ReadSample(src);
+			out[i * 2 + 1] = ReadSample(src + rightOffset);
+		}
+
+		_position += count;
+		return count;
+	}
+};
+
+class VorbisTrackDecoder : public AudioTrackDecoder
+{
+private:
+	stb_vorbis* _vorbis = nullptr;
+	vector<uint8_t> _data; //file content, for files in archives
+	uint32_t _sampleRate = 0;
+	uint32_t _length = 0;
+
+public:
+	~VorbisTrackDecoder()
+	{
+		if(_vorbis) {
+			stb_vorbis_close(_vorbis);
+		}
+	}
+
+	bool Init(VirtualFile& file)
+	{
+		int error = 0;
+		if(file.IsArchive() || file.IsLoaded()) {
+			_data = file.GetData();
+			_vorbis = stb_vorbis_open_memory(_data.data(), (int)_data.size(), &error, nullptr);
+		} else {
+			//stb_vorbis reads the pages it needs from the file as it decodes/seeks
+#ifdef _WIN32
+			FILE* f = _wfopen(utf8::utf8::decode(file.GetFilePath()).c_str(), L"rb");
+#else
+			FILE* f = fopen(file.GetFilePath().c_str(), "rb");
+#endif
+			if(!f) {
+				return false;
+			}
+			_vorbis = stb_vorbis_open_file(f, 1, &error, nullptr);
+		}
+
+		if(!_vorbis) {
+			return false;
+		}
+
+		_sampleRate = stb_vorbis_get_info(_vorbis).sample_rate;
+		_length = stb_vorbis_stream_length_in_samples(_vorbis);
+		return _sampleRate > 0 && _length > 0;
+	}
+
+	uint32_t GetSampleRate() override
+	{
+		return _sampleRate;
+	}
+
+	uint32_t GetLength() override
+	{
+		return _length;
+	}
+
+	bool Seek(uint32_t sample) override
+	{
+		//Sample-accurate: finds the page containing the sample by bisection (using the pages' granule positions),
+		//then decodes from the start of that page and discards the samples before the target
+		return sample < _length && stb_vorbis_seek(_vorbis, sample) != 0;
+	}
+
+	uint32_t Decode(int16_t* out, uint32_t maxCount) override
+	{
+		return (uint32_t)stb_vorbis_get_samples_short_interleaved(_vorbis, 2, out, (int)maxCount * 2);
+	}
+};
+
+unique_ptr<AudioTrackPlayer> AudioTrackPlayer::Create(VirtualFile& file)
+{
+	unique_ptr<AudioTrackDecoder> decoder;
+
+	unique_ptr<WavTrackDecoder> wav(new WavTrackDecoder());
+	if(wav->Init(file)) {
+		decoder = std::move(wav);
+	} else {
+		unique_ptr<VorbisTrackDecoder> vorbis(new VorbisTrackDecoder());
+		if(vorbis->Init(file)) {
+			decoder = std::move(vorbis);
+		}
+	}
+
+	if(!decoder) {
+		return nullptr;
+	}
+	return unique_ptr<AudioTrackPlayer>(new AudioTrackPlayer(std::move(decoder)));
+}
+
+AudioTrackPlayer::AudioTrackPlayer(unique_ptr<AudioTrackDecoder> decoder) : _requestSerial(0), _ackSerial(0), _wrapSerial(UINT32_MAX), _endSerial(UINT32_MAX), _ackStartByte(0)
+{
+	_decoder = std::move(decoder);
+	_fileSampleRate = _decoder->GetSampleRate();
+	_length = _decoder->GetLength();
+
+	_buffer.Init(std::max<uint32_t>((uint32_t)((uint64_t)_fileSampleRate * 4 * BufferMs / 1000), DecodeChunkSize * 4 * 4));
+
+	//The decoder is at the start of the file (request 0), so the decode thread starts prefetching right away
+	_stopFlag = false;
+	_decodeThread = std::thread([=]() {
+		DecodeThread();
+	});
+}
+
+AudioTrackPlayer::~AudioTrackPlayer()
+{
+	_stopFlag = true;
+	_decodeSignal.Signal();
+	_decodeThread.join();
+}
+
+void AudioTrackPlayer::DecodeThread()
+{
+	vector<int16_t> samples(DecodeChunkSize * 2);
+	uint32_t serial = 0;
+	uint64_t bytesWritten = 0;
+	bool endOfFile = false;
+	bool looped = false;
+
+	while(!_stopFlag) {
+		uint32_t requestSerial = _requestSerial.load(std::memory_order_acquire);
+		if(requestSerial != serial) {
+			uint32_t startSample;
+			{
+				auto lock = _requestLock.AcquireSafe();
+				startSample = _requestStartSample;
+			}
+
+			serial = requestSerial;
+			endOfFile = !_decoder->Seek(startSample);
+			looped = false;
+
+			//Everything written from this point on belongs to the new request
+			_ackStartByte.store(bytesWritten, std::memory_order_relaxed);
+			_ackSerial.store(serial, std::memory_order_release);
+			if(endOfFile) {
+				_wrapSerial.store(serial, std::memory_order_release);
+				_endSerial.store(serial, std::memory_order_release);
+			}
+		}
+
+		uint32_t space = (_buffer.GetCapacity() - _buffer.GetFillLevel()) / 4;
+		if(endOfFile || space < DecodeChunkSize) {
+			_decodeSignal.Wait();
+			continue;
+		}
+
+		uint32_t count = _decoder->Decode(samples.data(), DecodeChunkSize);
+		if(count == 0) {
+			//The loop settings are read and the end of the file is published under the lock, so Play() can tell
+			//whether its loop settings were used or not
+			auto lock = _requestLock.AcquireSafe();
+			_wrapSerial.store(serial, std::memory_order_release);
+			if(!looped && _requestLoop && _decoder->Seek(_requestLoopStart)) {
+				//Loop without any gap, unless the loop contains no samples at all
+				looped = true;
+				continue;
+			}
+			endOfFile = true;
+			_endSerial.store(serial, std::memory_order_release);
+			continue;
+		}
+
+		looped = false;
+		bytesWritten += _buffer.Write((uint8_t*)samples.data(), count * 4);
+	}
+}
+
+void AudioTrackPlayer::SendRequest(uint32_t startSample)
+{
+	{
+		auto lock = _requestLock.AcquireSafe();
+		_requestStartSample = startSample;
+	}
+
+	_serial++;
+	_requestSerial.store(_serial, std::memory_order_release);
+	_startSample = startSample;
+	_samplesPlayed = 0;
+	_resampler.Reset();
+
+	//Everything in the buffer was written before the request, drop it now so the decode thread has room for the new data
+	_bytesRead += _buffer.Skip(_buffer.GetFillLevel());
+	_decodeSignal.Signal();
+}
+
+void AudioTrackPlayer::Play(uint32_t startSample, bool loop, uint32_t loopStart)
+{
+	{
+		auto lock = _requestLock.AcquireSafe();
+		_requestLoop = loop;
+		_requestLoopStart = loopStart;
+	}
+	_loop = loop;
+	_loopStart = loopStart;
+
+	//Keep the data that was prefetched (e.g after Create or Seek) if it starts at the right sample and the decode
+	//thread has not reached the end of the file yet (i.e it will use the new loop settings)
+	if(_startSample != startSample || _samplesPlayed > 0 || _wrapSerial.load(std::memory_order_acquire) == _serial) {
+		SendRequest(startSample);
+	}
+
+	_playing = true;
+	_done = false;
+}
+
+void AudioTrackPlayer::Seek(uint32_t sample)
+{
+	SendRequest(sample);
+	if(_playing) {
+		//Resume playback if the end of the file had been reached
+		_done = false;
+	}
+}
+
+void AudioTrackPlayer::Stop()
+{
+	_playing = false;
+	_done = true;
+}
+
+bool AudioTrackPlayer::IsPlaybackOver()
+{
+	return _done;
+}
+
+void AudioTrackPlayer::ApplySamples(int16_t* buffer, size_t sampleCount, uint32_t sampleRate)
+{
+	if(!_playing || _done) {
+		return;
+	}
+
+	if(_ackSerial.load(std::memory_order_acquire) != _serial) {
+		//The decode thread has not processed the last seek yet
+		return;
+	}
+
+	//Discard the data that was decoded before the last seek (it is all in the buffer already), and wake up the decode
+	//thread right away since it may have been waiting for that space
+	uint64_t startByte = _ackStartByte.load(std::memory_order_relaxed);
+	if(_bytesRead < startByte) {
+		_bytesRead += _buffer.Skip((uint32_t)std::min<uint64_t>(startByte - _bytesRead, UINT32_MAX));
+		_decodeSignal.Signal();
+	}
+
+	_resampler.SetSampleRates(_fileSampleRate, sampleRate);
+
+	int32_t samplesNeeded = (int32_t)sampleCount - (int32_t)_resampler.GetPendingCount();
+	uint32_t count = 0;
+	if(samplesNeeded > 0) {
+		uint32_t samplesToLoad = (uint32_t)(samplesNeeded * (double)_fileSampleRate / sampleRate + 2);
+
+		//The end of the file must be checked before the fill level (the end is published after the last write)
+		bool endOfFile = _endSerial.load(std::memory_order_acquire) == _serial;
+		count = std::min(samplesToLoad, _buffer.GetFillLevel() / 4);
+		_samples.resize(samplesToLoad * 2);
+		_buffer.Read((uint8_t*)_samples.data(), count * 4);
+		_bytesRead += count * 4;
+		_samplesPlayed += count;
+
+		if(count < samplesToLoad) {
+			if(endOfFile) {
+				_done = true;
+			} else if(_bytesRead > startByte) {
+				//The decode thread is late (e.g slow disk) - not counted when it has not produced anything since the
+				//last seek yet, so that the count only reflects starvation
+				_underrunCount++;
+			}
+		}
+	}
+
+	_resampler.Resample<true>(_samples.data(), count, buffer, sampleCount);
+
+	if(_buffer.GetCapacity() - _buffer.GetFillLevel() >= DecodeChunkSize * 4) {
+		_decodeSignal.Signal();
+	}
+}
+
+int32_t AudioTrackPlayer::GetPosition()
+{
+	if(_done) {
+		return -1;
+	}
+
+	uint64_t position = _startSample + _samplesPlayed;
+	if(_loop && _loopStart < _length && position >= _length) {
+		position = _loopStart + (position - _length) % (_length - _loopStart);
+	}
+	return (int32_t)position;
+}
+
+uint32_t AudioTrackPlayer::GetSampleRate()
+{
+	return _fileSampleRate;
+}
+
+uint32_t AudioTrackPlayer::GetLength()
+{
+	return _length;
+}
+
+uint32_t AudioTrackPlayer::GetUnderrunCount()
+{
+	return _underrunCount;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "pch.h"
+#include <thread>
+#include "Utilities/AutoResetEvent.h"
+#include "Utilities/SimpleLock.h"
+#include "Utilities/Audio/AudioRingBuffer.h"
+#include "Utilities/Audio/SincResampler.h"
+
+class VirtualFile;
+class AudioTrackDecoder;
+
+//Streams a WAV (8/16/24/32-bit PCM or 32-bit float) or Ogg Vorbis file (e.g the tracks of soundtrack replacement packs)
+//without loading it in memory: a decode thread reads the file in chunks and keeps BufferMs of decoded stereo samples
+//ahead of playback in a lock-free ring buffer, which the audio thread reads from in ApplySamples.
+//Play/Seek/Stop are called by the audio thread: each seek increments the request serial, the decode thread then seeks
+//the decoder (sample-accurate for both formats) and publishes the ring buffer position at which the new data starts,
+//so the consumer can discard the data that was decoded before the seek without any locking.
+class AudioTrackPlayer
+{
+private:
+	static constexpr uint32_t BufferMs = 500;
+	static constexpr uint32_t DecodeChunkSize = 4096; //samples
+
+	unique_ptr<AudioTrackDecoder> _decoder;
+	uint32_t _fileSampleRate = 0;
+	uint32_t _length = 0;
+
+	std::thread _decodeThread;
+	AutoResetEvent _decodeSignal;
+	atomic<bool> _stopFlag;
+
+	AudioRingBuffer _buffer;
+
+	//Request parameters, written by the consumer and read by the decode thread
+	SimpleLock _requestLock;
+	uint32_t _requestStartSample = 0;
+	bool _requestLoop = false;
+	uint32_t _requestLoopStart = 0;
+
+	//Serial of the last request (consumer), and of the last request processed by the decode thread
+	atomic<uint32_t> _requestSerial;
+	atomic<uint32_t> _ackSerial;
+	//Serial of the request for which the decode thread has reached the end of the file (looped or not), and of the
+	//request for which it has reached the end of the file without looping (and will write no more data)
+	atomic<uint32_t> _wrapSerial;
+	atomic<uint32_t> _endSerial;
+	//Ring buffer position (total bytes written) at which the data for the acknowledged request starts
+	atomic<uint64_t> _ackStartByte;
+
+	//Consumer state
+	uint32_t _serial = 0;
+	uint64_t _bytesRead = 0;
+	uint32_t _startSample = 0;
+	uint64_t _samplesPlayed = 0;
+	bool _loop = false;
+	uint32_t _loopStart = 0;
+	bool _playing = false;
+	bool _done = true;
+	uint32_t _underrunCount = 0;
+	vector<int16_t> _samples;
+	SincResampler _resampler;
+
+	AudioTrackPlayer(unique_ptr<AudioTrackDecoder> decoder);
+
+	void SendRequest(uint32_t startSample);
+	void DecodeThread();
+
+public:
+	static unique_ptr<AudioTrackPlayer> Create(VirtualFile& file);
+	~AudioTrackPlayer();
+
+	void Play(uint32_t startSample, bool loop = false, uint32_t loopStart = 0);
+	void Seek(uint32_t sample);
+	void Stop();
+	bool IsPlaybackOver();
+	void ApplySamples(int16_t* buffer, size_t sampleCount, uint32_t sampleRate);
+
+	int32_t GetPosition();
+	uint32_t GetSampleRate();
+	uint32_t GetLength();
+	uint32_t GetUnderrunCount();
+};
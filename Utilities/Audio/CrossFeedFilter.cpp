@@ -1,15 +1,22 @@
 #include "pch.h"
 #include "CrossFeedFilter.h"
+#include "AudioConverter.h"
 
 void CrossFeedFilter::ApplyFilter(int16_t *stereoBuffer, size_t sampleCount, int ratio)
 {
-	for(size_t i = 0; i < sampleCount; i++) {
-		int16_t leftSample = stereoBuffer[0];
-		int16_t rightSample = stereoBuffer[1];
+	AudioConverter::ProcessInterleaved(stereoBuffer, sampleCount, [&](float* left, float* right, uint32_t count) {
+		ApplyFilter(left, right, count, ratio);
+	});
+}
 
-		stereoBuffer[0] += rightSample * ratio / 100;
-		stereoBuffer[1] += leftSample * ratio / 100;
+void CrossFeedFilter::ApplyFilter(float* left, float* right, uint32_t sampleCount, int ratio)
+{
+	float factor = ratio / 100.0f;
+	for(uint32_t i = 0; i < sampleCount; i++) {
+		float leftSample = left[i];
+		float rightSample = right[i];
 
-		stereoBuffer += 2;
+		left[i] += rightSample * factor;
+		right[i] += leftSample * factor;
 	}
 }
@@ -4,4 +4,5 @@ class CrossFeedFilter
 {
 public:
 	void ApplyFilter(int16_t* stereoBuffer, size_t sampleCount, int ratio);
+	void ApplyFilter(float* left, float* right, uint32_t sampleCount, int ratio);
 };
\ No newline at end of file
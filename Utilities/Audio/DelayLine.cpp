@@ -0,0 +1,51 @@
+#include "pch.h"
+#include "DelayLine.h"
+
+void DelayLine::SetMaxDelay(uint32_t maxDelay)
+{
+	//+1 for the interpolation of fractional delays
+	uint32_t requiredSize = maxDelay + MaxBlockSize + 1;
+	if(_samples.size() < requiredSize) {
+		uint32_t size = 1;
+		while(size < requiredSize) {
+			size <<= 1;
+		}
+		_samples.assign(size, 0);
+		_mask = size - 1;
+		_writePosition = 0;
+	}
+}
+
+void DelayLine::Reset()
+{
+	std::fill(_samples.begin(), _samples.end(), 0.0f);
+	_writePosition = 0;
+}
+
+void DelayLine::Write(const float* input, uint32_t count)
+{
+	uint32_t pos = _writePosition;
+	for(uint32_t i = 0; i < count; i++) {
+		_samples[(pos + i) & _mask] = input[i];
+	}
+	_writePosition = (pos + count) & _mask;
+}
+
+void DelayLine::Read(float* output, uint32_t count, double delay)
+{
+	uint32_t wholeDelay = (uint32_t)delay;
+	float fraction = (float)(delay - wholeDelay);
+	uint32_t pos = _writePosition - wholeDelay;
+
+	if(fraction == 0) {
+		for(uint32_t i = 0; i < count; i++) {
+			output[i] = _samples[(pos + i) & _mask];
+		}
+	} else {
+		for(uint32_t i = 0; i < count; i++) {
+			float sample = _samples[(pos + i) & _mask];
+			float prevSample = _samples[(pos + i - 1) & _mask];
+			output[i] = sample + (prevSample - sample) * fraction;
+		}
+	}
+}
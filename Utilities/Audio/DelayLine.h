@@ -0,0 +1,31 @@
+#pragma once
+#include "pch.h"
+
+//Fixed-capacity circular buffer that keeps the last samples written to it (mono), for delay-based effects
+//Samples are read relative to the write position: a delay of N reads the sample written N samples ago (the buffer
+//starts out filled with silence).
+class DelayLine
+{
+public:
+	//Filters process their input in blocks of up to this many samples
+	static constexpr uint32_t MaxBlockSize = 1024;
+
+private:
+	vector<float> _samples;
+	uint32_t _mask = 0;
+	uint32_t _writePosition = 0;
+
+public:
+	//Makes sure delays of up to maxDelay + MaxBlockSize samples can be read - when the buffer
+	//needs to grow, it is reallocated and its content is lost
+	void SetMaxDelay(uint32_t maxDelay);
+
+	//Fills the buffer with silence
+	void Reset();
+
+	void Write(const float* input, uint32_t count);
+
+	//Reads count samples, starting with the one written delay samples ago (delay >= count unless the samples were written already)
+	//Fractional delays are linearly interpolated between the 2 nearest samples
+	void Read(float* output, uint32_t count, double delay);
+};
@@ -1,42 +1,297 @@
 #include "pch.h"
+#include <complex>
 #include "Equalizer.h"
+#include "AudioConverter.h"
 #include "orfanidis_eq.h"
+#include "../CpuFeatures.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+	#include <immintrin.h>
+	#define EQUALIZER_SSE2
+#endif
+
+namespace {
+	constexpr uint32_t ChannelLanes = Equalizer::ChannelLanes;
+	constexpr uint32_t LaneCount = Equalizer::LaneCount;
+	constexpr uint32_t BiquadsPerBand = Equalizer::BiquadsPerBand;
+
+	//Coefficients of a 4th order section of orfanidis_eq's butterworth_bp_filter (b0-b4, a0-a4)
+	struct FourthOrderSection
+	{
+		double B[5];
+		double A[5];
+	};
+
+	//Same design as orfanidis_eq::eq1 with butterworth filters (N=4, 2 sections per band)
+	void GetBandSections(double w0, double wb, FourthOrderSection sections[2])
+	{
+		using namespace orfanidis_eq;
+		constexpr unsigned int N = default_eq_band_filters_order;
+
+		double G = conversions::db_2_lin(max_base_gain_db);
+		double Gb = conversions::db_2_lin(butterworth_band_gain_db);
+		double G0 = conversions::db_2_lin(min_base_gain_db);
+
+		double epsilon = pow((G*G - Gb*Gb) / (Gb*Gb - G0*G0), 0.5);
+		double g = pow(G, 1.0 / N);
+		double g0 = pow(G0, 1.0 / N);
+		double beta = pow(epsilon, -1.0 / N) * tan(wb / 2.0);
+		double c0 = cos(w0);
+
+		for(unsigned int i = 1; i <= N / 2; i++) {
+			double s = sin(pi * ((2.0*i - 1) / N) / 2.0);
+			double D = beta*beta + 2 * s*beta + 1;
+
+			FourthOrderSection& section = sections[i - 1];
+			section.B[0] = (g*g*beta*beta + 2 * g*g0*s*beta + g0*g0) / D;
+			section.B[1] = -4 * c0*(g0*g0 + g*g0*s*beta) / D;
+			section.B[2] = 2 * (g0*g0*(1 + 2 * c0*c0) - g*g*beta*beta) / D;
+			section.B[3] = -4 * c0*(g0*g0 - g*g0*s*beta) / D;
+			section.B[4] = (g*g*beta*beta - 2 * g*g0*s*beta + g0*g0) / D;
+
+			section.A[0] = 1;
+			section.A[1] = -4 * c0*(1 + s*beta) / D;
+			section.A[2] = 2 * (1 + 2 * c0*c0 - beta*beta) / D;
+			section.A[3] = -4 * c0*(1 - s*beta) / D;
+			section.A[4] = (beta*beta - 2 * s*beta + 1) / D;
+		}
+	}
+
+	//Finds the roots of c[0]*z^4 + c[1]*z^3 + ... + c[4] (Durand-Kerner), sorted by their imaginary part
+	void GetQuarticRoots(const double c[5], std::complex<double> roots[4])
+	{
+		std::complex<double> seed(0.4, 0.9);
+		for(int i = 0; i < 4; i++) {
+			roots[i] = std::pow(seed, i);
+		}
+
+		auto evaluate = [c](std::complex<double> z) {
+			return (((z + c[1] / c[0]) * z + c[2] / c[0]) * z + c[3] / c[0]) * z + c[4] / c[0];
+		};
+
+		for(int iteration = 0; iteration < 1000; iteration++) {
+			double maxDelta = 0;
+			for(int i = 0; i < 4; i++) {
+				std::complex<double> denominator = 1.0;
+				for(int j = 0; j < 4; j++) {
+					if(i != j) {
+						denominator *= roots[i] - roots[j];
+					}
+				}
+				std::complex<double> delta = evaluate(roots[i]) / denominator;
+				roots[i] -= delta;
+				maxDelta = std::max(maxDelta, std::abs(delta));
+			}
+			if(maxDelta < 1e-15) {
+				break;
+			}
+		}
+
+		std::sort(roots, roots + 4, [](std::complex<double> a, std::complex<double> b) { return a.imag() > b.imag(); });
+	}
+
+	//Splits a 4th order polynomial (in z^-1) into 2 real quadratics: q[i][0] + q[i][1]*z^-1 + q[i][2]*z^-2
+	//Once sorted by their imaginary part, roots 0 & 3 and roots 1 & 2 are either conjugates or both real
+	void FactorSection(const double c[5], double q[2][3], std::complex<double> roots[4])
+	{
+		GetQuarticRoots(c, roots);
+		std::complex<double> pairs[2][2] = { { roots[0], roots[3] }, { roots[1], roots[2] } };
+		for(int i = 0; i < 2; i++) {
+			q[i][0] = i == 0 ? c[0] : 1.0;
+			q[i][1] = -(pairs[i][0] + pairs[i][1]).real() * q[i][0];
+			q[i][2] = (pairs[i][0] * pairs[i][1]).real() * q[i][0];
+		}
+	}
+
+	//Converts a biquad (b0 + b1*z^-1 + b2*z^-2) / (1 + a1*z^-1 + a2*z^-2) to the SVF's coefficients
+	//The SVF's response is (m0*(s^2 + k*s + 1) + m1*s + m2) / (s^2 + k*s + 1), with the bilinear transform s = (1/g)*(1-z^-1)/(1+z^-1)
+	void SetBiquad(Equalizer::Biquads& biquads, uint32_t index, uint32_t lane, const double b[3], const double a[3], double gain)
+	{
+		double g = std::sqrt((1 + a[1] + a[2]) / (1 - a[1] + a[2]));
+		double d = 4 / (1 - a[1] + a[2]);
+		double k = (1 - a[2]) * d / (2 * g);
+
+		double n0 = (b[0] + b[1] + b[2]) * d / (4 * g * g);
+		double n1 = (b[0] - b[2]) * d / (2 * g);
+		double n2 = (b[0] - b[1] + b[2]) * d / 4;
+
+		double a1 = 1 / (1 + g * (g + k));
+		for(uint32_t channelLane : { lane, lane + ChannelLanes }) {
+			biquads.A1[index][channelLane] = (float)a1;
+			biquads.A2[index][channelLane] = (float)(g * a1);
+			biquads.A3[index][channelLane] = (float)(g * g * a1);
+			biquads.M0[index][channelLane] = (float)(n2 * gain);
+			biquads.M1[index][channelLane] = (float)((n1 - n2 * k) * gain);
+			biquads.M2[index][channelLane] = (float)((n0 - n2) * gain);
+		}
+	}
+
+	void ProcessScalar(Equalizer::Biquads& bq, float* left, float* right, uint32_t count)
+	{
+		for(uint32_t i = 0; i < count; i++) {
+			float out[2] = {};
+			for(uint32_t lane = 0; lane < LaneCount; lane++) {
+				float x = lane < ChannelLanes ? left[i] : right[i];
+				for(uint32_t k = 0; k < BiquadsPerBand; k++) {
+					float ic1 = bq.Ic1[k][lane];
+					float ic2 = bq.Ic2[k][lane];
+					float v3 = x - ic2;
+					float v1 = bq.A1[k][lane] * ic1 + bq.A2[k][lane] * v3;
+					float v2 = ic2 + bq.A2[k][lane] * ic1 + bq.A3[k][lane] * v3;
+					bq.Ic1[k][lane] = v1 + v1 - ic1;
+					bq.Ic2[k][lane] = v2 + v2 - ic2;
+					x = bq.M0[k][lane] * x + bq.M1[k][lane] * v1 + bq.M2[k][lane] * v2;
+				}
+				out[lane < ChannelLanes ? 0 : 1] += x;
+			}
+			left[i] = out[0];
+			right[i] = out[1];
+		}
+	}
+
+#ifdef EQUALIZER_SSE2
+	void ProcessSse2(Equalizer::Biquads& bq, float* left, float* right, uint32_t count)
+	{
+		for(uint32_t i = 0; i < count; i++) {
+			__m128 input[2] = { _mm_set1_ps(left[i]), _mm_set1_ps(right[i]) };
+			__m128 sum[2] = { _mm_setzero_ps(), _mm_setzero_ps() };
+			for(uint32_t lane = 0; lane < LaneCount; lane += 4) {
+				int channel = lane < ChannelLanes ? 0 : 1;
+				__m128 x = input[channel];
+				for(uint32_t k = 0; k < BiquadsPerBand; k++) {
+					__m128 ic1 = _mm_load_ps(&bq.Ic1[k][lane]);
+					__m128 ic2 = _mm_load_ps(&bq.Ic2[k][lane]);
+					__m128 v3 = _mm_sub_ps(x, ic2);
+					__m128 v1 = _mm_add_ps(_mm_mul_ps(_mm_load_ps(&bq.A1[k][lane]), ic1), _mm_mul_ps(_mm_load_ps(&bq.A2[k][lane]), v3));
+					__m128 v2 = _mm_add_ps(ic2, _mm_add_ps(_mm_mul_ps(_mm_load_ps(&bq.A2[k][lane]), ic1), _mm_mul_ps(_mm_load_ps(&bq.A3[k][lane]), v3)));
+					_mm_store_ps(&bq.Ic1[k][lane], _mm_sub_ps(_mm_add_ps(v1, v1), ic1));
+					_mm_store_ps(&bq.Ic2[k][lane], _mm_sub_ps(_mm_add_ps(v2, v2), ic2));
+					__m128 y = _mm_add_ps(_mm_mul_ps(_mm_load_ps(&bq.M0[k][lane]), x), _mm_mul_ps(_mm_load_ps(&bq.M1[k][lane]), v1));
+					x = _mm_add_ps(y, _mm_mul_ps(_mm_load_ps(&bq.M2[k][lane]), v2));
+				}
+				sum[channel] = _mm_add_ps(sum[channel], x);
+			}
+
+			for(int channel = 0; channel < 2; channel++) {
+				__m128 total = _mm_add_ps(sum[channel], _mm_movehl_ps(sum[channel], sum[channel]));
+				total = _mm_add_ss(total, _mm_shuffle_ps(total, total, 1));
+				(channel == 0 ? left : right)[i] = _mm_cvtss_f32(total);
+			}
+		}
+	}
+
+	CPU_TARGET_AVX2 void ProcessAvx2(Equalizer::Biquads& bq, float* left, float* right, uint32_t count)
+	{
+		for(uint32_t i = 0; i < count; i++) {
+			__m256 input[2] = { _mm256_set1_ps(left[i]), _mm256_set1_ps(right[i]) };
+			__m256 sum[2] = { _mm256_setzero_ps(), _mm256_setzero_ps() };
+			for(uint32_t lane = 0; lane < LaneCount; lane += 8) {
+				int channel = lane < ChannelLanes ? 0 : 1;
+				__m256 x = input[channel];
+				for(uint32_t k = 0; k < BiquadsPerBand; k++) {
+					__m256 ic1 = _mm256_load_ps(&bq.Ic1[k][lane]);
+					__m256 ic2 = _mm256_load_ps(&bq.Ic2[k][lane]);
+					__m256 v3 = _mm256_sub_ps(x, ic2);
+					__m256 v1 = _mm256_add_ps(_mm256_mul_ps(_mm256_load_ps(&bq.A1[k][lane]), ic1), _mm256_mul_ps(_mm256_load_ps(&bq.A2[k][lane]), v3));
+					__m256 v2 = _mm256_add_ps(ic2, _mm256_add_ps(_mm256_mul_ps(_mm256_load_ps(&bq.A2[k][lane]), ic1), _mm256_mul_ps(_mm256_load_ps(&bq.A3[k][lane]), v3)));
+					_mm256_store_ps(&bq.Ic1[k][lane], _mm256_sub_ps(_mm256_add_ps(v1, v1), ic1));
+					_mm256_store_ps(&bq.Ic2[k][lane], _mm256_sub_ps(_mm256_add_ps(v2, v2), ic2));
+					__m256 y = _mm256_add_ps(_mm256_mul_ps(_mm256_load_ps(&bq.M0[k][lane]), x), _mm256_mul_ps(_mm256_load_ps(&bq.M1[k][lane]), v1));
+					x = _mm256_add_ps(y, _mm256_mul_ps(_mm256_load_ps(&bq.M2[k][lane]), v2));
+				}
+				sum[channel] = _mm256_add_ps(sum[channel], x);
+			}
+
+			for(int channel = 0; channel < 2; channel++) {
+				__m128 total = _mm_add_ps(_mm256_castps256_ps128(sum[channel]), _mm256_extractf128_ps(sum[channel], 1));
+				total = _mm_add_ps(total, _mm_movehl_ps(total, total));
+				total = _mm_add_ss(total, _mm_shuffle_ps(total, total, 1));
+				(channel == 0 ? left : right)[i] = _mm_cvtss_f32(total);
+			}
+		}
+	}
+#endif
+
+	CpuDispatch<void(*)(Equalizer::Biquads&, float*, float*, uint32_t)> ProcessBiquads({
+		{ CpuTier::Scalar, ProcessScalar },
+#ifdef EQUALIZER_SSE2
+		{ CpuTier::Sse2, ProcessSse2 },
+		{ CpuTier::Avx2, ProcessAvx2 },
+#endif
+	});
+}
 
 void Equalizer::ApplyEqualizer(uint32_t sampleCount, int16_t *samples)
 {
-	double outL, outR;
-	for(uint32_t i = 0; i < sampleCount; i++) {
-		double inL = samples[i * 2];
-		double inR = samples[i * 2 + 1];
-			
-		_equalizerLeft->sbs_process(&inL, &outL);
-		_equalizerRight->sbs_process(&inR, &outR);
+	if(!_biquads) {
+		return;
+	}
+
+	AudioConverter::ProcessInterleaved(samples, sampleCount, [this](float* left, float* right, uint32_t count) {
+		ProcessBiquads(*_biquads, left, right, count);
+	});
+
+	FlushDenormals();
+}
+
+void Equalizer::ApplyEqualizer(float* left, float* right, uint32_t sampleCount)
+{
+	if(!_biquads) {
+		return;
+	}
 
-		samples[i * 2] = (int16_t)std::max(std::min(outL, 32767.0), -32768.0);
-		samples[i * 2 + 1] = (int16_t)std::max(std::min(outR, 32767.0), -32768.0);
+	ProcessBiquads(*_biquads, left, right, sampleCount);
+	FlushDenormals();
+}
+
+void Equalizer::FlushDenormals()
+{
+	//Prevent denormalized values when the output decays to silence (causes extreme performance loss)
+	for(uint32_t k = 0; k < BiquadsPerBand; k++) {
+		for(uint32_t lane = 0; lane < LaneCount; lane++) {
+			if(std::abs(_biquads->Ic1[k][lane]) < 1e-15f) {
+				_biquads->Ic1[k][lane] = 0;
+			}
+			if(std::abs(_biquads->Ic2[k][lane]) < 1e-15f) {
+				_biquads->Ic2[k][lane] = 0;
+			}
+		}
 	}
 }
 
-void Equalizer::UpdateEqualizers(vector<double> bandGains, uint32_t sampleRate)
+void Equalizer::UpdateEqualizers(const vector<double>& bandGains, uint32_t sampleRate)
 {
 	if(_prevSampleRate != sampleRate || memcmp(bandGains.data(), _prevEqualizerGains.data(), bandGains.size() * sizeof(double)) != 0) {
 		vector<double> bands = { 40, 56, 80, 113, 160, 225, 320, 450, 600, 750, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 10000, 12500, 13000 };
 		bands.insert(bands.begin(), bands[0] - (bands[1] - bands[0]));
 		bands.insert(bands.end(), bands[bands.size() - 1] + (bands[bands.size() - 1] - bands[bands.size() - 2]));
 
-		_eqFrequencyGrid.reset(new orfanidis_eq::freq_grid());
-		for(size_t i = 1; i < bands.size() - 1; i++) {
-			_eqFrequencyGrid->add_band((bands[i] + bands[i - 1]) / 2, bands[i], (bands[i + 1] + bands[i]) / 2);
-		}
+		//Padding lanes keep their default values (0), so their output is always 0
+		_biquads.reset(new Biquads());
+		orfanidis_eq::conversions conversions(orfanidis_eq::eq_min_max_gain_db);
+
+		for(uint32_t i = 0; i < BandCount; i++) {
+			double minFreq = (bands[i + 1] + bands[i]) / 2;
+			double maxFreq = (bands[i + 2] + bands[i + 1]) / 2;
+			double w0 = orfanidis_eq::conversions::hz_2_rad(bands[i + 1], sampleRate);
+			double wb = orfanidis_eq::conversions::hz_2_rad(maxFreq - minFreq, sampleRate);
+
+			FourthOrderSection sections[2];
+			GetBandSections(w0, wb, sections);
 
-		_equalizerLeft.reset(new orfanidis_eq::eq1(_eqFrequencyGrid.get(), orfanidis_eq::filter_type::butterworth));
-		_equalizerRight.reset(new orfanidis_eq::eq1(_eqFrequencyGrid.get(), orfanidis_eq::filter_type::butterworth));
-		_equalizerLeft->set_sample_rate(sampleRate);
-		_equalizerRight->set_sample_rate(sampleRate);
+			double gain = conversions.fast_db_2_lin(bandGains[i]);
+			for(int j = 0; j < 2; j++) {
+				//Each zero pair is matched with the closest pole pair
+				double num[2][3], den[2][3];
+				std::complex<double> zeros[4], poles[4];
+				FactorSection(sections[j].B, num, zeros);
+				FactorSection(sections[j].A, den, poles);
+				bool swapZeros = std::abs(zeros[0] - poles[1]) + std::abs(zeros[1] - poles[0]) < std::abs(zeros[0] - poles[0]) + std::abs(zeros[1] - poles[1]);
 
-		for(unsigned int i = 0; i < _eqFrequencyGrid->get_number_of_bands(); i++) {
-			_equalizerLeft->change_band_gain_db(i, bandGains[i]);
-			_equalizerRight->change_band_gain_db(i, bandGains[i]);
+				SetBiquad(*_biquads, j * 2, i, swapZeros ? num[1] : num[0], den[0], j == 0 ? gain : 1.0);
+				SetBiquad(*_biquads, j * 2 + 1, i, swapZeros ? num[0] : num[1], den[1], 1.0);
+			}
 		}
 
 		_prevSampleRate = sampleRate;
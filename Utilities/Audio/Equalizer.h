@@ -1,18 +1,47 @@
 #pragma once
 #include "pch.h"
-#include "orfanidis_eq.h"
 
+//20-band equalizer (4th order Butterworth band-pass filter for each band, as designed by orfanidis_eq)
+//Each band's filter is split into 4 biquads, and the biquads are stored as a structure of arrays (one lane per band,
+//for each channel) so that all bands/channels can be processed in parallel with SIMD, in float.
+//The output is within 1 LSB of orfanidis_eq's double precision filters when no band is boosted. Boosted bands amplify the
+//float rounding errors along with the signal: at +20dB on loud input, the output can differ by 3-10 LSB (more at 96kHz).
 class Equalizer
 {
+public:
+	static constexpr uint32_t BandCount = 20;
+	static constexpr uint32_t BiquadsPerBand = 4;
+
+	//Lanes for each channel, padded to a multiple of 8 (the padding lanes have no effect on the output)
+	static constexpr uint32_t ChannelLanes = (BandCount + 7) & ~7;
+	static constexpr uint32_t LaneCount = ChannelLanes * 2;
+
+	struct Biquads
+	{
+		//Each biquad is implemented as a trapezoidal state variable filter (Andrew Simper's SVF) - unlike the direct forms,
+		//it keeps enough precision in float for the low frequency bands (whose poles are very close to 1)
+		//Lanes [0, ChannelLanes) are for the left channel, the others for the right channel
+		//The band's gain is applied to the first biquad's output mix (M0-M2)
+		alignas(32) float A1[BiquadsPerBand][LaneCount];
+		alignas(32) float A2[BiquadsPerBand][LaneCount];
+		alignas(32) float A3[BiquadsPerBand][LaneCount];
+		alignas(32) float M0[BiquadsPerBand][LaneCount];
+		alignas(32) float M1[BiquadsPerBand][LaneCount];
+		alignas(32) float M2[BiquadsPerBand][LaneCount];
+		alignas(32) float Ic1[BiquadsPerBand][LaneCount];
+		alignas(32) float Ic2[BiquadsPerBand][LaneCount];
+	};
+
 private:
-	unique_ptr<orfanidis_eq::freq_grid> _eqFrequencyGrid;
-	unique_ptr<orfanidis_eq::eq1> _equalizerLeft;
-	unique_ptr<orfanidis_eq::eq1> _equalizerRight;
+	unique_ptr<Biquads> _biquads;
 
 	uint32_t _prevSampleRate = 0;
 	vector<double> _prevEqualizerGains;
 
+	void FlushDenormals();
+
 public:
 	void ApplyEqualizer(uint32_t sampleCount, int16_t *samples);
-	void UpdateEqualizers(vector<double> bandGains, uint32_t sampleRate);
-};
\ No newline at end of file
+	void ApplyEqualizer(float* left, float* right, uint32_t sampleCount);
+	void UpdateEqualizers(const vector<double>& bandGains, uint32_t sampleRate);
+};
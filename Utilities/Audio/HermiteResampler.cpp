@@ -90,6 +90,12 @@ uint32_t HermiteResampler::Resample(int16_t* in, uint32_t inSampleCount, int16_t
 			_left = in[inSampleCount * 2 - 2];
 			_right = in[inSampleCount * 2 - 1];
 			outPos += count;
+
+			//Keep the interpolation history up to date in case the rate ratio changes
+			for(uint32_t i = inSampleCount > 4 ? inSampleCount - 4 : 0; i < inSampleCount; i++) {
+				PushSample(_prevLeft, in[i * 2]);
+				PushSample(_prevRight, in[i * 2 + 1]);
+			}
 		}
 	} else {
 		for(uint32_t i = 0; i < inSampleCount * 2; i += 2) {
@@ -2,33 +2,41 @@
 #include "pch.h"
 #include <assert.h>
 #include <numeric>
+#include "AudioConverter.h"
 
 class LowPassFilter
 {
 private:
 	uint8_t _prevSampleCounter = 0;
-	int16_t _prevSamplesLeft[10] = { 0,0,0,0,0,0,0,0,0,0 };
-	int16_t _prevSamplesRight[10] = { 0,0,0,0,0,0,0,0,0,0 };
+	float _prevSamplesLeft[10] = { 0,0,0,0,0,0,0,0,0,0 };
+	float _prevSamplesRight[10] = { 0,0,0,0,0,0,0,0,0,0 };
 
-	void UpdateSample(int16_t *buffer, size_t index, int strength, double volume, int16_t *_prevSamples)
+	void UpdateSample(float *buffer, size_t index, int strength, float volume, float *_prevSamples)
 	{
 		if(strength > 0) {
-			int32_t sum = std::accumulate(_prevSamples, _prevSamples + strength, 0);
-			buffer[index] = (int16_t)((sum + buffer[index]) / (strength + 1) * volume);
+			float sum = std::accumulate(_prevSamples, _prevSamples + strength, 0.0f);
+			buffer[index] = (sum + buffer[index]) / (strength + 1) * volume;
 			_prevSamples[_prevSampleCounter] = buffer[index];
 		} else {
-			buffer[index] = (int16_t)(buffer[index] * volume);
+			buffer[index] = buffer[index] * volume;
 		}
 	}
 
 public:
 	void ApplyFilter(int16_t *buffer, size_t sampleCount, int strength, double volume = 1.0f)
+	{
+		AudioConverter::ProcessInterleaved(buffer, sampleCount, [&](float* left, float* right, uint32_t count) {
+			ApplyFilter(left, right, count, strength, volume);
+		});
+	}
+
+	void ApplyFilter(float *left, float *right, uint32_t sampleCount, int strength, double volume = 1.0f)
 	{
 		assert(strength <= 10);
 
-		for(size_t i = 0; i < sampleCount*2; i+=2) {
-			UpdateSample(buffer, i, strength, volume, _prevSamplesLeft);
-			UpdateSample(buffer, i+1, strength, volume, _prevSamplesRight);
+		for(uint32_t i = 0; i < sampleCount; i++) {
+			UpdateSample(left, i, strength, (float)volume, _prevSamplesLeft);
+			UpdateSample(right, i, strength, (float)volume, _prevSamplesRight);
 			if(strength > 0) {
 				_prevSampleCounter = (_prevSampleCounter + 1) % strength;
 			}
@@ -1,29 +1,55 @@
 #include "pch.h"
 #include "ReverbFilter.h"
+#include "AudioConverter.h"
 
 void ReverbFilter::ResetFilter()
 {
-	for(int i = 0; i < 5; i++) {
+	for(int i = 0; i < 2; i++) {
 		_delay[i].Reset();
 	}
 }
 
 void ReverbFilter::ApplyFilter(int16_t* stereoBuffer, size_t sampleCount, uint32_t sampleRate, double reverbStrength, double reverbDelay)
 {
-	for(int i = 0; i < 2; i++) {
-		_delay[i*5].SetParameters(550 * reverbDelay, 0.25 * reverbStrength, sampleRate);
-		_delay[i*5+1].SetParameters(330 * reverbDelay, 0.15 * reverbStrength, sampleRate);
-		_delay[i*5+2].SetParameters(485 * reverbDelay, 0.12 * reverbStrength, sampleRate);
-		_delay[i*5+3].SetParameters(150 * reverbDelay, 0.20 * reverbStrength, sampleRate);
-		_delay[i*5+4].SetParameters(285 * reverbDelay, 0.05 * reverbStrength, sampleRate);
+	AudioConverter::ProcessInterleaved(stereoBuffer, sampleCount, [&](float* left, float* right, uint32_t count) {
+		ApplyFilter(left, right, count, sampleRate, reverbStrength, reverbDelay);
+	});
+}
+
+void ReverbFilter::ApplyFilter(float* left, float* right, uint32_t sampleCount, uint32_t sampleRate, double reverbStrength, double reverbDelay)
+{
+	//Delay (ms) & decay of each tap
+	static constexpr double tapDelays[TapCount] = { 550, 330, 485, 150, 285 };
+	static constexpr double tapDecays[TapCount] = { 0.25, 0.15, 0.12, 0.20, 0.05 };
+
+	double delays[TapCount];
+	float decays[TapCount];
+	double minDelay = (double)DelayLine::MaxBlockSize;
+	double maxDelay = 1;
+	for(int i = 0; i < TapCount; i++) {
+		delays[i] = std::max(1.0, tapDelays[i] * reverbDelay / 1000 * sampleRate);
+		decays[i] = (float)(tapDecays[i] * reverbStrength);
+		minDelay = std::min(minDelay, delays[i]);
+		maxDelay = std::max(maxDelay, delays[i]);
 	}
 
-	for(int i = 0; i < 5; i++) {
-		_delay[i].ApplyReverb(stereoBuffer, sampleCount);
-		_delay[i+5].ApplyReverb(stereoBuffer+1, sampleCount);
+	for(int i = 0; i < 2; i++) {
+		_delay[i].SetMaxDelay((uint32_t)maxDelay + 1);
 	}
-	for(int i = 0; i < 5; i++) {
-		_delay[i].AddSamples(stereoBuffer, sampleCount);
-		_delay[i+5].AddSamples(stereoBuffer+1, sampleCount);
+
+	//The output is fed back into the delay lines, so each block must be shorter than the shortest delay
+	uint32_t blockSize = (uint32_t)minDelay;
+	for(uint32_t i = 0; i < sampleCount; i += blockSize) {
+		uint32_t count = std::min(sampleCount - i, blockSize);
+		for(int channel = 0; channel < 2; channel++) {
+			float* samples = (channel == 0 ? left : right) + i;
+			for(int tap = 0; tap < TapCount; tap++) {
+				_delay[channel].Read(_tapSamples, count, delays[tap]);
+				for(uint32_t j = 0; j < count; j++) {
+					samples[j] += _tapSamples[j] * decays[tap];
+				}
+			}
+			_delay[channel].Write(samples, count);
+		}
 	}
 }
\ No newline at end of file
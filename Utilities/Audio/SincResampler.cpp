@@ -0,0 +1,349 @@
+#include "pch.h"
+#include <cmath>
+#include "SincResampler.h"
+#include "../CpuFeatures.h"
+#include "../SimpleLock.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+	#include <immintrin.h>
+	#define SINCRESAMPLER_SSE2
+#endif
+
+namespace
+{
+	using FilterTable = SincResampler::FilterTable;
+
+	//Cutoff frequencies are quantized to steps of 1/CutoffSteps of the nyquist frequency, to limit the number of tables
+	constexpr uint32_t CutoffSteps = 256;
+
+	constexpr uint32_t PhaseShift = 32 - SincResampler::PhaseBits;
+	constexpr float PhaseScale = 1.0f / (1 << PhaseShift);
+
+	struct QualitySettings
+	{
+		uint32_t Taps;
+		double Bandwidth; //Fraction of the nyquist frequency that is kept
+		double KaiserBeta;
+	};
+
+	QualitySettings GetQualitySettings(SincResampler::Quality quality)
+	{
+		switch(quality) {
+			case SincResampler::Quality::Low: return { 8, 0.80, 5.0 };
+			default:
+			case SincResampler::Quality::Medium: return { 16, 0.88, 7.0 };
+			case SincResampler::Quality::High: return { 32, 0.93, 8.5 };
+		}
+	}
+
+	//Modified bessel function of the first kind (order 0), for the Kaiser window
+	double BesselI0(double x)
+	{
+		double sum = 1.0;
+		double term = 1.0;
+		for(int k = 1; k < 50; k++) {
+			term *= (x / (2 * k)) * (x / (2 * k));
+			sum += term;
+			if(term < sum * 1e-12) {
+				break;
+			}
+		}
+		return sum;
+	}
+
+	//Returns the coefficients to use for the output sample at the given position (and the interpolation factor between them)
+	__forceinline const float* GetCoefficients(const FilterTable& filter, uint64_t position, float& mu)
+	{
+		uint32_t fraction = (uint32_t)position;
+		mu = (float)(fraction & ((1 << PhaseShift) - 1)) * PhaseScale;
+		return filter.Coefficients.data() + (fraction >> PhaseShift) * filter.Taps;
+	}
+
+	//Generates output samples (interleaved) until maxCount samples are generated or the input runs out
+	uint32_t ConvolveScalar(const FilterTable& filter, const float* left, const float* right, uint32_t inputSize, uint64_t& position, uint64_t step, float* out, uint32_t maxCount)
+	{
+		uint32_t taps = filter.Taps;
+		uint64_t pos = position;
+		uint32_t count = 0;
+		for(; count < maxCount && (pos >> 32) + taps <= inputSize; count++) {
+			float mu;
+			const float* c0 = GetCoefficients(filter, pos, mu);
+			const float* c1 = c0 + taps;
+			const float* l = left + (pos >> 32);
+			const float* r = right + (pos >> 32);
+
+			float sumLeft = 0;
+			float sumRight = 0;
+			for(uint32_t k = 0; k < taps; k++) {
+				float c = c0[k] + (c1[k] - c0[k]) * mu;
+				sumLeft += l[k] * c;
+				sumRight += r[k] * c;
+			}
+			out[count * 2] = sumLeft;
+			out[count * 2 + 1] = sumRight;
+			pos += step;
+		}
+		position = pos;
+		return count;
+	}
+
+#ifdef SINCRESAMPLER_SSE2
+	uint32_t ConvolveSse2(const FilterTable& filter, const float* left, const float* right, uint32_t inputSize, uint64_t& position, uint64_t step, float* out, uint32_t maxCount)
+	{
+		uint32_t taps = filter.Taps;
+		uint64_t pos = position;
+		uint32_t count = 0;
+		for(; count < maxCount && (pos >> 32) + taps <= inputSize; count++) {
+			float mu;
+			const float* c0 = GetCoefficients(filter, pos, mu);
+			const float* c1 = c0 + taps;
+			const float* l = left + (pos >> 32);
+			const float* r = right + (pos >> 32);
+
+			__m128 factor = _mm_set1_ps(mu);
+			__m128 sumLeft = _mm_setzero_ps();
+			__m128 sumRight = _mm_setzero_ps();
+			for(uint32_t k = 0; k < taps; k += 4) {
+				__m128 a = _mm_loadu_ps(c0 + k);
+				__m128 c = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(c1 + k), a), factor));
+				sumLeft = _mm_add_ps(sumLeft, _mm_mul_ps(_mm_loadu_ps(l + k), c));
+				sumRight = _mm_add_ps(sumRight, _mm_mul_ps(_mm_loadu_ps(r + k), c));
+			}
+
+			//[L0+L2, R0+R2, L1+L3, R1+R3] -> [L, R]
+			__m128 sum = _mm_add_ps(_mm_unpacklo_ps(sumLeft, sumRight), _mm_unpackhi_ps(sumLeft, sumRight));
+			sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+			_mm_storel_pi((__m64*)(out + count * 2), sum);
+			pos += step;
+		}
+		position = pos;
+		return count;
+	}
+
+	CPU_TARGET_AVX2 uint32_t ConvolveAvx2(const FilterTable& filter, const float* left, const float* right, uint32_t inputSize, uint64_t& position, uint64_t step, float* out, uint32_t maxCount)
+	{
+		uint32_t taps = filter.Taps;
+		uint64_t pos = position;
+		uint32_t count = 0;
+		for(; count < maxCount && (pos >> 32) + taps <= inputSize; count++) {
+			float mu;
+			const float* c0 = GetCoefficients(filter, pos, mu);
+			const float* c1 = c0 + taps;
+			const float* l = left + (pos >> 32);
+			const float* r = right + (pos >> 32);
+
+			__m256 factor = _mm256_set1_ps(mu);
+			__m256 sumLeft = _mm256_setzero_ps();
+			__m256 sumRight = _mm256_setzero_ps();
+			for(uint32_t k = 0; k < taps; k += 8) {
+				__m256 a = _mm256_loadu_ps(c0 + k);
+				__m256 c = _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(c1 + k), a), factor));
+				sumLeft = _mm256_add_ps(sumLeft, _mm256_mul_ps(_mm256_loadu_ps(l + k), c));
+				sumRight = _mm256_add_ps(sumRight, _mm256_mul_ps(_mm256_loadu_ps(r + k), c));
+			}
+
+			__m128 sumL = _mm_add_ps(_mm256_castps256_ps128(sumLeft), _mm256_extractf128_ps(sumLeft, 1));
+			__m128 sumR = _mm_add_ps(_mm256_castps256_ps128(sumRight), _mm256_extractf128_ps(sumRight, 1));
+			__m128 sum = _mm_add_ps(_mm_unpacklo_ps(sumL, sumR), _mm_unpackhi_ps(sumL, sumR));
+			sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+			_mm_storel_pi((__m64*)(out + count * 2), sum);
+			pos += step;
+		}
+		position = pos;
+		return count;
+	}
+#endif
+
+	CpuDispatch<uint32_t(*)(const FilterTable&, const float*, const float*, uint32_t, uint64_t&, uint64_t, float*, uint32_t)> Convolve({
+		{ CpuTier::Scalar, ConvolveScalar },
+#ifdef SINCRESAMPLER_SSE2
+		{ CpuTier::Sse2, ConvolveSse2 },
+		{ CpuTier::Avx2, ConvolveAvx2 },
+#endif
+	});
+}
+
+shared_ptr<SincResampler::FilterTable> SincResampler::GetFilterTable(Quality quality, uint32_t cutoff)
+{
+	static SimpleLock lock;
+	static std::unordered_map<uint32_t, shared_ptr<FilterTable>> tables;
+
+	auto lockHandler = lock.AcquireSafe();
+	uint32_t key = (uint32_t)quality * (CutoffSteps + 1) + cutoff;
+	auto result = tables.find(key);
+	if(result != tables.end()) {
+		return result->second;
+	}
+
+	QualitySettings settings = GetQualitySettings(quality);
+	shared_ptr<FilterTable> filter(new FilterTable());
+	filter->Taps = settings.Taps;
+	filter->Coefficients.resize((PhaseCount + 1) * settings.Taps);
+
+	//Windowed sinc, centered between the taps (Taps / 2 - 1) and (Taps / 2), offset by the phase
+	constexpr double PI = 3.14159265358979323846;
+	double fc = settings.Bandwidth * cutoff / CutoffSteps;
+	double halfWidth = settings.Taps / 2.0;
+	double windowScale = 1.0 / BesselI0(settings.KaiserBeta);
+	for(uint32_t phase = 0; phase <= PhaseCount; phase++) {
+		float* row = filter->Coefficients.data() + phase * settings.Taps;
+		double sum = 0;
+		for(uint32_t k = 0; k < settings.Taps; k++) {
+			double x = (double)k - (halfWidth - 1) - (double)phase / PhaseCount;
+			double sinc = x == 0 ? 1.0 : std::sin(PI * fc * x) / (PI * fc * x);
+			double w = std::max(0.0, 1.0 - (x / halfWidth) * (x / halfWidth));
+			double coefficient = sinc * BesselI0(settings.KaiserBeta * std::sqrt(w)) * windowScale;
+			row[k] = (float)coefficient;
+			sum += coefficient;
+		}
+
+		//Normalize each phase to a gain of 1 (DC)
+		for(uint32_t k = 0; k < settings.Taps; k++) {
+			row[k] = (float)(row[k] / sum);
+		}
+	}
+
+	tables[key] = filter;
+	return filter;
+}
+
+SincResampler::SincResampler(Quality quality)
+{
+	_quality = quality;
+	UpdateFilter(CutoffSteps);
+	Reset();
+}
+
+void SincResampler::UpdateFilter(uint32_t cutoff)
+{
+	if(!_filter || _cutoff != cutoff) {
+		_filter = GetFilterTable(_quality, cutoff);
+		_cutoff = cutoff;
+	}
+}
+
+void SincResampler::ClearInput()
+{
+	//Starts with enough silence for the first input sample to be at the center of the filter
+	_inputSize = _filter->Taps / 2 - 1;
+	if(_left.size() < _inputSize) {
+		_left.resize(_inputSize);
+		_right.resize(_inputSize);
+	}
+	std::fill(_left.begin(), _left.begin() + _inputSize, 0.0f);
+	std::fill(_right.begin(), _right.begin() + _inputSize, 0.0f);
+	_position = 0;
+}
+
+void SincResampler::Reset()
+{
+	ClearInput();
+	_lastLeft = 0;
+	_lastRight = 0;
+}
+
+void SincResampler::SetQuality(Quality quality)
+{
+	if(_quality != quality) {
+		_quality = quality;
+		_filter.reset();
+		UpdateFilter(_cutoff);
+		Reset();
+	}
+}
+
+void SincResampler::SetVolume(double volume)
+{
+	_volume = (float)volume;
+}
+
+void SincResampler::SetSampleRates(double srcRate, double dstRate)
+{
+	_step = (uint64_t)std::llround(srcRate / dstRate * 4294967296.0);
+
+	//When downsampling, the cutoff frequency is lowered to the output's nyquist frequency to avoid aliasing
+	uint32_t cutoff = (uint32_t)std::clamp<double>(std::floor(dstRate / srcRate * CutoffSteps), 1, CutoffSteps);
+	UpdateFilter(cutoff);
+}
+
+uint32_t SincResampler::GetPendingCount()
+{
+	if(_inputSize < _filter->Taps) {
+		return 0;
+	}
+
+	uint64_t end = (uint64_t)(_inputSize - _filter->Taps + 1) << 32;
+	return end > _position ? (uint32_t)((end - _position + _step - 1) / _step) : 0;
+}
+
+template<bool addMode>
+void SincResampler::WriteSamples(int16_t* out, const float* samples, uint32_t count)
+{
+	for(uint32_t i = 0; i < count * 2; i++) {
+		float sample = samples[i] * _volume;
+		if(addMode) {
+			sample += out[i];
+		}
+		out[i] = (int16_t)std::clamp(sample, -32768.0f, 32767.0f);
+	}
+}
+
+template<bool addMode>
+uint32_t SincResampler::Resample(int16_t* in, uint32_t inSampleCount, int16_t* out, size_t maxOutSampleCount, bool fillToMax)
+{
+	if(GetPendingCount() >= maxOutSampleCount) {
+		//The caller gives more samples than it consumes, drop the extra samples
+		uint32_t taps = _filter->Taps;
+		uint32_t historySize = std::min(_inputSize, taps - 1);
+		std::copy(_left.begin() + (_inputSize - historySize), _left.begin() + _inputSize, _left.begin());
+		std::copy(_right.begin() + (_inputSize - historySize), _right.begin() + _inputSize, _right.begin());
+		_inputSize = historySize;
+		_position &= 0xFFFFFFFF;
+	}
+
+	size_t requiredSize = _inputSize + inSampleCount;
+	if(_left.size() < requiredSize) {
+		_left.resize(requiredSize);
+		_right.resize(requiredSize);
+	}
+	for(uint32_t i = 0; i < inSampleCount; i++) {
+		_left[_inputSize + i] = in[i * 2];
+		_right[_inputSize + i] = in[i * 2 + 1];
+	}
+	_inputSize += inSampleCount;
+
+	uint32_t outPos = 0;
+	while(outPos < maxOutSampleCount) {
+		uint32_t maxCount = (uint32_t)std::min<size_t>(maxOutSampleCount - outPos, BlockSize);
+		uint32_t count = Convolve(*_filter, _left.data(), _right.data(), _inputSize, _position, _step, _output, maxCount);
+		if(count == 0) {
+			break;
+		}
+		WriteSamples<addMode>(out + outPos * 2, _output, count);
+		_lastLeft = _output[count * 2 - 2];
+		_lastRight = _output[count * 2 - 1];
+		outPos += count;
+	}
+
+	//Remove the input samples that are no longer needed
+	uint32_t consumed = (uint32_t)std::min<uint64_t>(_position >> 32, _inputSize);
+	if(consumed > 0) {
+		std::copy(_left.begin() + consumed, _left.begin() + _inputSize, _left.begin());
+		std::copy(_right.begin() + consumed, _right.begin() + _inputSize, _right.begin());
+		_inputSize -= consumed;
+		_position -= (uint64_t)consumed << 32;
+	}
+
+	if(fillToMax) {
+		float last[2] = { _lastLeft, _lastRight };
+		for(; outPos < maxOutSampleCount; outPos++) {
+			WriteSamples<addMode>(out + outPos * 2, last, 1);
+		}
+	}
+
+	return outPos;
+}
+
+template uint32_t SincResampler::Resample<true>(int16_t* in, uint32_t inSampleCount, int16_t* out, size_t maxOutSampleCount, bool fillToMax);
+template uint32_t SincResampler::Resample<false>(int16_t* in, uint32_t inSampleCount, int16_t* out, size_t maxOutSampleCount, bool fillToMax);
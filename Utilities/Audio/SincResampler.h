@@ -0,0 +1,71 @@
+#pragma once
+#include "pch.h"
+
+//Polyphase windowed-sinc resampler for stereo samples (higher quality alternative to HermiteResampler, same interface)
+//The filter's coefficients are calculated once for PhaseCount phases (and linearly interpolated between 2 phases), and
+//are shared by all instances. The position in the input is tracked in 32.32 fixed point, so the rate ratio can be
+//adjusted continuously (dynamic rate control) without accumulating errors.
+class SincResampler
+{
+public:
+	enum class Quality
+	{
+		Low,    //8 taps
+		Medium, //16 taps
+		High    //32 taps
+	};
+
+	static constexpr uint32_t PhaseBits = 8;
+	static constexpr uint32_t PhaseCount = 1 << PhaseBits;
+
+	struct FilterTable
+	{
+		uint32_t Taps;
+
+		//PhaseCount + 1 rows of Taps coefficients (the last row is the first phase of the next sample)
+		vector<float> Coefficients;
+	};
+
+private:
+	static constexpr uint32_t BlockSize = 256;
+
+	Quality _quality = Quality::Medium;
+	shared_ptr<FilterTable> _filter;
+	uint32_t _cutoff = 0;
+
+	//Input samples that are still needed, starting with the filter's history
+	vector<float> _left;
+	vector<float> _right;
+	uint32_t _inputSize = 0;
+
+	//Position of the next output sample in the input (32.32 fixed point), and distance between 2 output samples
+	uint64_t _position = 0;
+	uint64_t _step = 1ULL << 32;
+
+	float _volume = 1.0f;
+	float _lastLeft = 0;
+	float _lastRight = 0;
+
+	float _output[BlockSize * 2];
+
+	static shared_ptr<FilterTable> GetFilterTable(Quality quality, uint32_t cutoff);
+
+	void UpdateFilter(uint32_t cutoff);
+	void ClearInput();
+
+	template<bool addMode>
+	void WriteSamples(int16_t* out, const float* samples, uint32_t count);
+
+public:
+	SincResampler(Quality quality = Quality::Medium);
+
+	void Reset();
+
+	void SetQuality(Quality quality);
+	void SetVolume(double volume);
+	void SetSampleRates(double srcRate, double dstRate);
+	uint32_t GetPendingCount();
+
+	template<bool addMode>
+	uint32_t Resample(int16_t* in, uint32_t inSampleCount, int16_t* out, size_t maxOutSampleCount, bool fillToMax = false);
+};
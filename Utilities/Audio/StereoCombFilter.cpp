@@ -1,29 +1,35 @@
 #include "pch.h"
 #include "StereoCombFilter.h"
+#include "AudioConverter.h"
 
 void StereoCombFilter::ApplyFilter(int16_t * stereoBuffer, size_t sampleCount, uint32_t sampleRate, int32_t delay, uint32_t strength)
 {
-	size_t delaySampleCount = (int32_t)((double)delay / 1000 * sampleRate);
-	if(delaySampleCount != _lastDelay) {
-		_delayedSamplesLeft.clear();
-		_delayedSamplesRight.clear();
-		for(size_t i = 0; i < delaySampleCount; i++) {
-			_delayedSamplesLeft.push_back(0);
-			_delayedSamplesRight.push_back(0);
-		}
-	}
-	_lastDelay = delaySampleCount;
+	AudioConverter::ProcessInterleaved(stereoBuffer, sampleCount, [&](float* left, float* right, uint32_t count) {
+		ApplyFilter(left, right, count, sampleRate, delay, strength);
+	});
+}
+
+void StereoCombFilter::ApplyFilter(float* left, float* right, uint32_t sampleCount, uint32_t sampleRate, int32_t delay, uint32_t strength)
+{
+	uint32_t delaySampleCount = (uint32_t)((double)delay / 1000 * sampleRate);
+	_delayedSamples.SetMaxDelay(delaySampleCount);
+
+	float ratio = strength / 100.0f;
+	for(uint32_t i = 0; i < sampleCount; i += DelayLine::MaxBlockSize) {
+		uint32_t count = std::min(sampleCount - i, DelayLine::MaxBlockSize);
 
-	double ratio = strength == 0 ? 0 : strength / 100.0;
-	for(size_t i = 0; i < sampleCount * 2; i += 2) {
-		_delayedSamplesLeft.push_back(stereoBuffer[i]);
-		_delayedSamplesRight.push_back(stereoBuffer[i + 1]);
+		//Left = mono mix, right = delayed mono mix
+		for(uint32_t j = i; j < i + count; j++) {
+			left[j] = (left[j] + right[j]) / 2;
+		}
+		_delayedSamples.Write(left + i, count);
+		_delayedSamples.Read(right + i, count, delaySampleCount + count);
 
-		int16_t delayedSample = (_delayedSamplesRight.front() + _delayedSamplesLeft.front()) / 2;
-		int16_t monoSample = (stereoBuffer[i] + stereoBuffer[i + 1]) / 2;
-		stereoBuffer[i] = monoSample + (int16_t)(delayedSample * ratio);
-		stereoBuffer[i + 1] = monoSample - (int16_t)(delayedSample * ratio);
-		_delayedSamplesLeft.pop_front();
-		_delayedSamplesRight.pop_front();
+		for(uint32_t j = i; j < i + count; j++) {
+			float monoSample = left[j];
+			float delayedSample = right[j] * ratio;
+			left[j] = monoSample + delayedSample;
+			right[j] = monoSample - delayedSample;
+		}
 	}
 }
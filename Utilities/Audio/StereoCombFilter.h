@@ -1,13 +1,13 @@
 #pragma once
 #include "pch.h"
-#include <deque>
+#include "DelayLine.h"
 
 class StereoCombFilter
 {
-	std::deque<int16_t> _delayedSamplesLeft;
-	std::deque<int16_t> _delayedSamplesRight;
-	size_t _lastDelay = 0;
+	//Mono mix of the input
+	DelayLine _delayedSamples;
 
 public:
 	void ApplyFilter(int16_t* stereoBuffer, size_t sampleCount, uint32_t sampleRate, int32_t delay, uint32_t strength);
+	void ApplyFilter(float* left, float* right, uint32_t sampleCount, uint32_t sampleRate, int32_t delay, uint32_t strength);
 };
\ No newline at end of file
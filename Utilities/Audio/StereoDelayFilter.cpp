@@ -1,29 +1,28 @@
 #include "pch.h"
 #include <algorithm>
 #include "StereoDelayFilter.h"
+#include "AudioConverter.h"
 
 void StereoDelayFilter::ApplyFilter(int16_t* stereoBuffer, size_t sampleCount, uint32_t sampleRate, int32_t stereoDelay)
 {
-	size_t delaySampleCount = (int32_t)((double)stereoDelay / 1000 * sampleRate);
-	if(delaySampleCount != _lastDelay) {
-		_delayedSamplesLeft.clear();
-		_delayedSamplesRight.clear();
-	}
-	_lastDelay = delaySampleCount;
-	
-	for(size_t i = 0; i < sampleCount * 2; i+=2) {
-		_delayedSamplesLeft.push_back(stereoBuffer[i]);
-		_delayedSamplesRight.push_back(stereoBuffer[i+1]);
-	}
+	AudioConverter::ProcessInterleaved(stereoBuffer, sampleCount, [&](float* left, float* right, uint32_t count) {
+		ApplyFilter(left, right, count, sampleRate, stereoDelay);
+	});
+}
+
+void StereoDelayFilter::ApplyFilter(float* left, float* right, uint32_t sampleCount, uint32_t sampleRate, int32_t stereoDelay)
+{
+	uint32_t delaySampleCount = (uint32_t)((double)stereoDelay / 1000 * sampleRate);
+	_delayedSamples.SetMaxDelay(delaySampleCount);
 
-	if(_delayedSamplesLeft.size() > delaySampleCount) {
-		size_t samplesToInsert = std::max<size_t>(_delayedSamplesLeft.size() - delaySampleCount, sampleCount);
+	for(uint32_t i = 0; i < sampleCount; i += DelayLine::MaxBlockSize) {
+		uint32_t count = std::min(sampleCount - i, DelayLine::MaxBlockSize);
 
-		for(size_t i = sampleCount - samplesToInsert; i < sampleCount; i++) {
-			stereoBuffer[i*2] = (stereoBuffer[i*2] + stereoBuffer[i*2+1]) / 2;
-			stereoBuffer[i*2+1] = (_delayedSamplesRight.front() + _delayedSamplesLeft.front()) / 2;
-			_delayedSamplesLeft.pop_front();
-			_delayedSamplesRight.pop_front();
+		//Left channel plays the mono mix, right channel plays it after the delay
+		for(uint32_t j = i; j < i + count; j++) {
+			left[j] = (left[j] + right[j]) / 2;
 		}
+		_delayedSamples.Write(left + i, count);
+		_delayedSamples.Read(right + i, count, delaySampleCount + count);
 	}
 }
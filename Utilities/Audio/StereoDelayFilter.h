@@ -1,14 +1,14 @@
 #pragma once
 #include "pch.h"
-#include <deque>
+#include "DelayLine.h"
 
 class StereoDelayFilter
 {
 private:
-	std::deque<int16_t> _delayedSamplesLeft;
-	std::deque<int16_t> _delayedSamplesRight;
-	size_t _lastDelay = 0;
+	//Mono mix of the input
+	DelayLine _delayedSamples;
 	
 public:
 	void ApplyFilter(int16_t* stereoBuffer, size_t sampleCount, uint32_t sampleRate, int32_t stereoDelay);
+	void ApplyFilter(float* left, float* right, uint32_t sampleCount, uint32_t sampleRate, int32_t stereoDelay);
 };
\ No newline at end of file
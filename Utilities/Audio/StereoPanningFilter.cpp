@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "StereoPanningFilter.h"
+#include "AudioConverter.h"
 #include <cmath>
 
 void StereoPanningFilter::UpdateFactors(double angle)
@@ -9,15 +10,24 @@ void StereoPanningFilter::UpdateFactors(double angle)
 }
 
 void StereoPanningFilter::ApplyFilter(int16_t* stereoBuffer, size_t sampleCount, uint32_t angle)
+{
+	AudioConverter::ProcessInterleaved(stereoBuffer, sampleCount, [&](float* left, float* right, uint32_t count) {
+		ApplyFilter(left, right, count, angle);
+	});
+}
+
+void StereoPanningFilter::ApplyFilter(float* left, float* right, uint32_t sampleCount, uint32_t angle)
 {
 	constexpr double PI = 3.14159265358979323846;
 	angle = (uint32_t)(angle / 180.0 * PI);
 	UpdateFactors(angle);
 
-	for(size_t i = 0; i < sampleCount * 2; i+=2) {
-		int16_t leftSample = stereoBuffer[i];
-		int16_t rightSample = stereoBuffer[i+1];
-		stereoBuffer[i] = (int16_t)((_leftChannelFactor * leftSample + _leftChannelFactor * rightSample) / 2);
-		stereoBuffer[i+1] = (int16_t)((_rightChannelFactor * rightSample + _rightChannelFactor * leftSample) / 2);
+	float leftFactor = (float)_leftChannelFactor;
+	float rightFactor = (float)_rightChannelFactor;
+	for(uint32_t i = 0; i < sampleCount; i++) {
+		float leftSample = left[i];
+		float rightSample = right[i];
+		left[i] = (leftFactor * leftSample + leftFactor * rightSample) / 2;
+		right[i] = (rightFactor * rightSample + rightFactor * leftSample) / 2;
 	}
 }
\ No newline at end of file
@@ -12,4 +12,5 @@ private:
 
 public:
 	void ApplyFilter(int16_t* stereoBuffer, size_t sampleCount, uint32_t angle);
+	void ApplyFilter(float* left, float* right, uint32_t sampleCount, uint32_t angle);
 };
\ No newline at end of file
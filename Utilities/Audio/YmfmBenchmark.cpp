@@ -0,0 +1,309 @@
+#include "pch.h"
+#include <random>
+#include "Utilities/Audio/YmfmBenchmark.h"
+#include "Utilities/Audio/ymfm/ymfm_opn.h"
+#include "Utilities/Timer.h"
+
+namespace
+{
+	constexpr uint32_t ClocksPerSample = 144; //OPN2 (6 channels * 4 operators * 6 clocks)
+
+	//Calls the engine's timer callbacks (needed for CSM mode) - the timers are checked between calls to generate()
+	class TimerInterface : public ymfm::ymfm_interface
+	{
+	private:
+		int32_t _timers[2] = { -1, -1 }; //clocks left, -1 = stopped
+
+	public:
+		void ymfm_set_timer(uint32_t tnum, int32_t duration) override
+		{
+			_timers[tnum] = duration;
+		}
+
+		void Advance(int32_t clocks)
+		{
+			for(uint32_t i = 0; i < 2; i++) {
+				if(_timers[i] >= 0) {
+					_timers[i] -= clocks;
+					if(_timers[i] < 0) {
+						_timers[i] = -1;
+						m_engine->engine_timer_expired(i);
+					}
+				}
+			}
+		}
+	};
+
+	//The generate() functions as they were before block generation: the engine is clocked, then its output read, for each sample
+	class Ym2612Reference : public ymfm::ym2612
+	{
+	public:
+		Ym2612Reference(ymfm::ymfm_interface& intf) : ym2612(intf) {}
+
+		void generate(output_data* output, uint32_t numsamples)
+		{
+			for(uint32_t samp = 0; samp < numsamples; samp++, output++) {
+				m_fm.clock(fm_engine::ALL_CHANNELS);
+
+				output->clear();
+				output_data temp;
+				int const lastFmChannel = m_dac_enable ? 5 : 6;
+				for(int chan = 0; chan < lastFmChannel; chan++) {
+					m_fm.output(temp.clear(), 5, 256, 1 << chan);
+					output->data[0] += dac_discontinuity(temp.data[0]);
+					output->data[1] += dac_discontinuity(temp.data[1]);
+				}
+
+				if(m_dac_enable) {
+					int32_t dacval = dac_discontinuity(int16_t(m_dac_data << 7) >> 7);
+					output->data[0] += m_fm.regs().ch_output_0(0x102) ? dacval : dac_discontinuity(0);
+					output->data[1] += m_fm.regs().ch_output_1(0x102) ? dacval : dac_discontinuity(0);
+				}
+
+				output->data[0] = (output->data[0] * 128) * 64 / (6 * 65);
+				output->data[1] = (output->data[1] * 128) * 64 / (6 * 65);
+			}
+		}
+	};
+
+	class Ym3438Reference : public ymfm::ym3438
+	{
+	public:
+		Ym3438Reference(ymfm::ymfm_interface& intf) : ym3438(intf) {}
+
+		void generate(output_data* output, uint32_t numsamples)
+		{
+			for(uint32_t samp = 0; samp < numsamples; samp++, output++) {
+				m_fm.clock(fm_engine::ALL_CHANNELS);
+
+				if(!m_dac_enable) {
+					m_fm.output(output->clear(), 5, 256, fm_engine::ALL_CHANNELS);
+				} else {
+					int32_t dacval = int16_t(m_dac_data << 7) >> 7;
+					output->data[0] = m_fm.regs().ch_output_0(0x102) ? dacval : 0;
+					output->data[1] = m_fm.regs().ch_output_1(0x102) ? dacval : 0;
+					m_fm.output(*output, 5, 256, fm_engine::ALL_CHANNELS ^ (1 << 5));
+				}
+
+				output->data[0] = (output->data[0] * 128) / 6;
+				output->data[1] = (output->data[1] * 128) / 6;
+			}
+		}
+	};
+
+	class Ymf276Reference : public ymfm::ymf276
+	{
+	public:
+		Ymf276Reference(ymfm::ymfm_interface& intf) : ymf276(intf) {}
+
+		void generate(output_data* output, uint32_t numsamples)
+		{
+			for(uint32_t samp = 0; samp < numsamples; samp++, output++) {
+				m_fm.clock(fm_engine::ALL_CHANNELS);
+
+				if(!m_dac_enable) {
+					m_fm.output(output->clear(), 0, 8191, fm_engine::ALL_CHANNELS);
+				} else {
+					int32_t dacval = int16_t(m_dac_data << 7) >> 7;
+					output->data[0] = m_fm.regs().ch_output_0(0x102) ? dacval : 0;
+					output->data[1] = m_fm.regs().ch_output_1(0x102) ? dacval : 0;
+					m_fm.output(*output, 0, 8191, fm_engine::ALL_CHANNELS ^ (1 << 5));
+				}
+
+				output->data[0] = ymfm::clamp(output->data[0] >> 1, -32768, 32767);
+				output->data[1] = ymfm::clamp(output->data[1] >> 1, -32768, 32767);
+			}
+		}
+	};
+
+	template<typename WriteFunc>
+	void WriteRandomRegisters(std::mt19937& rng, WriteFunc write)
+	{
+		uint32_t writeCount = rng() % 12;
+		for(uint32_t i = 0; i < writeCount; i++) {
+			uint32_t port = rng() & 1;
+			uint32_t ch = rng() % 3;
+			uint32_t op = rng() % 4;
+			switch(rng() % 14) {
+				case 0: write(port, 0xB0 + ch, rng() & 0x3F); break; //feedback/algorithm
+				case 1: write(port, 0xB4 + ch, rng()); break; //panning/LFO sensitivity
+				case 2: write(port, 0xA4 + ch, rng() & 0x3F); write(port, 0xA0 + ch, rng()); break; //frequency
+				case 3: write(port, 0x30 + op * 4 + ch, rng()); break; //detune/multiple
+				case 4: write(port, 0x40 + op * 4 + ch, rng() % 3 ? rng() & 0x3F : rng() & 0x7F); break; //total level
+				case 5: write(port, 0x50 + op * 4 + ch, rng() | 0x10); break; //key scale/attack rate
+				case 6: write(port, 0x60 + op * 4 + ch, rng()); break; //AM/decay rate
+				case 7: write(port, 0x70 + op * 4 + ch, rng() & 0x1F); break; //sustain rate
+				case 8: write(port, 0x80 + op * 4 + ch, rng()); break; //sustain level/release rate
+				case 9: write(port, 0x90 + op * 4 + ch, rng() % 3 ? 0 : rng() & 0xF); break; //SSG-EG
+				case 10: write(0, 0x22, rng() & 0xF); break; //LFO
+				case 11: case 12: write(0, 0x28, (rng() & 0xF0) | (port ? 4 : 0) | ch); break; //key on/off
+				case 13:
+					//DAC, timers and CSM mode
+					if(rng() % 4 == 0) {
+						write(0, 0x2B, rng() & 0x80);
+					}
+					write(0, 0x2A, rng());
+					if(rng() % 8 == 0) {
+						write(0, 0x24, rng());
+						write(0, 0x25, rng() & 0x03);
+						write(0, 0x27, (rng() & 0xC0) | 0x15);
+					}
+					break;
+			}
+		}
+	}
+
+	template<typename Chip, typename Reference>
+	int64_t Compare(uint32_t seed, uint64_t& sampleCount)
+	{
+		TimerInterface intf;
+		TimerInterface referenceIntf;
+		Chip chip(intf);
+		Reference reference(referenceIntf);
+		chip.reset();
+		reference.reset();
+
+		std::mt19937 rng(seed);
+		auto write = [&](uint32_t port, uint8_t reg, uint8_t value) {
+			chip.write(port * 2, reg);
+			chip.write(port * 2 + 1, value);
+			reference.write(port * 2, reg);
+			reference.write(port * 2 + 1, value);
+		};
+
+		typename Chip::output_data output[300];
+		typename Chip::output_data referenceOutput[300];
+		sampleCount = 0;
+		for(uint32_t i = 0; i < 1000; i++) {
+			WriteRandomRegisters(rng, write);
+
+			//Random lengths, so the blocks start at different points in the envelope/LFO cycles
+			uint32_t count = 1 + rng() % 300;
+			chip.generate(output, count);
+			reference.generate(referenceOutput, count);
+			intf.Advance(count * ClocksPerSample);
+			referenceIntf.Advance(count * ClocksPerSample);
+
+			for(uint32_t j = 0; j < count; j++) {
+				if(output[j].data[0] != referenceOutput[j].data[0] || output[j].data[1] != referenceOutput[j].data[1]) {
+					return (int64_t)(sampleCount + j);
+				}
+			}
+			sampleCount += count;
+		}
+		return -1;
+	}
+
+	template<typename Chip>
+	double GetSamplesPerSecond(uint32_t sampleCount)
+	{
+		TimerInterface intf;
+		Chip chip(intf);
+		chip.reset();
+
+		auto write = [&](uint32_t port, uint8_t reg, uint8_t value) {
+			chip.write(port * 2, reg);
+			chip.write(port * 2 + 1, value);
+		};
+
+		//6 channels playing different notes, with LFO
+		for(uint32_t port = 0; port < 2; port++) {
+			for(uint32_t ch = 0; ch < 3; ch++) {
+				write(port, 0xB0 + ch, ch * 2 + 1 + (ch << 3));
+				write(port, 0xB4 + ch, 0xD1);
+				write(port, 0xA4 + ch, 0x22);
+				write(port, 0xA0 + ch, 0x69 + ch * 10);
+				for(uint32_t op = 0; op < 4; op++) {
+					write(port, 0x30 + op * 4 + ch, 0x71);
+					write(port, 0x40 + op * 4 + ch, 0x10 + op * 4);
+					write(port, 0x50 + op * 4 + ch, 0x1F);
+					write(port, 0x60 + op * 4 + ch, 0x05);
+					write(port, 0x70 + op * 4 + ch, 0x02);
+					write(port, 0x80 + op * 4 + ch, 0x11);
+				}
+			}
+		}
+		write(0, 0x22, 0x08);
+		for(uint32_t ch = 0; ch < 6; ch++) {
+			write(0, 0x28, 0xF0 | (ch < 3 ? ch : ch + 1));
+		}
+
+		typename Chip::output_data output[800];
+		double best = 0;
+		for(int run = 0; run < 5; run++) {
+			Timer timer;
+			for(uint32_t i = 0; i < sampleCount; i += 800) {
+				chip.generate(output, std::min<uint32_t>(800, sampleCount - i));
+			}
+			double time = timer.GetElapsedMS();
+			if(time > 0) {
+				best = std::max(best, sampleCount / time * 1000);
+			}
+		}
+		return best;
+	}
+
+	vector<CpuTier> GetTiers()
+	{
+		vector<CpuTier> tiers;
+		for(CpuTier tier : { CpuTier::Scalar, CpuTier::Sse2, CpuTier::Ssse3, CpuTier::Avx2, CpuTier::Avx512, CpuTier::Neon }) {
+			if(CpuFeatures::IsSupported(tier)) {
+				tiers.push_back(tier);
+			}
+		}
+		return tiers;
+	}
+}
+
+vector<YmfmBenchmark::CompareResult> YmfmBenchmark::CompareBlockOutput(uint32_t seedCount)
+{
+	vector<CompareResult> results;
+	for(CpuTier tier : GetTiers()) {
+		CpuFeatures::SetMaxTier(tier);
+		for(uint32_t seed = 1; seed <= seedCount; seed++) {
+			uint64_t sampleCount = 0;
+			int64_t mismatch = Compare<ymfm::ym2612, Ym2612Reference>(seed, sampleCount);
+			results.push_back({ "YM2612", tier, seed, sampleCount, mismatch });
+			mismatch = Compare<ymfm::ym3438, Ym3438Reference>(seed, sampleCount);
+			results.push_back({ "YM3438", tier, seed, sampleCount, mismatch });
+			mismatch = Compare<ymfm::ymf276, Ymf276Reference>(seed, sampleCount);
+			results.push_back({ "YMF276", tier, seed, sampleCount, mismatch });
+		}
+	}
+	CpuFeatures::ResetMaxTier();
+	return results;
+}
+
+vector<YmfmBenchmark::SpeedResult> YmfmBenchmark::Run(uint32_t sampleCount)
+{
+	vector<SpeedResult> results;
+	for(CpuTier tier : GetTiers()) {
+		CpuFeatures::SetMaxTier(tier);
+		results.push_back({ "YM2612", tier, GetSamplesPerSecond<ymfm::ym2612>(sampleCount), GetSamplesPerSecond<Ym2612Reference>(sampleCount) });
+		results.push_back({ "YM3438", tier, GetSamplesPerSecond<ymfm::ym3438>(sampleCount), GetSamplesPerSecond<Ym3438Reference>(sampleCount) });
+		results.push_back({ "YMF276", tier, GetSamplesPerSecond<ymfm::ymf276>(sampleCount), GetSamplesPerSecond<Ymf276Reference>(sampleCount) });
+	}
+	CpuFeatures::ResetMaxTier();
+	return results;
+}
+
+string YmfmBenchmark::GetReport(const vector<CompareResult>& compareResults, const vector<SpeedResult>& speedResults)
+{
+	char line[200];
+	string report = "Chip    Tier    Seed  Samples   Result\n";
+	for(const CompareResult& r : compareResults) {
+		if(r.FirstMismatch < 0) {
+			snprintf(line, sizeof(line), "%-7s %-7s %4u %8llu   OK\n", r.Chip.c_str(), CpuFeatures::GetTierName(r.Tier).c_str(), r.Seed, (unsigned long long)r.SampleCount);
+		} else {
+			snprintf(line, sizeof(line), "%-7s %-7s %4u %8llu   MISMATCH at sample %lld\n", r.Chip.c_str(), CpuFeatures::GetTierName(r.Tier).c_str(), r.Seed, (unsigned long long)r.SampleCount, (long long)r.FirstMismatch);
+		}
+		report += line;
+	}
+
+	report += "\nChip    Tier    Block (samples/s)  Per-sample (samples/s)\n";
+	for(const SpeedResult& r : speedResults) {
+		snprintf(line, sizeof(line), "%-7s %-7s %16.0f %23.0f\n", r.Chip.c_str(), CpuFeatures::GetTierName(r.Tier).c_str(), r.BlockSamplesPerSecond, r.ReferenceSamplesPerSecond);
+		report += line;
+	}
+	return report;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "pch.h"
+#include "Utilities/CpuFeatures.h"
+
+//Regression check and benchmark for ymfm's block generation (fm_engine_base::clock_block), used by the YM2612/YM3438/YMF276
+//CompareBlockOutput feeds the same randomized register writes (including SSG-EG, LFO, DAC, timers and CSM) to each chip and
+//to a reference copy that generates the samples one at a time with clock()/output(), like ymfm did before block generation,
+//and checks that the outputs are identical. This is done at each CPU tier, so both operator kernels (scalar/AVX2) are tested.
+//Run measures the number of samples per second each chip generates with 6 channels playing, with both versions.
+class YmfmBenchmark
+{
+public:
+	struct CompareResult
+	{
+		string Chip;
+		CpuTier Tier;
+		uint32_t Seed;
+		uint64_t SampleCount;
+		int64_t FirstMismatch; //index of the first sample that differs, -1 if the outputs are identical
+	};
+
+	struct SpeedResult
+	{
+		string Chip;
+		CpuTier Tier;
+		double BlockSamplesPerSecond;
+		double ReferenceSamplesPerSecond;
+	};
+
+	//Runs <seedCount> randomized register streams for each chip, at each supported tier
+	static vector<CompareResult> CompareBlockOutput(uint32_t seedCount = 20);
+
+	//Generates <sampleCount> samples per chip and version, at each supported tier (best of 5 runs)
+	static vector<SpeedResult> Run(uint32_t sampleCount = 200000);
+
+	static string GetReport(const vector<CompareResult>& compareResults, const vector<SpeedResult>& speedResults);
+};
@@ -7,6 +7,13 @@
 #include <limits.h>
 #include <string.h>
 #include <stdlib.h>
+#include "../CpuFeatures.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+	#include <immintrin.h>
+	#define BLIP_SSE2
+#endif
 
 /* Library Copyright (C) 2003-2009 Shay Green. This library is free software;
 you can redistribute it and/or modify it under the terms of the GNU Lesser
@@ -243,6 +250,53 @@ int blip_read_samples( blip_t* m, short out [], int count, int stereo )
 	return count;
 }
 
+int blip_read_samples_stereo( blip_t* left, blip_t* right, short out [], int count )
+{
+	assert( count >= 0 );
+	
+	if ( count > left->avail )
+		count = left->avail;
+	if ( count > right->avail )
+		count = right->avail;
+	
+	if ( count )
+	{
+		/* Each integrator depends on its previous (clamped) sample so it can't be
+		vectorized, but the 2 channels are independent and run in parallel */
+		buf_t const* in_left  = SAMPLES( left );
+		buf_t const* in_right = SAMPLES( right );
+		int sum_left  = left->integrator;
+		int sum_right = right->integrator;
+		int i;
+		for ( i = 0; i < count; i++ )
+		{
+			/* Eliminate fraction */
+			int s_left  = ARITH_SHIFT( sum_left, delta_bits );
+			int s_right = ARITH_SHIFT( sum_right, delta_bits );
+			
+			sum_left  += in_left [i];
+			sum_right += in_right [i];
+			
+			CLAMP( s_left );
+			CLAMP( s_right );
+			
+			out [i * 2]     = s_left;
+			out [i * 2 + 1] = s_right;
+			
+			/* High-pass filter */
+			sum_left  -= s_left << (delta_bits - bass_shift);
+			sum_right -= s_right << (delta_bits - bass_shift);
+		}
+		left->integrator  = sum_left;
+		right->integrator = sum_right;
+		
+		remove_samples( left, count );
+		remove_samples( right, count );
+	}
+	
+	return count;
+}
+
 /* Things that didn't help performance on x86:
 	__attribute__((aligned(128)))
 	#define short int
@@ -292,23 +346,29 @@ possibly-wider fixed_t. On 32-bit platforms, this is likely more efficient.
 And by having pre_shift 32, a 32-bit platform can easily do the shift by
 simply ignoring the low half. */
 
-void blip_add_delta( blip_t* m, unsigned time, int delta )
+/* Position, phase and interpolation factor of a delta */
+static inline buf_t* delta_params( blip_t* m, unsigned time, int* phase, int* interp )
 {
 	unsigned fixed = (unsigned) ((time * m->factor + m->offset) >> pre_shift);
 	buf_t* out = SAMPLES( m ) + m->avail + (fixed >> frac_bits);
 	
 	int const phase_shift = frac_bits - phase_bits;
-	int phase = fixed >> phase_shift & (phase_count - 1);
+	*phase = fixed >> phase_shift & (phase_count - 1);
+	*interp = fixed >> (phase_shift - delta_bits) & (delta_unit - 1);
+	
+	/* Fails if buffer size was exceeded */
+	assert( out <= &SAMPLES( m ) [m->size + end_frame_extra] );
+	return out;
+}
+
+static inline void add_step( buf_t* out, int phase, int interp, int delta )
+{
 	short const* in  = bl_step [phase];
 	short const* rev = bl_step [phase_count - phase];
 	
-	int interp = fixed >> (phase_shift - delta_bits) & (delta_unit - 1);
 	int delta2 = (delta * interp) >> delta_bits;
 	delta -= delta2;
 	
-	/* Fails if buffer size was exceeded */
-	assert( out <= &SAMPLES( m ) [m->size + end_frame_extra] );
-	
 	out [0] += in[0]*delta + in[half_width+0]*delta2;
 	out [1] += in[1]*delta + in[half_width+1]*delta2;
 	out [2] += in[2]*delta + in[half_width+2]*delta2;
@@ -329,6 +389,154 @@ void blip_add_delta( blip_t* m, unsigned time, int delta )
 	out [15] += in[0]*delta + in[0-half_width]*delta2;
 }
 
+#ifdef BLIP_SSE2
+/* Step kernel of each phase for the SIMD versions of add_step(): both halves are in
+output order and the next phase's kernel is interleaved, so that
+out [i] += k [phase] [i] [0] * delta + k [phase] [i] [1] * delta2 */
+struct blip_kernels_t
+{
+	short k [phase_count] [half_width * 2] [2];
+	
+	blip_kernels_t()
+	{
+		for ( int phase = 0; phase < phase_count; phase++ )
+		{
+			for ( int i = 0; i < half_width; i++ )
+			{
+				k [phase] [i] [0] = bl_step [phase] [i];
+				k [phase] [i] [1] = bl_step [phase + 1] [i];
+				k [phase] [half_width * 2 - 1 - i] [0] = bl_step [phase_count - phase] [i];
+				k [phase] [half_width * 2 - 1 - i] [1] = bl_step [phase_count - phase - 1] [i];
+			}
+		}
+	}
+};
+
+static blip_kernels_t const bl_kernels;
+
+/* Both parts of the delta are multiplied and summed by a single pmaddwd, which
+is only possible when they fit in 16 bits (if delta does, so does delta2) */
+static inline bool is_short_delta( int delta )
+{
+	return (short) delta == delta;
+}
+
+/* Packs delta and delta2 as 2 shorts, in the same order as the kernel pairs */
+static inline int delta_pair( int delta, int delta2 )
+{
+	return (int) (((unsigned) delta2 << 16) | ((unsigned) delta & 0xFFFF));
+}
+
+static inline void add_step_sse2( buf_t* out, int phase, int interp, int delta )
+{
+	if ( !is_short_delta( delta ) )
+	{
+		add_step( out, phase, interp, delta );
+		return;
+	}
+	
+	int delta2 = (delta * interp) >> delta_bits;
+	delta -= delta2;
+	
+	__m128i const* k = (__m128i const*) bl_kernels.k [phase];
+	__m128i d = _mm_set1_epi32( delta_pair( delta, delta2 ) );
+	for ( int i = 0; i < 4; i++ )
+	{
+		__m128i* o = (__m128i*) (out + i * 4);
+		_mm_storeu_si128( o, _mm_add_epi32( _mm_loadu_si128( o ), _mm_madd_epi16( _mm_loadu_si128( k + i ), d ) ) );
+	}
+}
+
+CPU_TARGET_AVX2 static inline void add_step_avx2( buf_t* out, int phase, int interp, int delta )
+{
+	int delta2 = (delta * interp) >> delta_bits;
+	delta -= delta2;
+	
+	__m256i const* k = (__m256i const*) bl_kernels.k [phase];
+	if ( is_short_delta( delta + delta2 ) )
+	{
+		__m256i d = _mm256_set1_epi32( delta_pair( delta, delta2 ) );
+		for ( int i = 0; i < 2; i++ )
+		{
+			__m256i* o = (__m256i*) (out + i * 8);
+			_mm256_storeu_si256( o, _mm256_add_epi32( _mm256_loadu_si256( o ), _mm256_madd_epi16( _mm256_loadu_si256( k + i ), d ) ) );
+		}
+	}
+	else
+	{
+		/* 32-bit multiplications (same wraparound as the scalar code) */
+		__m256i d  = _mm256_set1_epi32( delta );
+		__m256i d2 = _mm256_set1_epi32( delta2 );
+		for ( int i = 0; i < 2; i++ )
+		{
+			__m256i* o = (__m256i*) (out + i * 8);
+			__m256i pairs = _mm256_loadu_si256( k + i );
+			__m256i k0 = _mm256_srai_epi32( _mm256_slli_epi32( pairs, 16 ), 16 );
+			__m256i k1 = _mm256_srai_epi32( pairs, 16 );
+			__m256i sum = _mm256_add_epi32( _mm256_mullo_epi32( k0, d ), _mm256_mullo_epi32( k1, d2 ) );
+			_mm256_storeu_si256( o, _mm256_add_epi32( _mm256_loadu_si256( o ), sum ) );
+		}
+	}
+}
+#endif
+
+static void add_deltas_scalar( blip_t* m, blip_delta_t const deltas [], int count )
+{
+	for ( int i = 0; i < count; i++ )
+	{
+		int phase, interp;
+		buf_t* out = delta_params( m, deltas [i].time, &phase, &interp );
+		add_step( out, phase, interp, deltas [i].delta );
+	}
+}
+
+#ifdef BLIP_SSE2
+static void add_deltas_sse2( blip_t* m, blip_delta_t const deltas [], int count )
+{
+	for ( int i = 0; i < count; i++ )
+	{
+		int phase, interp;
+		buf_t* out = delta_params( m, deltas [i].time, &phase, &interp );
+		add_step_sse2( out, phase, interp, deltas [i].delta );
+	}
+}
+
+CPU_TARGET_AVX2 static void add_deltas_avx2( blip_t* m, blip_delta_t const deltas [], int count )
+{
+	for ( int i = 0; i < count; i++ )
+	{
+		int phase, interp;
+		buf_t* out = delta_params( m, deltas [i].time, &phase, &interp );
+		add_step_avx2( out, phase, interp, deltas [i].delta );
+	}
+}
+#endif
+
+static CpuDispatch<void(*)( blip_t*, blip_delta_t const [], int )> add_deltas({
+	{ CpuTier::Scalar, add_deltas_scalar },
+#ifdef BLIP_SSE2
+	{ CpuTier::Sse2, add_deltas_sse2 },
+	{ CpuTier::Avx2, add_deltas_avx2 },
+#endif
+});
+
+void blip_add_delta( blip_t* m, unsigned time, int delta )
+{
+	int phase, interp;
+	buf_t* out = delta_params( m, time, &phase, &interp );
+	
+	#ifdef BLIP_SSE2
+		add_step_sse2( out, phase, interp, delta );
+	#else
+		add_step( out, phase, interp, delta );
+	#endif
+}
+
+void blip_add_deltas( blip_t* m, blip_delta_t const deltas [], int count )
+{
+	add_deltas( m, deltas, count );
+}
+
 void blip_add_delta_fast( blip_t* m, unsigned time, int delta )
 {
 	unsigned fixed = (unsigned) ((time * m->factor + m->offset) >> pre_shift);
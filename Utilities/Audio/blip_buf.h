@@ -41,6 +41,17 @@ EXPORT void blip_clear( blip_t* );
 /** Adds positive/negative delta into buffer at specified clock time. */
 EXPORT void blip_add_delta( blip_t*, unsigned int clock_time, int delta );
 
+/** Clock time and amplitude change of a delta, for blip_add_deltas(). */
+typedef struct blip_delta_t
+{
+	unsigned int time;
+	int delta;
+} blip_delta_t;
+
+/** Adds 'count' deltas into buffer. Same result as calling blip_add_delta()
+for each of them, but faster. */
+EXPORT void blip_add_deltas( blip_t*, blip_delta_t const deltas [], int count );
+
 /** Same as blip_add_delta(), but uses faster, lower-quality synthesis. */
 void blip_add_delta_fast( blip_t*, unsigned int clock_time, int delta );
 
@@ -67,6 +78,11 @@ interleaving of two buffers into a stereo sample stream. Outputs 16-bit signed
 samples. Returns number of samples actually read.  */
 EXPORT int blip_read_samples( blip_t*, short out [], int count, int stereo );
 
+/** Same as calling blip_read_samples() in stereo mode for 'left' and then for
+'right' (with out+1), but faster. Reads at most the number of samples available
+in both buffers. */
+EXPORT int blip_read_samples_stereo( blip_t* left, blip_t* right, short out [], int count );
+
 /** Frees buffer. No effect if NULL is passed. */
 EXPORT void blip_delete( blip_t* );
 
@@ -205,6 +205,17 @@ public:
 	// return a reference to our registers
 	RegisterType &regs() const { return m_regs; }
 
+	// helpers for block rendering: the attenuation compute_volume() applies to
+	// the waveform (4.8 format), or 'quiet' if it would return 0; whether that
+	// attenuation can change on samples that don't clock the envelope; and the
+	// waveform itself
+	uint32_t block_attenuation(uint32_t am_offset, uint32_t quiet) const
+	{
+		return (m_env_attenuation > EG_QUIET) ? quiet : (envelope_attenuation(am_offset) << 2);
+	}
+	bool block_attenuation_varies() const { return m_regs.op_ssg_eg_enable(m_opoffs) || m_regs.op_lfo_am_enable(m_opoffs); }
+	uint16_t const *waveform() const { return m_cache.waveform; }
+
 	// simple getters for debugging
 	envelope_state debug_eg_state() const { return m_env_state; }
 	uint16_t debug_eg_attenuation() const { return m_env_attenuation; }
@@ -302,6 +313,23 @@ public:
 	// return a reference to our registers
 	RegisterType &regs() const { return m_regs; }
 
+	// helpers for block rendering: operator access, the feedback state
+	// (feedback[0], feedback[1], feedback input) and the decoded algorithm
+	fm_operator<RegisterType> *op(uint32_t index) const { return m_op[index]; }
+	void get_feedback(int16_t *feedback) const
+	{
+		feedback[0] = m_feedback[0];
+		feedback[1] = m_feedback[1];
+		feedback[2] = m_feedback_in;
+	}
+	void set_feedback(int16_t const *feedback)
+	{
+		m_feedback[0] = feedback[0];
+		m_feedback[1] = feedback[1];
+		m_feedback_in = feedback[2];
+	}
+	static uint32_t algorithm_ops(uint32_t algorithm);
+
 	// simple getters for debugging
 	fm_operator<RegisterType> *debug_operator(uint32_t index) const { return m_op[index]; }
 
@@ -336,6 +364,56 @@ private:
 };
 
 
+// ======================> fm_block
+
+// fm_block holds the state of up to 8 4-operator channels over a block of
+// samples, laid out as structure-of-arrays with one lane per channel, so that
+// the operators of all channels can be evaluated together; the state machines
+// (envelopes, phases, LFO) are clocked sample by sample first, then the
+// operators are computed for the whole block
+struct fm_block
+{
+	static constexpr uint32_t SAMPLES = 32;
+	static constexpr uint32_t LANES = 8;
+
+	// attenuation of an operator that outputs nothing; large enough that
+	// the volume is shifted down to 0
+	static constexpr uint32_t QUIET = 0x2000;
+
+	// per-sample state, captured while clocking
+	uint32_t phase[4][SAMPLES][LANES];       // 10-bit phase of each operator
+	uint32_t attenuation[4][SAMPLES][LANES]; // envelope attenuation (4.8), or QUIET
+	uint32_t active[SAMPLES];                // mask of channels producing output
+
+	// per-channel state, constant over the block; the input masks select
+	// which of O1/O2/O3 feed operators 2-4 and the final sum
+	int32_t feedback_shift[LANES];           // 10 - feedback (only used if enabled)
+	int32_t feedback_enable[LANES];          // ~0 if feedback is enabled
+	int32_t output_enable[LANES];            // ~0 if the channel goes to any output
+	int32_t op2_in1[LANES];
+	int32_t op3_in1[LANES], op3_in2[LANES];
+	int32_t op4_in1[LANES], op4_in2[LANES], op4_in3[LANES];
+	int32_t sum1[LANES], sum2[LANES], sum3[LANES];
+	int32_t feedback[3][LANES];              // feedback memory and input (updated)
+
+	// block parameters
+	uint32_t lanes;
+	uint32_t count;
+	uint32_t rshift;
+	int32_t clipmax;
+
+	// tables widened to 32 bits (for gathers)
+	uint16_t const *waveform_source;
+	int32_t waveform[fm_registers_base::WAVEFORM_LENGTH];
+	int32_t power[256];
+
+	// output of operator 1 (computed first, as it carries the feedback from
+	// sample to sample) and of each channel, before panning
+	int32_t op1[SAMPLES][LANES];
+	int32_t result[SAMPLES][LANES];
+};
+
+
 // ======================> fm_engine_base
 
 // fm_engine_base represents a set of operators and channels which together
@@ -375,6 +453,16 @@ public:
 	// compute sum of channel outputs
 	void output(output_data &output, uint32_t rshift, int32_t clipmax, uint32_t chanmask) const;
 
+	// number of samples clock_block() can generate per call
+	static constexpr uint32_t BLOCK_SIZE = fm_block::SAMPLES;
+
+	// generate up to BLOCK_SIZE samples at once; this is equivalent to calling
+	// clock(chanmask) followed by output(channel_output, rshift, clipmax, 1 << chnum)
+	// for each channel in outmask, for each sample; the per-channel outputs are
+	// retrieved with block_output() (channels not in outmask output 0)
+	void clock_block(uint32_t count, uint32_t chanmask, uint32_t outmask, uint32_t rshift, int32_t clipmax);
+	output_data const &block_output(uint32_t sample, uint32_t chnum) const { return m_block_output[sample][chnum]; }
+
 	// write to the OPN registers
 	void write(uint16_t regnum, uint8_t data);
 
@@ -438,6 +526,14 @@ protected:
 	// update the state of the given timer
 	void update_timer(uint32_t which, uint32_t enable, int32_t delta_clocks);
 
+	// true if clock_block() can evaluate the operators in SIMD-friendly lanes
+	bool block_lanes_supported() const
+	{
+		return CHANNELS <= fm_block::LANES && OPERATORS == CHANNELS * 4 && RegisterType::WAVEFORMS == 1 &&
+			!RegisterType::DYNAMIC_OPS && !RegisterType::MODULATOR_DELAY && !YMFM_DEBUG_LOG_WAVFILES &&
+			!m_regs.rhythm_enable() && !m_regs.noise_enable();
+	}
+
 	// internal state
 	ymfm_interface &m_intf;          // reference to the system interface
 	uint32_t m_env_counter;          // envelope counter; low 2 bits are sub-counter
@@ -453,6 +549,8 @@ protected:
 	RegisterType m_regs;             // register accessor
 	std::unique_ptr<fm_channel<RegisterType>> m_channel[CHANNELS]; // channel pointers
 	std::unique_ptr<fm_operator<RegisterType>> m_operator[OPERATORS]; // operator pointers
+	std::unique_ptr<fm_block> m_block; // block rendering state
+	output_data m_block_output[BLOCK_SIZE][CHANNELS]; // block rendering output
 #if (YMFM_DEBUG_LOG_WAVFILES)
 	mutable ymfm_wavfile<1> m_wavfile[CHANNELS]; // for debugging
 #endif
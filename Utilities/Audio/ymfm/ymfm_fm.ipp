@@ -28,6 +28,14 @@
 // OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include "../../CpuFeatures.h"
+
+// the AVX2 block renderer is built on x86-64 and selected at runtime
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <immintrin.h>
+	#define YMFM_AVX2
+#endif
+
 namespace ymfm
 {
 
@@ -903,6 +911,58 @@ printf(" -- ");
 }
 
 
+//-------------------------------------------------
+//  algorithm_ops - return the inputs and outputs
+//  of each operator for the given algorithm
+//-------------------------------------------------
+
+template<class RegisterType>
+uint32_t fm_channel<RegisterType>::algorithm_ops(uint32_t algorithm)
+{
+	// OPM/OPN offer 8 different connection algorithms for 4 operators,
+	// and OPL3 offers 4 more, which we designate here as 8-11.
+	//
+	// The operators are computed in order, with the inputs pulled from
+	// an array of values (opout) that is populated as we go:
+	//    0 = 0
+	//    1 = O1
+	//    2 = O2
+	//    3 = O3
+	//    4 = (O4)
+	//    5 = O1+O2
+	//    6 = O1+O3
+	//    7 = O2+O3
+	//
+	// The s_algorithm_ops table describes the inputs and outputs of each
+	// algorithm as follows:
+	//
+	//      ---------x use opout[x] as operator 2 input
+	//      ------xxx- use opout[x] as operator 3 input
+	//      ---xxx---- use opout[x] as operator 4 input
+	//      --x------- include opout[1] in final sum
+	//      -x-------- include opout[2] in final sum
+	//      x--------- include opout[3] in final sum
+	#define ALGORITHM(op2in, op3in, op4in, op1out, op2out, op3out) \
+		((op2in) | ((op3in) << 1) | ((op4in) << 4) | ((op1out) << 7) | ((op2out) << 8) | ((op3out) << 9))
+	static uint16_t const s_algorithm_ops[8+4] =
+	{
+		ALGORITHM(1,2,3, 0,0,0),    //  0: O1 -> O2 -> O3 -> O4 -> out (O4)
+		ALGORITHM(0,5,3, 0,0,0),    //  1: (O1 + O2) -> O3 -> O4 -> out (O4)
+		ALGORITHM(0,2,6, 0,0,0),    //  2: (O1 + (O2 -> O3)) -> O4 -> out (O4)
+		ALGORITHM(1,0,7, 0,0,0),    //  3: ((O1 -> O2) + O3) -> O4 -> out (O4)
+		ALGORITHM(1,0,3, 0,1,0),    //  4: ((O1 -> O2) + (O3 -> O4)) -> out (O2+O4)
+		ALGORITHM(1,1,1, 0,1,1),    //  5: ((O1 -> O2) + (O1 -> O3) + (O1 -> O4)) -> out (O2+O3+O4)
+		ALGORITHM(1,0,0, 0,1,1),    //  6: ((O1 -> O2) + O3 + O4) -> out (O2+O3+O4)
+		ALGORITHM(0,0,0, 1,1,1),    //  7: (O1 + O2 + O3 + O4) -> out (O1+O2+O3+O4)
+		ALGORITHM(1,2,3, 0,0,0),    //  8: O1 -> O2 -> O3 -> O4 -> out (O4)         [same as 0]
+		ALGORITHM(0,2,3, 1,0,0),    //  9: (O1 + (O2 -> O3 -> O4)) -> out (O1+O4)   [unique]
+		ALGORITHM(1,0,3, 0,1,0),    // 10: ((O1 -> O2) + (O3 -> O4)) -> out (O2+O4) [same as 4]
+		ALGORITHM(0,2,0, 1,0,1)     // 11: (O1 + (O2 -> O3) + O4) -> out (O1+O3+O4) [unique]
+	};
+	return s_algorithm_ops[algorithm];
+}
+
+
 //-------------------------------------------------
 //  output_2op - combine 4 operators according to
 //  the specified algorithm, returning a sum
@@ -991,47 +1051,8 @@ void fm_channel<RegisterType>::output_4op(output_data &output, uint32_t rshift,
 	if (m_regs.ch_output_any(m_choffs) == 0)
 		return;
 
-	// OPM/OPN offer 8 different connection algorithms for 4 operators,
-	// and OPL3 offers 4 more, which we designate here as 8-11.
-	//
-	// The operators are computed in order, with the inputs pulled from
-	// an array of values (opout) that is populated as we go:
-	//    0 = 0
-	//    1 = O1
-	//    2 = O2
-	//    3 = O3
-	//    4 = (O4)
-	//    5 = O1+O2
-	//    6 = O1+O3
-	//    7 = O2+O3
-	//
-	// The s_algorithm_ops table describes the inputs and outputs of each
-	// algorithm as follows:
-	//
-	//      ---------x use opout[x] as operator 2 input
-	//      ------xxx- use opout[x] as operator 3 input
-	//      ---xxx---- use opout[x] as operator 4 input
-	//      --x------- include opout[1] in final sum
-	//      -x-------- include opout[2] in final sum
-	//      x--------- include opout[3] in final sum
-	#define ALGORITHM(op2in, op3in, op4in, op1out, op2out, op3out) \
-		((op2in) | ((op3in) << 1) | ((op4in) << 4) | ((op1out) << 7) | ((op2out) << 8) | ((op3out) << 9))
-	static uint16_t const s_algorithm_ops[8+4] =
-	{
-		ALGORITHM(1,2,3, 0,0,0),    //  0: O1 -> O2 -> O3 -> O4 -> out (O4)
-		ALGORITHM(0,5,3, 0,0,0),    //  1: (O1 + O2) -> O3 -> O4 -> out (O4)
-		ALGORITHM(0,2,6, 0,0,0),    //  2: (O1 + (O2 -> O3)) -> O4 -> out (O4)
-		ALGORITHM(1,0,7, 0,0,0),    //  3: ((O1 -> O2) + O3) -> O4 -> out (O4)
-		ALGORITHM(1,0,3, 0,1,0),    //  4: ((O1 -> O2) + (O3 -> O4)) -> out (O2+O4)
-		ALGORITHM(1,1,1, 0,1,1),    //  5: ((O1 -> O2) + (O1 -> O3) + (O1 -> O4)) -> out (O2+O3+O4)
-		ALGORITHM(1,0,0, 0,1,1),    //  6: ((O1 -> O2) + O3 + O4) -> out (O2+O3+O4)
-		ALGORITHM(0,0,0, 1,1,1),    //  7: (O1 + O2 + O3 + O4) -> out (O1+O2+O3+O4)
-		ALGORITHM(1,2,3, 0,0,0),    //  8: O1 -> O2 -> O3 -> O4 -> out (O4)         [same as 0]
-		ALGORITHM(0,2,3, 1,0,0),    //  9: (O1 + (O2 -> O3 -> O4)) -> out (O1+O4)   [unique]
-		ALGORITHM(1,0,3, 0,1,0),    // 10: ((O1 -> O2) + (O3 -> O4)) -> out (O2+O4) [same as 4]
-		ALGORITHM(0,2,0, 1,0,1)     // 11: (O1 + (O2 -> O3) + O4) -> out (O1+O3+O4) [unique]
-	};
-	uint32_t algorithm_ops = s_algorithm_ops[m_regs.ch_algorithm(m_choffs)];
+	// decode the algorithm; see algorithm_ops() for the layout of opout
+	uint32_t algorithm_ops = fm_channel::algorithm_ops(m_regs.ch_algorithm(m_choffs));
 
 	// populate the opout table
 	int16_t opout[8];
@@ -1168,6 +1189,203 @@ void fm_channel<RegisterType>::output_rhythm_ch8(uint32_t phase_select, output_d
 
 
 
+//*********************************************************
+//  FM BLOCK RENDERING
+//*********************************************************
+
+//-------------------------------------------------
+//  block_volume - compute_volume() for one
+//  operator of a block
+//-------------------------------------------------
+
+inline int32_t block_volume(fm_block const &block, uint32_t opnum, uint32_t samp, uint32_t lane, int32_t opmod)
+{
+	uint32_t env_attenuation = block.attenuation[opnum][samp][lane];
+	if (env_attenuation == fm_block::QUIET)
+		return 0;
+
+	uint32_t sin_attenuation = block.waveform[(block.phase[opnum][samp][lane] + opmod) & (fm_registers_base::WAVEFORM_LENGTH - 1)];
+	int32_t result = attenuation_to_volume((sin_attenuation & 0x7fff) + env_attenuation);
+	return bitfield(sin_attenuation, 15) ? -result : result;
+}
+
+
+//-------------------------------------------------
+//  render_block_scalar - compute the output of
+//  each channel of a block, one lane at a time;
+//  this matches fm_channel::output_4op()
+//-------------------------------------------------
+
+inline void render_block_scalar(fm_block &block)
+{
+	// operator 1 has optional self-feedback, so it is computed sample by
+	// sample first; the channels are interleaved so that their feedback
+	// chains overlap, and only active channels update the feedback input
+	for (uint32_t samp = 0; samp < block.count; samp++)
+		for (uint32_t lane = 0; lane < block.lanes; lane++)
+		{
+			int32_t feedback0 = block.feedback[0][lane] = block.feedback[1][lane];
+			int32_t feedback1 = block.feedback[1][lane] = block.feedback[2][lane];
+			if (bitfield(block.active[samp], lane) != 0)
+			{
+				int32_t opmod = block.feedback_enable[lane] & ((feedback0 + feedback1) >> block.feedback_shift[lane]);
+				block.op1[samp][lane] = block.feedback[2][lane] = block_volume(block, 0, samp, lane, opmod);
+			}
+		}
+
+	// operators 2-4 take the sum of the selected outputs as input
+	int32_t clipmax = block.clipmax;
+	int32_t clipmin = -clipmax - 1;
+	uint32_t rshift = block.rshift;
+	for (uint32_t samp = 0; samp < block.count; samp++)
+		for (uint32_t lane = 0; lane < block.lanes; lane++)
+		{
+			block.result[samp][lane] = 0;
+			if (bitfield(block.active[samp], lane) == 0 || block.output_enable[lane] == 0)
+				continue;
+
+			int32_t op1 = block.op1[samp][lane];
+			int32_t op2 = block_volume(block, 1, samp, lane, (op1 & block.op2_in1[lane]) >> 1);
+			int32_t opmod = (op1 & block.op3_in1[lane]) + (op2 & block.op3_in2[lane]);
+			int32_t op3 = block_volume(block, 2, samp, lane, opmod >> 1);
+			opmod = (op1 & block.op4_in1[lane]) + (op2 & block.op4_in2[lane]) + (op3 & block.op4_in3[lane]);
+			int32_t result = block_volume(block, 3, samp, lane, opmod >> 1) >> rshift;
+
+			// optionally add OP1, OP2, OP3
+			if (block.sum1[lane] != 0)
+				result = clamp(result + (op1 >> rshift), clipmin, clipmax);
+			if (block.sum2[lane] != 0)
+				result = clamp(result + (op2 >> rshift), clipmin, clipmax);
+			if (block.sum3[lane] != 0)
+				result = clamp(result + (op3 >> rshift), clipmin, clipmax);
+			block.result[samp][lane] = result;
+		}
+}
+
+
+#ifdef YMFM_AVX2
+
+//-------------------------------------------------
+//  block_volume_avx2 - compute_volume() for one
+//  operator of all 8 lanes of a block
+//-------------------------------------------------
+
+CPU_TARGET_AVX2 inline __m256i block_volume_avx2(fm_block const &block, uint32_t opnum, uint32_t samp, __m256i opmod)
+{
+	__m256i phase = _mm256_loadu_si256((__m256i const *)block.phase[opnum][samp]);
+	__m256i env_attenuation = _mm256_loadu_si256((__m256i const *)block.attenuation[opnum][samp]);
+
+	// look up the waveform, then convert the 5.8 attenuation to a volume; the
+	// QUIET attenuation shifts the volume down to 0
+	__m256i index = _mm256_and_si256(_mm256_add_epi32(phase, opmod), _mm256_set1_epi32(fm_registers_base::WAVEFORM_LENGTH - 1));
+	__m256i sin_attenuation = _mm256_i32gather_epi32(block.waveform, index, 4);
+	__m256i attenuation = _mm256_add_epi32(_mm256_and_si256(sin_attenuation, _mm256_set1_epi32(0x7fff)), env_attenuation);
+	__m256i power = _mm256_i32gather_epi32(block.power, _mm256_and_si256(attenuation, _mm256_set1_epi32(0xff)), 4);
+	__m256i result = _mm256_srlv_epi32(power, _mm256_srli_epi32(attenuation, 8));
+
+	// negate if in the negative part of the sin wave
+	__m256i sign = _mm256_srai_epi32(_mm256_slli_epi32(sin_attenuation, 16), 31);
+	return _mm256_sub_epi32(_mm256_xor_si256(result, sign), sign);
+}
+
+
+//-------------------------------------------------
+//  block_clamp_add_avx2 - add an operator to the
+//  result in the lanes selected by the mask
+//-------------------------------------------------
+
+CPU_TARGET_AVX2 inline __m256i block_clamp_add_avx2(__m256i result, __m256i op, __m256i mask, __m128i rshift, __m256i clipmin, __m256i clipmax)
+{
+	__m256i sum = _mm256_add_epi32(result, _mm256_sra_epi32(op, rshift));
+	sum = _mm256_min_epi32(_mm256_max_epi32(sum, clipmin), clipmax);
+	return _mm256_blendv_epi8(result, sum, mask);
+}
+
+
+//-------------------------------------------------
+//  render_block_avx2 - compute the output of all
+//  channels of a block at once, one channel per
+//  32-bit lane
+//-------------------------------------------------
+
+CPU_TARGET_AVX2 inline void render_block_avx2(fm_block &block)
+{
+	__m256i lane_bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+
+	// operator 1 has optional self-feedback, so it is computed sample by
+	// sample first; only active channels update the feedback input
+	__m256i feedback_shift = _mm256_loadu_si256((__m256i const *)block.feedback_shift);
+	__m256i feedback_enable = _mm256_loadu_si256((__m256i const *)block.feedback_enable);
+	__m256i feedback0 = _mm256_loadu_si256((__m256i const *)block.feedback[0]);
+	__m256i feedback1 = _mm256_loadu_si256((__m256i const *)block.feedback[1]);
+	__m256i feedback_in = _mm256_loadu_si256((__m256i const *)block.feedback[2]);
+	for (uint32_t samp = 0; samp < block.count; samp++)
+	{
+		feedback0 = feedback1;
+		feedback1 = feedback_in;
+		__m256i active = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(block.active[samp]), lane_bits), lane_bits);
+		__m256i opmod = _mm256_and_si256(feedback_enable, _mm256_srav_epi32(_mm256_add_epi32(feedback0, feedback1), feedback_shift));
+		__m256i op1 = block_volume_avx2(block, 0, samp, opmod);
+		feedback_in = _mm256_blendv_epi8(feedback_in, op1, active);
+		_mm256_storeu_si256((__m256i *)block.op1[samp], op1);
+	}
+	_mm256_storeu_si256((__m256i *)block.feedback[0], feedback0);
+	_mm256_storeu_si256((__m256i *)block.feedback[1], feedback1);
+	_mm256_storeu_si256((__m256i *)block.feedback[2], feedback_in);
+
+	// operators 2-4 don't depend on other samples; interleave groups of
+	// samples so that the gathers of one sample overlap the others (the
+	// block has room for whole groups, the extra results are ignored)
+	constexpr uint32_t GROUP = 4;
+	static_assert(fm_block::SAMPLES % GROUP == 0, "Block size must be a multiple of the group size");
+	__m256i clipmax = _mm256_set1_epi32(block.clipmax);
+	__m256i clipmin = _mm256_set1_epi32(-block.clipmax - 1);
+	__m128i rshift = _mm_cvtsi32_si128(block.rshift);
+	__m256i output_enable = _mm256_loadu_si256((__m256i const *)block.output_enable);
+	__m256i op2_in1 = _mm256_loadu_si256((__m256i const *)block.op2_in1);
+	__m256i op3_in1 = _mm256_loadu_si256((__m256i const *)block.op3_in1);
+	__m256i op3_in2 = _mm256_loadu_si256((__m256i const *)block.op3_in2);
+	__m256i op4_in1 = _mm256_loadu_si256((__m256i const *)block.op4_in1);
+	__m256i op4_in2 = _mm256_loadu_si256((__m256i const *)block.op4_in2);
+	__m256i op4_in3 = _mm256_loadu_si256((__m256i const *)block.op4_in3);
+	__m256i sum1 = _mm256_loadu_si256((__m256i const *)block.sum1);
+	__m256i sum2 = _mm256_loadu_si256((__m256i const *)block.sum2);
+	__m256i sum3 = _mm256_loadu_si256((__m256i const *)block.sum3);
+	for (uint32_t base = 0; base < block.count; base += GROUP)
+	{
+		__m256i op1[GROUP], op2[GROUP], op3[GROUP], result[GROUP];
+		for (uint32_t index = 0; index < GROUP; index++)
+		{
+			op1[index] = _mm256_loadu_si256((__m256i const *)block.op1[base + index]);
+			__m256i opmod = _mm256_and_si256(op1[index], op2_in1);
+			op2[index] = block_volume_avx2(block, 1, base + index, _mm256_srai_epi32(opmod, 1));
+		}
+		for (uint32_t index = 0; index < GROUP; index++)
+		{
+			__m256i opmod = _mm256_add_epi32(_mm256_and_si256(op1[index], op3_in1), _mm256_and_si256(op2[index], op3_in2));
+			op3[index] = block_volume_avx2(block, 2, base + index, _mm256_srai_epi32(opmod, 1));
+		}
+		for (uint32_t index = 0; index < GROUP; index++)
+		{
+			__m256i opmod = _mm256_add_epi32(_mm256_add_epi32(_mm256_and_si256(op1[index], op4_in1), _mm256_and_si256(op2[index], op4_in2)), _mm256_and_si256(op3[index], op4_in3));
+			result[index] = _mm256_sra_epi32(block_volume_avx2(block, 3, base + index, _mm256_srai_epi32(opmod, 1)), rshift);
+		}
+		for (uint32_t index = 0; index < GROUP; index++)
+		{
+			// optionally add OP1, OP2, OP3
+			result[index] = block_clamp_add_avx2(result[index], op1[index], sum1, rshift, clipmin, clipmax);
+			result[index] = block_clamp_add_avx2(result[index], op2[index], sum2, rshift, clipmin, clipmax);
+			result[index] = block_clamp_add_avx2(result[index], op3[index], sum3, rshift, clipmin, clipmax);
+			__m256i active = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(block.active[base + index]), lane_bits), lane_bits);
+			result[index] = _mm256_and_si256(result[index], _mm256_and_si256(active, output_enable));
+			_mm256_storeu_si256((__m256i *)block.result[base + index], result[index]);
+		}
+	}
+}
+
+#endif
+
+
 //*********************************************************
 //  FM ENGINE BASE
 //*********************************************************
@@ -1208,6 +1426,11 @@ fm_engine_base<RegisterType>::fm_engine_base(ymfm_interface &intf) :
 
 	// do the initial operator assignment
 	assign_operators();
+
+	// create the block rendering state; the waveform is widened on first use
+	m_block = std::make_unique<fm_block>();
+	for (uint32_t index = 0; index < 256; index++)
+		m_block->power[index] = attenuation_to_volume(index);
 }
 
 
@@ -1391,6 +1614,180 @@ void fm_engine_base<RegisterType>::output(output_data &output, uint32_t rshift,
 }
 
 
+//-------------------------------------------------
+//  clock_block - clock and compute the output of
+//  each channel for a block of samples
+//-------------------------------------------------
+
+template<class RegisterType>
+void fm_engine_base<RegisterType>::clock_block(uint32_t count, uint32_t chanmask, uint32_t outmask, uint32_t rshift, int32_t clipmax)
+{
+	assert(count <= BLOCK_SIZE);
+
+	// mask out some channels for debug purposes
+	outmask &= debug::GLOBAL_FM_CHANNEL_MASK;
+
+	// fall back to clocking and computing each sample in turn for the
+	// features that don't fit in lanes (rhythm, noise, 2-op channels, etc)
+	if (!block_lanes_supported())
+	{
+		for (uint32_t samp = 0; samp < count; samp++)
+		{
+			clock(chanmask);
+			for (uint32_t chnum = 0; chnum < CHANNELS; chnum++)
+			{
+				m_block_output[samp][chnum].clear();
+				if (bitfield(outmask, chnum))
+					output(m_block_output[samp][chnum], rshift, clipmax, 1 << chnum);
+			}
+		}
+		return;
+	}
+
+	fm_block &block = *m_block;
+	block.lanes = std::min<uint32_t>(CHANNELS, fm_block::LANES);
+	block.count = count;
+	block.rshift = rshift;
+	block.clipmax = clipmax;
+
+	// the channel registers can't change within the block; decode them once,
+	// turning the algorithm into masks that select the inputs of each operator:
+	// opout[x] is 0, O1, O2, O3, -, O1+O2, O1+O3 or O2+O3 (as a mask of O1-O3)
+	static uint8_t const s_opout_ops[8] = { 0, 1, 2, 4, 0, 3, 5, 6 };
+	constexpr uint32_t lanes = std::min<uint32_t>(CHANNELS, fm_block::LANES);
+	uint32_t varies_mask = 0;
+	fm_operator<RegisterType> *ops[lanes][4];
+	for (uint32_t chnum = 0; chnum < lanes; chnum++)
+	{
+		fm_channel<RegisterType> &channel = *m_channel[chnum];
+		uint32_t choffs = channel.choffs();
+		for (uint32_t opnum = 0; opnum < 4; opnum++)
+			ops[chnum][opnum] = channel.op(opnum);
+		uint32_t feedback = m_regs.ch_feedback(choffs);
+		uint32_t algorithm_ops = fm_channel<RegisterType>::algorithm_ops(m_regs.ch_algorithm(choffs));
+		uint32_t op2in = s_opout_ops[bitfield(algorithm_ops, 0, 1)];
+		uint32_t op3in = s_opout_ops[bitfield(algorithm_ops, 1, 3)];
+		uint32_t op4in = s_opout_ops[bitfield(algorithm_ops, 4, 3)];
+
+		block.feedback_shift[chnum] = 10 - feedback;
+		block.feedback_enable[chnum] = -int32_t(feedback != 0);
+		block.output_enable[chnum] = -int32_t(m_regs.ch_output_any(choffs) != 0);
+		block.op2_in1[chnum] = -int32_t(bitfield(op2in, 0));
+		block.op3_in1[chnum] = -int32_t(bitfield(op3in, 0));
+		block.op3_in2[chnum] = -int32_t(bitfield(op3in, 1));
+		block.op4_in1[chnum] = -int32_t(bitfield(op4in, 0));
+		block.op4_in2[chnum] = -int32_t(bitfield(op4in, 1));
+		block.op4_in3[chnum] = -int32_t(bitfield(op4in, 2));
+		block.sum1[chnum] = -int32_t(bitfield(algorithm_ops, 7));
+		block.sum2[chnum] = -int32_t(bitfield(algorithm_ops, 8));
+		block.sum3[chnum] = -int32_t(bitfield(algorithm_ops, 9));
+
+		int16_t feedback_state[3];
+		channel.get_feedback(feedback_state);
+		for (uint32_t index = 0; index < 3; index++)
+			block.feedback[index][chnum] = feedback_state[index];
+
+		// note the operators whose attenuation can change on every sample
+		for (uint32_t opnum = 0; opnum < 4; opnum++)
+			if (ops[chnum][opnum]->block_attenuation_varies())
+				varies_mask |= 1 << (chnum * 4 + opnum);
+	}
+
+	// clock the state machines, capturing the phase and attenuation of each
+	// operator; the attenuation only changes when the envelope is clocked or
+	// the channels are prepared, except for operators using SSG-EG or AM
+	uint32_t block_active = 0;
+	for (uint32_t samp = 0; samp < count; samp++)
+	{
+		clock(chanmask);
+
+		uint32_t refresh_mask = (samp == 0 || m_prepare_count == 0 || bitfield(m_env_counter, 0, 2) == 0) ? ~0 : varies_mask;
+		uint32_t active = outmask & m_active_channels;
+		block.active[samp] = active;
+		block_active |= active;
+		for (uint32_t chnum = 0; chnum < lanes; chnum++)
+			if (bitfield(active, chnum))
+			{
+				for (uint32_t opnum = 0; opnum < 4; opnum++)
+					block.phase[opnum][samp][chnum] = ops[chnum][opnum]->phase();
+
+				uint32_t refresh = bitfield(refresh_mask, chnum * 4, 4);
+				if (refresh == 0)
+				{
+					for (uint32_t opnum = 0; opnum < 4; opnum++)
+						block.attenuation[opnum][samp][chnum] = block.attenuation[opnum][samp - 1][chnum];
+					continue;
+				}
+				uint32_t am_offset = m_regs.lfo_am_offset(ops[chnum][0]->choffs());
+				for (uint32_t opnum = 0; opnum < 4; opnum++)
+					if (bitfield(refresh, opnum))
+						block.attenuation[opnum][samp][chnum] = ops[chnum][opnum]->block_attenuation(am_offset, fm_block::QUIET);
+					else
+						block.attenuation[opnum][samp][chnum] = block.attenuation[opnum][samp - 1][chnum];
+			}
+	}
+
+	// all operators share the waveform; widen it when it changes
+	for (uint32_t chnum = 0; chnum < lanes; chnum++)
+		if (bitfield(block_active, chnum))
+		{
+			uint16_t const *waveform = ops[chnum][0]->waveform();
+			if (waveform != block.waveform_source)
+			{
+				for (uint32_t index = 0; index < RegisterType::WAVEFORM_LENGTH; index++)
+					block.waveform[index] = waveform[index];
+				block.waveform_source = waveform;
+			}
+			break;
+		}
+
+	// compute the operators of all channels; if none of them is active, just
+	// clock the feedback through
+#ifdef YMFM_AVX2
+	static CpuDispatch<void(*)(fm_block &)> render({ { CpuTier::Scalar, render_block_scalar }, { CpuTier::Avx2, render_block_avx2 } });
+#else
+	static CpuDispatch<void(*)(fm_block &)> render({ { CpuTier::Scalar, render_block_scalar } });
+#endif
+	if (block_active != 0)
+		render(block);
+	else
+	{
+		for (uint32_t chnum = 0; chnum < lanes; chnum++)
+			for (uint32_t samp = 0; samp < std::min<uint32_t>(count, 2); samp++)
+			{
+				block.feedback[0][chnum] = block.feedback[1][chnum];
+				block.feedback[1][chnum] = block.feedback[2][chnum];
+			}
+		memset(block.result, 0, sizeof(block.result[0]) * count);
+	}
+
+	// store the feedback of the clocked channels, and pan the results
+	for (uint32_t chnum = 0; chnum < lanes; chnum++)
+	{
+		fm_channel<RegisterType> &channel = *m_channel[chnum];
+		if (bitfield(chanmask, chnum))
+		{
+			int16_t feedback_state[3];
+			for (uint32_t index = 0; index < 3; index++)
+				feedback_state[index] = block.feedback[index][chnum];
+			channel.set_feedback(feedback_state);
+		}
+
+		uint32_t choffs = channel.choffs();
+		bool const pan[4] =
+		{
+			RegisterType::OUTPUTS == 1 || m_regs.ch_output_0(choffs) != 0,
+			RegisterType::OUTPUTS >= 2 && m_regs.ch_output_1(choffs) != 0,
+			RegisterType::OUTPUTS >= 3 && m_regs.ch_output_2(choffs) != 0,
+			RegisterType::OUTPUTS >= 4 && m_regs.ch_output_3(choffs) != 0
+		};
+		for (uint32_t samp = 0; samp < count; samp++)
+			for (uint32_t index = 0; index < OUTPUTS; index++)
+				m_block_output[samp][chnum].data[index] = pan[index] ? block.result[samp][chnum] : 0;
+	}
+}
+
+
 //-------------------------------------------------
 //  write - handle writes to the OPN registers
 //-------------------------------------------------
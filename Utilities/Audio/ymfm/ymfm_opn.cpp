@@ -2382,73 +2382,94 @@ void ym2612::write(uint32_t offset, uint8_t data)
 
 void ym2612::generate(output_data *output, uint32_t numsamples)
 {
-	for (uint32_t samp = 0; samp < numsamples; samp++, output++)
+	// first do FM-only channels; OPN2 is 9-bit with intermediate clipping
+	int const last_fm_channel = m_dac_enable ? 5 : 6;
+	while (numsamples != 0)
 	{
-		// clock the system
-		m_fm.clock(fm_engine::ALL_CHANNELS);
-
-		// sum individual channels to apply DAC discontinuity on each
-		output->clear();
-		output_data temp;
+		// clock the system a block at a time
+		uint32_t count = std::min(numsamples, fm_engine::BLOCK_SIZE);
+		m_fm.clock_block(count, fm_engine::ALL_CHANNELS, (1 << last_fm_channel) - 1, 5, 256);
+		numsamples -= count;
 
-		// first do FM-only channels; OPN2 is 9-bit with intermediate clipping
-		int const last_fm_channel = m_dac_enable ? 5 : 6;
-		for (int chan = 0; chan < last_fm_channel; chan++)
+		for (uint32_t samp = 0; samp < count; samp++, output++)
 		{
-			m_fm.output(temp.clear(), 5, 256, 1 << chan);
-			output->data[0] += dac_discontinuity(temp.data[0]);
-			output->data[1] += dac_discontinuity(temp.data[1]);
-		}
+			// sum individual channels to apply DAC discontinuity on each
+			output->clear();
+			for (int chan = 0; chan < last_fm_channel; chan++)
+			{
+				output_data const &temp = m_fm.block_output(samp, chan);
+				output->data[0] += dac_discontinuity(temp.data[0]);
+				output->data[1] += dac_discontinuity(temp.data[1]);
+			}
 
-		// add in DAC
-		if (m_dac_enable)
-		{
-			// DAC enabled: start with DAC value then add the first 5 channels only
-			int32_t dacval = dac_discontinuity(int16_t(m_dac_data << 7) >> 7);
-			output->data[0] += m_fm.regs().ch_output_0(0x102) ? dacval : dac_discontinuity(0);
-			output->data[1] += m_fm.regs().ch_output_1(0x102) ? dacval : dac_discontinuity(0);
-		}
+			// add in DAC
+			if (m_dac_enable)
+			{
+				// DAC enabled: start with DAC value then add the first 5 channels only
+				int32_t dacval = dac_discontinuity(int16_t(m_dac_data << 7) >> 7);
+				output->data[0] += m_fm.regs().ch_output_0(0x102) ? dacval : dac_discontinuity(0);
+				output->data[1] += m_fm.regs().ch_output_1(0x102) ? dacval : dac_discontinuity(0);
+			}
 
-		// output is technically multiplexed rather than mixed, but that requires
-		// a better sound mixer than we usually have, so just average over the six
-		// channels; also apply a 64/65 factor to account for the discontinuity
-		// adjustment above
-		output->data[0] = (output->data[0] * 128) * 64 / (6 * 65);
-		output->data[1] = (output->data[1] * 128) * 64 / (6 * 65);
+			// output is technically multiplexed rather than mixed, but that requires
+			// a better sound mixer than we usually have, so just average over the six
+			// channels; also apply a 64/65 factor to account for the discontinuity
+			// adjustment above
+			output->data[0] = (output->data[0] * 128) * 64 / (6 * 65);
+			output->data[1] = (output->data[1] * 128) * 64 / (6 * 65);
+		}
 	}
 }
 
 
+//-------------------------------------------------
+//  sum_block_output - sum the output of the FM
+//  channels in a mask for one sample of a block
+//-------------------------------------------------
+
+template<class EngineType>
+static void sum_block_output(EngineType const &fm, uint32_t samp, uint32_t chanmask, ymfm_output<EngineType::OUTPUTS> &output)
+{
+	for (uint32_t chan = 0; chan < EngineType::CHANNELS; chan++)
+		if (bitfield(chanmask, chan))
+			for (uint32_t index = 0; index < EngineType::OUTPUTS; index++)
+				output.data[index] += fm.block_output(samp, chan).data[index];
+}
+
+
 //-------------------------------------------------
 //  generate - generate one sample of sound
 //-------------------------------------------------
 
 void ym3438::generate(output_data *output, uint32_t numsamples)
 {
-	for (uint32_t samp = 0; samp < numsamples; samp++, output++)
+	// first do FM-only channels; OPN2C is 9-bit with intermediate clipping;
+	// with the DAC enabled, only the first 5 channels are added
+	uint32_t const fm_channels = m_dac_enable ? (fm_engine::ALL_CHANNELS ^ (1 << 5)) : fm_engine::ALL_CHANNELS;
+	while (numsamples != 0)
 	{
-		// clock the system
-		m_fm.clock(fm_engine::ALL_CHANNELS);
+		// clock the system a block at a time
+		uint32_t count = std::min(numsamples, fm_engine::BLOCK_SIZE);
+		m_fm.clock_block(count, fm_engine::ALL_CHANNELS, fm_channels, 5, 256);
+		numsamples -= count;
 
-		// first do FM-only channels; OPN2C is 9-bit with intermediate clipping
-		if (!m_dac_enable)
-		{
-			// DAC disabled: all 6 channels sum together
-			m_fm.output(output->clear(), 5, 256, fm_engine::ALL_CHANNELS);
-		}
-		else
+		for (uint32_t samp = 0; samp < count; samp++, output++)
 		{
-			// DAC enabled: start with DAC value then add the first 5 channels only
-			int32_t dacval = int16_t(m_dac_data << 7) >> 7;
-			output->data[0] = m_fm.regs().ch_output_0(0x102) ? dacval : 0;
-			output->data[1] = m_fm.regs().ch_output_1(0x102) ? dacval : 0;
-			m_fm.output(*output, 5, 256, fm_engine::ALL_CHANNELS ^ (1 << 5));
-		}
+			output->clear();
+			if (m_dac_enable)
+			{
+				// DAC enabled: start with DAC value
+				int32_t dacval = int16_t(m_dac_data << 7) >> 7;
+				output->data[0] = m_fm.regs().ch_output_0(0x102) ? dacval : 0;
+				output->data[1] = m_fm.regs().ch_output_1(0x102) ? dacval : 0;
+			}
+			sum_block_output(m_fm, samp, fm_channels, *output);
 
-		// YM3438 doesn't have the same DAC discontinuity, though its output is
-		// multiplexed like the YM2612
-		output->data[0] = (output->data[0] * 128) / 6;
-		output->data[1] = (output->data[1] * 128) / 6;
+			// YM3438 doesn't have the same DAC discontinuity, though its output is
+			// multiplexed like the YM2612
+			output->data[0] = (output->data[0] * 128) / 6;
+			output->data[1] = (output->data[1] * 128) / 6;
+		}
 	}
 }
 
@@ -2459,30 +2480,44 @@ void ym3438::generate(output_data *output, uint32_t numsamples)
 
 void ymf276::generate(output_data *output, uint32_t numsamples)
 {
-	for (uint32_t samp = 0; samp < numsamples; samp++, output++)
+	// first do FM-only channels; OPN2L is 14-bit with intermediate clipping;
+	// with the DAC enabled, only the first 5 channels are added
+	uint32_t const fm_channels = m_dac_enable ? (fm_engine::ALL_CHANNELS ^ (1 << 5)) : fm_engine::ALL_CHANNELS;
+	while (numsamples != 0)
 	{
-		// clock the system
-		m_fm.clock(fm_engine::ALL_CHANNELS);
+		// clock the system a block at a time
+		uint32_t count = std::min(numsamples, fm_engine::BLOCK_SIZE);
+		m_fm.clock_block(count, fm_engine::ALL_CHANNELS, fm_channels, 0, 8191);
+		numsamples -= count;
 
-		// first do FM-only channels; OPN2L is 14-bit with intermediate clipping
-		if (!m_dac_enable)
-		{
-			// DAC disabled: all 6 channels sum together
-			m_fm.output(output->clear(), 0, 8191, fm_engine::ALL_CHANNELS);
-		}
-		else
+		for (uint32_t samp = 0; samp < count; samp++, output++)
 		{
-			// DAC enabled: start with DAC value then add the first 5 channels only
-			int32_t dacval = int16_t(m_dac_data << 7) >> 7;
-			output->data[0] = m_fm.regs().ch_output_0(0x102) ? dacval : 0;
-			output->data[1] = m_fm.regs().ch_output_1(0x102) ? dacval : 0;
-			m_fm.output(*output, 0, 8191, fm_engine::ALL_CHANNELS ^ (1 << 5));
-		}
+			output->clear();
+			if (m_dac_enable)
+			{
+				// DAC enabled: start with DAC value
+				int32_t dacval = int16_t(m_dac_data << 7) >> 7;
+				output->data[0] = m_fm.regs().ch_output_0(0x102) ? dacval : 0;
+				output->data[1] = m_fm.regs().ch_output_1(0x102) ? dacval : 0;
+			}
+			sum_block_output(m_fm, samp, fm_channels, *output);
 
-		// YMF276 is properly mixed; it shifts down 1 bit before clamping
-		output->data[0] = clamp(output->data[0] >> 1, -32768, 32767);
-		output->data[1] = clamp(output->data[1] >> 1, -32768, 32767);
+			// YMF276 is properly mixed; it shifts down 1 bit before clamping
+			output->data[0] = clamp(output->data[0] >> 1, -32768, 32767);
+			output->data[1] = clamp(output->data[1] >> 1, -32768, 32767);
+		}
 	}
 }
 
+
+//-------------------------------------------------
+//  explicit instantiations - the chips above only
+//  use clock_block(), so clock()/output() are also
+//  needed by the per-sample reference generation in
+//  YmfmBenchmark
+//-------------------------------------------------
+
+template class fm_engine_base<opn_registers>;
+template class fm_engine_base<opna_registers>;
+
 }
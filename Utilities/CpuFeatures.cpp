@@ -0,0 +1,174 @@
+#include "pch.h"
+#include <cstdlib>
+#include "CpuFeatures.h"
+
+#ifdef CPU_FEATURES_X86
+	#ifdef _MSC_VER
+		#include <intrin.h>
+	#else
+		#include <cpuid.h>
+	#endif
+#endif
+
+namespace
+{
+	struct CpuState
+	{
+		bool Supported[(int)CpuTier::Neon + 1] = {};
+		atomic<int> MaxTier;
+		atomic<uint32_t> Generation;
+
+		CpuState();
+	};
+
+#ifdef CPU_FEATURES_X86
+	void Cpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4])
+	{
+#ifdef _MSC_VER
+		__cpuidex((int*)regs, (int)leaf, (int)subleaf);
+#else
+		__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+	}
+
+	uint64_t GetXcr0()
+	{
+#ifdef _MSC_VER
+		return _xgetbv(0);
+#else
+		uint32_t eax, edx;
+		__asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		return ((uint64_t)edx << 32) | eax;
+#endif
+	}
+
+	void DetectX86(CpuState& state)
+	{
+		uint32_t regs[4];
+		Cpuid(0, 0, regs);
+		uint32_t maxLeaf = regs[0];
+		if(maxLeaf < 1) {
+			return;
+		}
+
+		Cpuid(1, 0, regs);
+		bool sse2 = (regs[3] & (1 << 26)) != 0;
+		bool ssse3 = (regs[2] & (1 << 9)) != 0;
+		bool osxsave = (regs[2] & (1 << 27)) != 0;
+		bool avx = (regs[2] & (1 << 28)) != 0;
+
+		//The OS must save the YMM (and ZMM) registers on context switches
+		uint64_t xcr0 = osxsave ? GetXcr0() : 0;
+		bool ymmEnabled = (xcr0 & 0x06) == 0x06;
+		bool zmmEnabled = (xcr0 & 0xE6) == 0xE6;
+
+		bool avx2 = false;
+		bool avx512 = false;
+		if(maxLeaf >= 7) {
+			Cpuid(7, 0, regs);
+			avx2 = (regs[1] & (1 << 5)) != 0;
+			avx512 = (regs[1] & (1 << 16)) != 0 && (regs[1] & (1 << 30)) != 0;
+		}
+
+		state.Supported[(int)CpuTier::Sse2] = sse2;
+		state.Supported[(int)CpuTier::Ssse3] = sse2 && ssse3;
+		state.Supported[(int)CpuTier::Avx2] = sse2 && ssse3 && avx && avx2 && ymmEnabled;
+		state.Supported[(int)CpuTier::Avx512] = state.Supported[(int)CpuTier::Avx2] && avx512 && zmmEnabled;
+	}
+#endif
+
+	CpuTier GetDefaultMaxTier()
+	{
+		const char* forcedTier = std::getenv("NESPLAY_CPU_TIER");
+		if(forcedTier) {
+			for(int i = 0; i <= (int)CpuTier::Neon; i++) {
+				string tierName = CpuFeatures::GetTierName((CpuTier)i);
+				std::transform(tierName.begin(), tierName.end(), tierName.begin(), ::tolower);
+				if(tierName == forcedTier) {
+					return (CpuTier)i;
+				}
+			}
+		}
+		return CpuTier::Neon;
+	}
+
+	CpuState::CpuState()
+	{
+		Supported[(int)CpuTier::Scalar] = true;
+#if defined(CPU_FEATURES_X86)
+		DetectX86(*this);
+#elif defined(CPU_FEATURES_NEON)
+		Supported[(int)CpuTier::Neon] = true;
+#endif
+		MaxTier = (int)GetDefaultMaxTier();
+		Generation = 1;
+	}
+
+	CpuState& GetState()
+	{
+		static CpuState state;
+		return state;
+	}
+}
+
+bool CpuFeatures::IsSupported(CpuTier tier)
+{
+	return GetState().Supported[(int)tier];
+}
+
+bool CpuFeatures::IsEnabled(CpuTier tier)
+{
+	CpuState& state = GetState();
+	return state.Supported[(int)tier] && (int)tier <= state.MaxTier;
+}
+
+CpuTier CpuFeatures::GetTier()
+{
+	for(int i = (int)CpuTier::Neon; i > 0; i--) {
+		if(IsEnabled((CpuTier)i)) {
+			return (CpuTier)i;
+		}
+	}
+	return CpuTier::Scalar;
+}
+
+void CpuFeatures::SetMaxTier(CpuTier tier)
+{
+	CpuState& state = GetState();
+	state.MaxTier = (int)tier;
+	state.Generation++;
+}
+
+void CpuFeatures::ResetMaxTier()
+{
+	SetMaxTier(GetDefaultMaxTier());
+}
+
+uint32_t CpuFeatures::GetGeneration()
+{
+	return GetState().Generation.load(std::memory_order_acquire);
+}
+
+string CpuFeatures::GetTierName(CpuTier tier)
+{
+	switch(tier) {
+		case CpuTier::Scalar: return "Scalar";
+		case CpuTier::Sse2: return "SSE2";
+		case CpuTier::Ssse3: return "SSSE3";
+		case CpuTier::Avx2: return "AVX2";
+		case CpuTier::Avx512: return "AVX512";
+		case CpuTier::Neon: return "NEON";
+	}
+	return "";
+}
+
+string CpuFeatures::GetDescription()
+{
+	string description;
+	for(int i = (int)CpuTier::Sse2; i <= (int)CpuTier::Neon; i++) {
+		if(IsSupported((CpuTier)i)) {
+			description += (description.empty() ? "" : " ") + GetTierName((CpuTier)i);
+		}
+	}
+	return description.empty() ? GetTierName(CpuTier::Scalar) : description;
+}
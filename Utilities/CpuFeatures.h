@@ -0,0 +1,100 @@
+#pragma once
+#include "pch.h"
+#include <initializer_list>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#define CPU_FEATURES_X86
+	#ifdef _MSC_VER
+		//MSVC allows intrinsics for any instruction set in any function
+		#define CPU_TARGET_SSSE3
+		#define CPU_TARGET_AVX2
+	#else
+		//Lets a function use an instruction set that the rest of the code is not compiled for
+		#define CPU_TARGET_SSSE3 __attribute__((target("ssse3")))
+		#define CPU_TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(__aarch64__)
+	#define CPU_FEATURES_NEON
+#endif
+
+//Instruction sets that optimized functions can be written for (x86 tiers are ordered from the oldest to the newest)
+enum class CpuTier
+{
+	Scalar = 0,
+	Sse2,
+	Ssse3,
+	Avx2,
+	Avx512, //F + BW - detected, but nothing has an AVX-512 implementation yet (CpuDispatch uses the AVX2 ones)
+	Neon
+};
+
+//Detects the instruction sets supported by the CPU (and the OS) when first used
+//The tiers that can be used can be limited to test the slower implementations, with SetMaxTier() or with the
+//NESPLAY_CPU_TIER environment variable (scalar, sse2, ssse3, avx2, avx512 or neon).
+class CpuFeatures
+{
+public:
+	//True when the CPU/OS support the tier
+	static bool IsSupported(CpuTier tier);
+
+	//True when the tier is supported and not above the maximum tier
+	static bool IsEnabled(CpuTier tier);
+
+	//Highest tier that can be used
+	static CpuTier GetTier();
+
+	//Limits the tiers that can be used (CpuDispatch objects switch to the new best implementation on their next call)
+	static void SetMaxTier(CpuTier tier);
+
+	//Restores the default maximum tier (NESPLAY_CPU_TIER, or no limit)
+	static void ResetMaxTier();
+
+	//Incremented when the maximum tier changes
+	static uint32_t GetGeneration();
+
+	static string GetTierName(CpuTier tier);
+
+	//Names of the supported tiers (e.g "SSE2 SSSE3 AVX2")
+	static string GetDescription();
+};
+
+//Calls the fastest implementation of a function that can be used on this CPU
+//e.g: static CpuDispatch<void(*)(uint8_t*, size_t)> process({ { CpuTier::Scalar, ProcessScalar }, { CpuTier::Avx2, ProcessAvx2 } });
+template<typename T>
+class CpuDispatch
+{
+private:
+	vector<std::pair<CpuTier, T>> _functions;
+	atomic<T> _function;
+	atomic<uint32_t> _generation;
+
+public:
+	//A Scalar implementation must be included, the order does not matter
+	CpuDispatch(std::initializer_list<std::pair<CpuTier, T>> functions) : _functions(functions), _function(nullptr), _generation(0)
+	{
+	}
+
+	T Get()
+	{
+		uint32_t generation = CpuFeatures::GetGeneration();
+		if(_generation.load(std::memory_order_acquire) != generation) {
+			T best = nullptr;
+			CpuTier bestTier = CpuTier::Scalar;
+			for(const std::pair<CpuTier, T>& function : _functions) {
+				if((!best || function.first > bestTier) && CpuFeatures::IsEnabled(function.first)) {
+					best = function.second;
+					bestTier = function.first;
+				}
+			}
+			_function.store(best, std::memory_order_relaxed);
+			_generation.store(generation, std::memory_order_release);
+		}
+		return _function.load(std::memory_order_relaxed);
+	}
+
+	template<typename... Args>
+	auto operator()(Args&&... args) -> decltype(std::declval<T>()(std::forward<Args>(args)...))
+	{
+		return Get()(std::forward<Args>(args)...);
+	}
+};
@@ -0,0 +1,143 @@
+#include "pch.h"
+#include <cstring>
+#include "DirtyRegionScaler.h"
+#include "ParallelScaler.h"
+#include "CRC32.h"
+#include "HQX/hqx.h"
+#include "Scale2x/scalebit.h"
+#include "KreedSaiEagle/SaiEagle.h"
+
+DirtyRegionScaler::DirtyRegionScaler(ParallelScaler* parallelScaler)
+{
+	_parallelScaler = parallelScaler;
+}
+
+void DirtyRegionScaler::Invalidate()
+{
+	_valid = false;
+}
+
+uint64_t DirtyRegionScaler::GetFilterSettings(FilterType type, uint32_t value, uint32_t extra)
+{
+	return ((uint64_t)type << 56) | ((uint64_t)(value & 0xFFFFFF) << 32) | extra;
+}
+
+void DirtyRegionScaler::FindDirtyBands(const uint8_t* src, uint32_t rowSize, uint32_t height, uint32_t contextRows)
+{
+	_dirtyBands.clear();
+
+	for(uint32_t y = 0; y < height; y++) {
+		uint8_t* prevRow = _prevInput.data() + y * rowSize;
+		const uint8_t* row = src + y * rowSize;
+		if(memcmp(prevRow, row, rowSize) == 0) {
+			continue;
+		}
+		memcpy(prevRow, row, rowSize);
+
+		//The output of all rows that use this row as context needs to be updated
+		uint32_t yFirst = y > contextRows ? y - contextRows : 0;
+		uint32_t yLast = std::min(height, y + contextRows + 1);
+		if(!_dirtyBands.empty() && yFirst <= _dirtyBands.back().second + MinBandGap) {
+			_dirtyBands.back().second = std::max(_dirtyBands.back().second, yLast);
+		} else {
+			_dirtyBands.push_back({ yFirst, yLast });
+		}
+	}
+}
+
+uint32_t DirtyRegionScaler::Run(const void* src, uint32_t rowSize, uint32_t height, uint32_t contextRows, const void* output, uint64_t filterSettings, const void* filterTables, uint32_t filterConfigHash, const std::function<void(uint32_t yFirst, uint32_t yLast)>& scaleRows)
+{
+	FrameSettings settings = { rowSize, height, contextRows, output, filterSettings, filterTables, filterConfigHash };
+	if(!_valid || !(settings == _settings)) {
+		//First frame, or the output buffer/filter changed - the previous output can't be reused
+		_settings = settings;
+		_prevInput.assign((const uint8_t*)src, (const uint8_t*)src + rowSize * height);
+		_dirtyBands.clear();
+		if(height > 0) {
+			_dirtyBands.push_back({ 0, height });
+		}
+		_valid = true;
+	} else {
+		FindDirtyBands((const uint8_t*)src, rowSize, height, contextRows);
+	}
+
+	uint32_t scaledRows = 0;
+	for(std::pair<uint32_t, uint32_t>& band : _dirtyBands) {
+		uint32_t yFirst = band.first;
+		uint32_t yLast = band.second;
+		if(_parallelScaler) {
+			_parallelScaler->Run(yLast - yFirst, MinRowsPerThread, [&](uint32_t first, uint32_t last) {
+				scaleRows(yFirst + first, yFirst + last);
+			});
+		} else {
+			scaleRows(yFirst, yLast);
+		}
+		scaledRows += yLast - yFirst;
+	}
+	return scaledRows;
+}
+
+uint32_t DirtyRegionScaler::Xbrz(uint32_t scale, const uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height, xbrz::ColorFormat format, const xbrz::ScalerCfg& cfg)
+{
+	//xBRZ reads 2 rows above and below each row (see xbrz.h)
+	uint32_t cfgHash = CRC32::GetCRC((uint8_t*)&cfg, sizeof(cfg));
+	return Run(src, width * sizeof(uint32_t), height, 2, dst, GetFilterSettings(FilterType::Xbrz, scale, (uint32_t)format), nullptr, cfgHash, [=, &cfg](uint32_t yFirst, uint32_t yLast) {
+		xbrz::scale(scale, src, dst, width, height, format, cfg, yFirst, yLast);
+	});
+}
+
+uint32_t DirtyRegionScaler::Hqx(uint32_t scale, uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height)
+{
+	uint32_t srcPitch = width * sizeof(uint32_t);
+	uint32_t dstPitch = srcPitch * scale;
+	return Run(src, srcPitch, height, 1, dst, GetFilterSettings(FilterType::Hqx, scale), nullptr, 0, [=](uint32_t yFirst, uint32_t yLast) {
+		switch(scale) {
+			case 2: hq2x_32_rb(src, srcPitch, dst, dstPitch, width, height, yFirst, yLast); break;
+			case 3: hq3x_32_rb(src, srcPitch, dst, dstPitch, width, height, yFirst, yLast); break;
+			case 4: hq4x_32_rb(src, srcPitch, dst, dstPitch, width, height, yFirst, yLast); break;
+		}
+	});
+}
+
+uint32_t DirtyRegionScaler::Scale2x(uint32_t scale, uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height)
+{
+	uint32_t srcPitch = width * sizeof(uint32_t);
+	uint32_t dstPitch = srcPitch * scale;
+
+	//Scale4x applies Scale2x twice, so it reads 2 rows above and below instead of 1
+	uint32_t contextRows = scale == 4 ? 2 : 1;
+	return Run(src, srcPitch, height, contextRows, dst, GetFilterSettings(FilterType::Scale2x, scale), nullptr, 0, [=](uint32_t yFirst, uint32_t yLast) {
+		scale_rows(scale, dst, dstPitch, src, srcPitch, sizeof(uint32_t), width, height, yFirst, yLast);
+	});
+}
+
+uint32_t DirtyRegionScaler::TwoXSai(uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height)
+{
+	//The SaI/Eagle filters use a 4x4 kernel (1 row above, 2 rows below), 2 rows are used on both sides to keep things simple
+	return Run(src, width * sizeof(uint32_t), height, 2, dst, GetFilterSettings(FilterType::TwoXSai), nullptr, 0, [=](uint32_t yFirst, uint32_t yLast) {
+		twoxsai_generic_xrgb8888(width, height, src, width, dst, width * 2, yFirst, yLast);
+	});
+}
+
+uint32_t DirtyRegionScaler::SuperTwoXSai(uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height)
+{
+	return Run(src, width * sizeof(uint32_t), height, 2, dst, GetFilterSettings(FilterType::SuperTwoXSai), nullptr, 0, [=](uint32_t yFirst, uint32_t yLast) {
+		supertwoxsai_generic_xrgb8888(width, height, src, width, dst, width * 2, yFirst, yLast);
+	});
+}
+
+uint32_t DirtyRegionScaler::SuperEagle(uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height)
+{
+	return Run(src, width * sizeof(uint32_t), height, 2, dst, GetFilterSettings(FilterType::SuperEagle), nullptr, 0, [=](uint32_t yFirst, uint32_t yLast) {
+		supereagle_generic_xrgb8888(width, height, src, width, dst, width * 2, yFirst, yLast);
+	});
+}
+
+uint32_t DirtyRegionScaler::NesNtsc(const nes_ntsc_t* ntsc, uint16_t* src, uint32_t width, uint32_t height, int burstPhase, uint32_t* dst, uint32_t dstPitch)
+{
+	//The NTSC filter only blends pixels horizontally, so rows are independent - but every row's output depends on the
+	//burst phase and the ntsc tables, so the whole frame needs to be processed again when either of them changes
+	return Run(src, width * sizeof(uint16_t), height, 0, dst, GetFilterSettings(FilterType::NesNtsc, burstPhase, dstPitch), ntsc, 0, [=](uint32_t yFirst, uint32_t yLast) {
+		nes_ntsc_blit(ntsc, src + yFirst * width, width, (burstPhase + yFirst) % nes_ntsc_burst_count, width, yLast - yFirst, (uint8_t*)dst + yFirst * dstPitch, dstPitch);
+	});
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "pch.h"
+#include <functional>
+#include "xBRZ/xbrz.h"
+#include "NTSC/nes_ntsc.h"
+
+class ParallelScaler;
+
+//Only re-runs a software scaler on the parts of a frame that changed since the previous frame
+//Each source row is compared with the same row in the previous frame - rows that changed are expanded by the
+//number of rows the filter reads above/below each row (its context), and only those bands of rows are scaled again.
+//The rest of the output buffer is left untouched, so the caller must pass the same output buffer every frame
+//(the output is fully refreshed whenever the buffer, the size or the filter's settings/tables change).
+class DirtyRegionScaler
+{
+private:
+	//Dirty bands closer than this are merged together, to avoid the per-slice overhead of the filters
+	static constexpr uint32_t MinBandGap = 4;
+
+	//Minimum number of rows processed by each thread when a ParallelScaler is used
+	static constexpr uint32_t MinRowsPerThread = 16;
+
+	enum class FilterType
+	{
+		Xbrz,
+		Hqx,
+		Scale2x,
+		TwoXSai,
+		SuperTwoXSai,
+		SuperEagle,
+		NesNtsc
+	};
+
+	struct FrameSettings
+	{
+		uint32_t RowSize;
+		uint32_t Height;
+		uint32_t ContextRows;
+		const void* Output;
+		uint64_t FilterSettings;
+		const void* FilterTables; //lookup tables used by the filter (NTSC), compared by address
+		uint32_t FilterConfigHash; //CRC32 of the filter's config struct (xBRZ)
+
+		bool operator==(const FrameSettings& other) const
+		{
+			return RowSize == other.RowSize && Height == other.Height && ContextRows == other.ContextRows && Output == other.Output && FilterSettings == other.FilterSettings && FilterTables == other.FilterTables && FilterConfigHash == other.FilterConfigHash;
+		}
+	};
+
+	ParallelScaler* _parallelScaler;
+	vector<uint8_t> _prevInput;
+	vector<std::pair<uint32_t, uint32_t>> _dirtyBands;
+	FrameSettings _settings = {};
+	bool _valid = false;
+
+	static uint64_t GetFilterSettings(FilterType type, uint32_t value = 0, uint32_t extra = 0);
+	void FindDirtyBands(const uint8_t* src, uint32_t rowSize, uint32_t height, uint32_t contextRows);
+
+public:
+	//parallelScaler is optional - when set, each dirty band is split between its threads
+	DirtyRegionScaler(ParallelScaler* parallelScaler = nullptr);
+
+	//Forces the next frame to be fully scaled - must be called when the output buffer is modified by something else
+	void Invalidate();
+
+	//Calls scaleRows(yFirst, yLast) for the bands of rows of the source image that need to be scaled again
+	//rowSize is the size of a source row, in bytes. contextRows is the number of rows above/below a source row that affect
+	//its output. output, filterSettings, filterTables and filterConfigHash identify the filter/output buffer: when any of them
+	//change, the whole frame is scaled. Tables are compared by address, so tables must not be modified once they are in use.
+	//Returns the number of source rows that were scaled.
+	uint32_t Run(const void* src, uint32_t rowSize, uint32_t height, uint32_t contextRows, const void* output, uint64_t filterSettings, const void* filterTables, uint32_t filterConfigHash, const std::function<void(uint32_t yFirst, uint32_t yLast)>& scaleRows);
+
+	//Bands of rows [yFirst, yLast) that were scaled by the last call to Run()
+	const vector<std::pair<uint32_t, uint32_t>>& GetDirtyBands() { return _dirtyBands; }
+
+	uint32_t Xbrz(uint32_t scale, const uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height, xbrz::ColorFormat format, const xbrz::ScalerCfg& cfg = xbrz::ScalerCfg());
+	uint32_t Hqx(uint32_t scale, uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height);
+	uint32_t Scale2x(uint32_t scale, uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height);
+	uint32_t TwoXSai(uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height);
+	uint32_t SuperTwoXSai(uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height);
+	uint32_t SuperEagle(uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height);
+	uint32_t NesNtsc(const nes_ntsc_t* ntsc, uint16_t* src, uint32_t width, uint32_t height, int burstPhase, uint32_t* dst, uint32_t dstPitch);
+};
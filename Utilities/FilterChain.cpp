@@ -0,0 +1,271 @@
+#include "pch.h"
+#include <assert.h>
+#include <cstring>
+#include "FilterChain.h"
+#include "ParallelScaler.h"
+#include "HQX/hqx.h"
+#include "Scale2x/scalebit.h"
+#include "KreedSaiEagle/SaiEagle.h"
+
+FilterChain::FilterChain(ParallelScaler* parallelScaler)
+{
+	_parallelScaler = parallelScaler;
+}
+
+void FilterChain::Clear()
+{
+	_stages.clear();
+}
+
+void FilterChain::AddStage(uint32_t scaleX, uint32_t scaleY, uint32_t contextRows, const std::function<void(const uint8_t*, uint32_t, uint32_t, uint32_t*, uint32_t, uint32_t, uint32_t)>& scaleRows)
+{
+	Stage stage = {};
+	stage.ScaleX = scaleX;
+	stage.ScaleY = scaleY;
+	stage.ContextRows = contextRows;
+	stage.InputPixelSize = sizeof(uint32_t);
+	stage.GetOutputWidth = [scaleX](uint32_t width) { return width * scaleX; };
+	stage.ScaleRows = scaleRows;
+	_stages.push_back(stage);
+}
+
+bool FilterChain::AddNesNtsc(const nes_ntsc_t* ntsc)
+{
+	//The NTSC filter reads 16-bit palette indexes, it can't process the 32-bit output of another filter
+	assert(_stages.empty());
+	if(!_stages.empty()) {
+		return false;
+	}
+
+	//Rows are independent, but each row's burst phase depends on its position in the frame
+	AddStage(0, 1, 0, [this, ntsc](const uint8_t* src, uint32_t width, uint32_t, uint32_t* dst, uint32_t yFirst, uint32_t yLast, uint32_t rowOffset) {
+		uint32_t dstPitch = NES_NTSC_OUT_WIDTH(width) * sizeof(uint32_t);
+		int burstPhase = (_burstPhase + rowOffset + yFirst) % nes_ntsc_burst_count;
+		nes_ntsc_blit(ntsc, (const uint16_t*)src + yFirst * width, width, burstPhase, width, yLast - yFirst, (uint8_t*)dst + yFirst * dstPitch, dstPitch);
+	});
+
+	Stage& stage = _stages.back();
+	stage.InputPixelSize = sizeof(uint16_t);
+	stage.GetOutputWidth = [](uint32_t width) { return (uint32_t)NES_NTSC_OUT_WIDTH(width); };
+	return true;
+}
+
+void FilterChain::AddXbrz(uint32_t scale, xbrz::ColorFormat format, const xbrz::ScalerCfg& cfg)
+{
+	AddStage(scale, scale, 2, [=](const uint8_t* src, uint32_t width, uint32_t height, uint32_t* dst, uint32_t yFirst, uint32_t yLast, uint32_t) {
+		xbrz::scale(scale, (const uint32_t*)src, dst, width, height, format, cfg, yFirst, yLast);
+	});
+}
+
+void FilterChain::AddHqx(uint32_t scale)
+{
+	AddStage(scale, scale, 1, [=](const uint8_t* src, uint32_t width, uint32_t height, uint32_t* dst, uint32_t yFirst, uint32_t yLast, uint32_t) {
+		uint32_t srcPitch = width * sizeof(uint32_t);
+		uint32_t dstPitch = srcPitch * scale;
+		switch(scale) {
+			case 2: hq2x_32_rb((uint32_t*)src, srcPitch, dst, dstPitch, width, height, yFirst, yLast); break;
+			case 3: hq3x_32_rb((uint32_t*)src, srcPitch, dst, dstPitch, width, height, yFirst, yLast); break;
+			case 4: hq4x_32_rb((uint32_t*)src, srcPitch, dst, dstPitch, width, height, yFirst, yLast); break;
+		}
+	});
+}
+
+void FilterChain::AddScale2x(uint32_t scale)
+{
+	//Scale4x applies Scale2x twice, so it reads 2 rows above and below instead of 1
+	AddStage(scale, scale, scale == 4 ? 2 : 1, [=](const uint8_t* src, uint32_t width, uint32_t height, uint32_t* dst, uint32_t yFirst, uint32_t yLast, uint32_t) {
+		uint32_t srcPitch = width * sizeof(uint32_t);
+		scale_rows(scale, dst, srcPitch * scale, src, srcPitch, sizeof(uint32_t), width, height, yFirst, yLast);
+	});
+}
+
+void FilterChain::AddTwoXSai()
+{
+	AddStage(2, 2, 2, [](const uint8_t* src, uint32_t width, uint32_t height, uint32_t* dst, uint32_t yFirst, uint32_t yLast, uint32_t) {
+		twoxsai_generic_xrgb8888(width, height, (uint32_t*)src, width, dst, width * 2, yFirst, yLast);
+	});
+}
+
+void FilterChain::AddSuperTwoXSai()
+{
+	AddStage(2, 2, 2, [](const uint8_t* src, uint32_t width, uint32_t height, uint32_t* dst, uint32_t yFirst, uint32_t yLast, uint32_t) {
+		supertwoxsai_generic_xrgb8888(width, height, (uint32_t*)src, width, dst, width * 2, yFirst, yLast);
+	});
+}
+
+void FilterChain::AddSuperEagle()
+{
+	AddStage(2, 2, 2, [](const uint8_t* src, uint32_t width, uint32_t height, uint32_t* dst, uint32_t yFirst, uint32_t yLast, uint32_t) {
+		supereagle_generic_xrgb8888(width, height, (uint32_t*)src, width, dst, width * 2, yFirst, yLast);
+	});
+}
+
+void FilterChain::AddScanlines(uint8_t intensity)
+{
+	//Darkens every other row
+	uint32_t brightness = 255 - intensity;
+	AddPixelFilter([brightness](uint32_t* row, uint32_t width, uint32_t y) {
+		if(y & 0x01) {
+			for(uint32_t i = 0; i < width; i++) {
+				uint32_t c = row[i];
+				uint32_t rb = (((c & 0xFF00FF) * brightness) >> 8) & 0xFF00FF;
+				uint32_t g = (((c & 0xFF00) * brightness) >> 8) & 0xFF00;
+				row[i] = (c & 0xFF000000) | rb | g;
+			}
+		}
+	});
+}
+
+void FilterChain::AddPixelFilter(const PixelFilter& filter)
+{
+	if(_stages.empty()) {
+		//Nothing to fuse the filter with, copy the input rows
+		AddStage(1, 1, 0, [](const uint8_t* src, uint32_t width, uint32_t, uint32_t* dst, uint32_t yFirst, uint32_t yLast, uint32_t) {
+			memcpy(dst + yFirst * width, src + yFirst * width * sizeof(uint32_t), (yLast - yFirst) * width * sizeof(uint32_t));
+		});
+	}
+	_stages.back().PixelFilters.push_back(filter);
+}
+
+uint32_t FilterChain::GetOutputWidth(uint32_t width)
+{
+	for(Stage& stage : _stages) {
+		width = stage.GetOutputWidth(width);
+	}
+	return width;
+}
+
+uint32_t FilterChain::GetOutputHeight(uint32_t height)
+{
+	for(Stage& stage : _stages) {
+		height *= stage.ScaleY;
+	}
+	return height;
+}
+
+unique_ptr<FilterChain::Arena> FilterChain::GetArena()
+{
+	std::lock_guard<std::mutex> lock(_arenaLock);
+	if(_freeArenas.empty()) {
+		return unique_ptr<Arena>(new Arena());
+	}
+	unique_ptr<Arena> arena = std::move(_freeArenas.back());
+	_freeArenas.pop_back();
+	return arena;
+}
+
+void FilterChain::ReleaseArena(unique_ptr<Arena> arena)
+{
+	std::lock_guard<std::mutex> lock(_arenaLock);
+	_freeArenas.push_back(std::move(arena));
+}
+
+uint32_t FilterChain::GetTileRows()
+{
+	//Size of the intermediate buffers for each row of the last filter's input
+	double bytesPerRow = 0;
+	double rowsPerTileRow = 1;
+	for(size_t i = _stages.size() - 1; i > 0; i--) {
+		bytesPerRow += _widths[i] * sizeof(uint32_t) * rowsPerTileRow;
+		rowsPerTileRow /= _stages[i - 1].ScaleY;
+	}
+
+	if(bytesPerRow == 0) {
+		//Single filter, no intermediate buffers
+		return _heights.back();
+	}
+	return std::max(MinTileRows, (uint32_t)(TileBufferSize / bytesPerRow));
+}
+
+void FilterChain::ProcessTile(Arena& arena, const uint8_t* src, uint32_t* dst, uint32_t yFirst, uint32_t yLast)
+{
+	//Find the rows each filter needs to produce, starting from the last one
+	size_t stageCount = _stages.size();
+	arena.Rows.resize(stageCount);
+	size_t bufferSize = 0;
+	for(size_t i = stageCount; i-- > 0;) {
+		StageRows& rows = arena.Rows[i];
+		uint32_t context = _stages[i].ContextRows;
+		rows.First = yFirst;
+		rows.Last = yLast;
+		rows.InputFirst = yFirst > context ? yFirst - context : 0;
+		rows.InputLast = std::min(_heights[i], yLast + context);
+
+		if(i > 0) {
+			//The previous filter outputs ScaleY rows for each of its input rows
+			uint32_t scaleY = _stages[i - 1].ScaleY;
+			yFirst = rows.InputFirst / scaleY;
+			yLast = (rows.InputLast + scaleY - 1) / scaleY;
+		}
+		if(i < stageCount - 1) {
+			bufferSize += (size_t)(rows.InputLast - rows.InputFirst) * _stages[i].ScaleY * _widths[i + 1];
+		}
+	}
+
+	if(arena.Memory.size() < bufferSize) {
+		arena.Memory.resize(bufferSize);
+	}
+
+	//Each filter reads a sub-image that starts at its first input row, and writes the output for its rows to a buffer
+	//that has room for the output of the whole sub-image (the last filter writes directly to the frame's output)
+	const uint8_t* input = src + (size_t)arena.Rows[0].InputFirst * _widths[0] * _stages[0].InputPixelSize;
+	uint32_t* buffer = arena.Memory.data();
+	for(size_t i = 0; i < stageCount; i++) {
+		Stage& stage = _stages[i];
+		StageRows& rows = arena.Rows[i];
+		uint32_t outWidth = _widths[i + 1];
+		uint32_t outFirst = rows.InputFirst * stage.ScaleY;
+
+		uint32_t* output = i < stageCount - 1 ? buffer : dst + (size_t)outFirst * outWidth;
+		stage.ScaleRows(input, _widths[i], rows.InputLast - rows.InputFirst, output, rows.First - rows.InputFirst, rows.Last - rows.InputFirst, rows.InputFirst);
+
+		for(PixelFilter& filter : stage.PixelFilters) {
+			for(uint32_t y = rows.First * stage.ScaleY, end = rows.Last * stage.ScaleY; y < end; y++) {
+				filter(output + (size_t)(y - outFirst) * outWidth, outWidth, y);
+			}
+		}
+
+		if(i < stageCount - 1) {
+			input = (const uint8_t*)(output + (size_t)(arena.Rows[i + 1].InputFirst - outFirst) * outWidth);
+			buffer += (size_t)(rows.InputLast - rows.InputFirst) * stage.ScaleY * outWidth;
+		}
+	}
+}
+
+void FilterChain::Run(const void* src, uint32_t width, uint32_t height, uint32_t* dst)
+{
+	if(_stages.empty() || width == 0 || height == 0) {
+		return;
+	}
+
+	_widths.resize(_stages.size() + 1);
+	_heights.resize(_stages.size() + 1);
+	_widths[0] = width;
+	_heights[0] = height;
+	for(size_t i = 0; i < _stages.size(); i++) {
+		_widths[i + 1] = _stages[i].GetOutputWidth(_widths[i]);
+		_heights[i + 1] = _heights[i] * _stages[i].ScaleY;
+	}
+
+	//Tiles are made of rows of the last filter's input
+	uint32_t rowCount = _heights[_stages.size() - 1];
+	uint32_t tileRows = GetTileRows();
+	auto processRows = [=](uint32_t yFirst, uint32_t yLast) {
+		unique_ptr<Arena> arena = GetArena();
+		for(uint32_t y = yFirst; y < yLast; y += tileRows) {
+			//Avoid ending with a tile that is much smaller than the others
+			uint32_t tileLast = yLast - y < tileRows + MinTileRows ? yLast : y + tileRows;
+			ProcessTile(*arena, (const uint8_t*)src, dst, y, tileLast);
+			if(tileLast == yLast) {
+				break;
+			}
+		}
+		ReleaseArena(std::move(arena));
+	};
+
+	if(_parallelScaler) {
+		_parallelScaler->Run(rowCount, std::min(tileRows, MinRowsPerThread), processRows);
+	} else {
+		processRows(0, rowCount);
+	}
+}
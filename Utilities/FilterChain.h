@@ -0,0 +1,102 @@
+#pragma once
+#include "pch.h"
+#include <functional>
+#include <mutex>
+#include "xBRZ/xbrz.h"
+#include "NTSC/nes_ntsc.h"
+
+class ParallelScaler;
+
+//Runs several filters in a row on a frame (e.g NTSC, then a scaler, then scanlines)
+//Rather than running each filter on the whole frame, the frame is processed in tiles of rows that go through the whole
+//chain at once: each filter only produces the rows (and the rows above/below them) that the next filter needs for the
+//tile, in small intermediate buffers that stay in the cache. These buffers come from arenas that are reused for every frame.
+//Per-pixel filters (scanlines, custom filters) are applied to the output of the previous filter while it is still in
+//the cache, instead of needing their own pass over the frame.
+class FilterChain
+{
+public:
+	//Called for each output row of the previous filter: y is the row's position in that filter's output
+	typedef std::function<void(uint32_t* row, uint32_t width, uint32_t y)> PixelFilter;
+
+private:
+	//Target size of the intermediate buffers used by a tile (the tile's height is adjusted to match it)
+	static constexpr uint32_t TileBufferSize = 256 * 1024;
+	static constexpr uint32_t MinTileRows = 8;
+
+	//Minimum number of rows processed by each thread when a ParallelScaler is used
+	static constexpr uint32_t MinRowsPerThread = 16;
+
+	struct Stage
+	{
+		uint32_t ScaleX;
+		uint32_t ScaleY;
+		uint32_t ContextRows; //number of input rows above/below a row that affect its output
+		uint32_t InputPixelSize;
+		std::function<uint32_t(uint32_t width)> GetOutputWidth;
+
+		//Processes rows [yFirst, yLast) of the (sub)image in src - rowOffset is the position of the src image's first row in the full frame
+		std::function<void(const uint8_t* src, uint32_t width, uint32_t height, uint32_t* dst, uint32_t yFirst, uint32_t yLast, uint32_t rowOffset)> ScaleRows;
+
+		vector<PixelFilter> PixelFilters;
+	};
+
+	struct StageRows
+	{
+		uint32_t First; //rows to process
+		uint32_t Last;
+		uint32_t InputFirst; //rows that are read (including context rows)
+		uint32_t InputLast;
+	};
+
+	struct Arena
+	{
+		vector<uint32_t> Memory;
+		vector<StageRows> Rows;
+	};
+
+	ParallelScaler* _parallelScaler;
+	vector<Stage> _stages;
+	vector<uint32_t> _widths; //input size of each filter, followed by the output size
+	vector<uint32_t> _heights;
+	int _burstPhase = 0;
+
+	std::mutex _arenaLock;
+	vector<unique_ptr<Arena>> _freeArenas;
+
+	void AddStage(uint32_t scaleX, uint32_t scaleY, uint32_t contextRows, const std::function<void(const uint8_t*, uint32_t, uint32_t, uint32_t*, uint32_t, uint32_t, uint32_t)>& scaleRows);
+	unique_ptr<Arena> GetArena();
+	void ReleaseArena(unique_ptr<Arena> arena);
+
+	uint32_t GetTileRows();
+	void ProcessTile(Arena& arena, const uint8_t* src, uint32_t* dst, uint32_t yFirst, uint32_t yLast);
+
+public:
+	//parallelScaler is optional - when set, the tiles are split between its threads
+	FilterChain(ParallelScaler* parallelScaler = nullptr);
+
+	void Clear();
+
+	//Scalers - the input of the chain is 32-bit pixels, except when the first filter is the NTSC filter (16-bit palette indexes)
+	//The NTSC filter can only be the first filter (returns false otherwise)
+	bool AddNesNtsc(const nes_ntsc_t* ntsc);
+	void AddXbrz(uint32_t scale, xbrz::ColorFormat format = xbrz::ColorFormat::RGB, const xbrz::ScalerCfg& cfg = xbrz::ScalerCfg());
+	void AddHqx(uint32_t scale);
+	void AddScale2x(uint32_t scale);
+	void AddTwoXSai();
+	void AddSuperTwoXSai();
+	void AddSuperEagle();
+
+	//Per-pixel filters, fused with the filter before them (or applied to a copy of the input when added first)
+	void AddScanlines(uint8_t intensity);
+	void AddPixelFilter(const PixelFilter& filter);
+
+	//Burst phase of the first row, for the NTSC filter
+	void SetBurstPhase(int burstPhase) { _burstPhase = burstPhase; }
+
+	uint32_t GetOutputWidth(uint32_t width);
+	uint32_t GetOutputHeight(uint32_t height);
+
+	//src contains width*height pixels, dst receives GetOutputWidth(width)*GetOutputHeight(height) pixels
+	void Run(const void* src, uint32_t width, uint32_t height, uint32_t* dst);
+};
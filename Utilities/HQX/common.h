@@ -25,6 +25,12 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <complex>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define HQX_SSE2
+#endif
 
 #define MASK_2     0x0000FF00
 #define MASK_13    0x00FF00FF
@@ -38,13 +44,51 @@
 #define trU   0x00000700
 #define trV   0x00000006
 
-/* RGB to YUV lookup table */
-extern uint32_t RGBtoYUV[16777216];
-
+/* Converts a color to YUV (computed on the fly - this used to be a 64MB lookup table) */
 static inline uint32_t rgb_to_yuv(uint32_t c)
 {
-    // Mask against MASK_RGB to discard the alpha channel
-    return RGBtoYUV[MASK_RGB & c];
+    uint32_t r = (c & 0xFF0000) >> 16;
+    uint32_t g = (c & 0x00FF00) >> 8;
+    uint32_t b = c & 0x0000FF;
+    uint32_t y = (uint32_t)(0.299*r + 0.587*g + 0.114*b);
+    uint32_t u = (uint32_t)(int32_t)(-0.169*r - 0.331*g + 0.5*b) + 128;
+    uint32_t v = (uint32_t)(int32_t)(0.5*r - 0.419*g - 0.081*b) + 128;
+    return (y << 16) + (u << 8) + v;
+}
+
+/* Converts a row of pixels to YUV (same results as rgb_to_yuv) */
+static inline void rgb_to_yuv_row(const uint32_t *src, uint32_t *dst, int width)
+{
+    int i = 0;
+#if defined(HQX_SSE2)
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    const __m128i offset = _mm_set1_epi32(128);
+    for (; i + 4 <= width; i += 4) {
+        __m128i c = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i r = _mm_and_si128(_mm_srli_epi32(c, 16), mask);
+        __m128i g = _mm_and_si128(_mm_srli_epi32(c, 8), mask);
+        __m128i b = _mm_and_si128(c, mask);
+
+        __m128i yuv[3][2];
+        for (int k = 0; k < 2; k++) {
+            __m128d rd = _mm_cvtepi32_pd(k ? _mm_srli_si128(r, 8) : r);
+            __m128d gd = _mm_cvtepi32_pd(k ? _mm_srli_si128(g, 8) : g);
+            __m128d bd = _mm_cvtepi32_pd(k ? _mm_srli_si128(b, 8) : b);
+            yuv[0][k] = _mm_cvttpd_epi32(_mm_add_pd(_mm_add_pd(_mm_mul_pd(_mm_set1_pd(0.299), rd), _mm_mul_pd(_mm_set1_pd(0.587), gd)), _mm_mul_pd(_mm_set1_pd(0.114), bd)));
+            yuv[1][k] = _mm_cvttpd_epi32(_mm_add_pd(_mm_sub_pd(_mm_mul_pd(_mm_set1_pd(-0.169), rd), _mm_mul_pd(_mm_set1_pd(0.331), gd)), _mm_mul_pd(_mm_set1_pd(0.5), bd)));
+            yuv[2][k] = _mm_cvttpd_epi32(_mm_sub_pd(_mm_sub_pd(_mm_mul_pd(_mm_set1_pd(0.5), rd), _mm_mul_pd(_mm_set1_pd(0.419), gd)), _mm_mul_pd(_mm_set1_pd(0.081), bd)));
+        }
+
+        __m128i y = _mm_unpacklo_epi64(yuv[0][0], yuv[0][1]);
+        __m128i u = _mm_add_epi32(_mm_unpacklo_epi64(yuv[1][0], yuv[1][1]), offset);
+        __m128i v = _mm_add_epi32(_mm_unpacklo_epi64(yuv[2][0], yuv[2][1]), offset);
+        __m128i result = _mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(y, 16), _mm_slli_epi32(u, 8)), v);
+        _mm_storeu_si128((__m128i *)(dst + i), result);
+    }
+#endif
+    for (; i < width; i++) {
+        dst[i] = rgb_to_yuv(src[i]);
+    }
 }
 
 /* Test if there is difference in color */
@@ -54,9 +98,58 @@ static inline int yuv_diff(uint32_t yuv1, uint32_t yuv2) {
             ( std::abs((int)((yuv1 & Vmask) - (yuv2 & Vmask))) > trV ) );
 }
 
-static inline int Diff(uint32_t c1, uint32_t c2)
+/* Compares the keys of 2 pixels - YUV values for 32-bit input */
+struct hqx_yuv_diff
+{
+    int operator()(uint32_t yuv1, uint32_t yuv2) const { return yuv_diff(yuv1, yuv2); }
+};
+
+/* Compares the keys of 2 pixels - palette indexes for indexed input, using a table built by hqx_build_diff_table */
+struct hqx_table_diff
 {
-    return yuv_diff(rgb_to_yuv(c1), rgb_to_yuv(c2));
+    const uint8_t *table;
+    uint32_t size;
+
+    hqx_table_diff(const uint8_t *table, int size) : table(table), size((uint32_t)size) {}
+    int operator()(uint32_t idx1, uint32_t idx2) const { return table[idx1 * size + idx2]; }
+};
+
+/* Clamps the slice of rows [yFirst, yLast) to the image, returns 0 if there is nothing to process */
+static inline int hqx_clamp_rows(int &yFirst, int &yLast, int Yres)
+{
+    if (yFirst < 0) yFirst = 0;
+    if (yLast > Yres) yLast = Yres;
+    return yFirst < yLast;
+}
+
+/* Converts the slice's rows (and the rows above/below it) to YUV once, rather than converting each pixel up to 9 times
+   Returns the YUV values for row yFirst (rows are width values apart) */
+static inline const uint32_t *hqx_yuv_rows(const uint32_t *src, uint32_t srb, int width, int height, int yFirst, int yLast)
+{
+    int first = yFirst > 0 ? yFirst - 1 : 0;
+    int last = yLast < height ? yLast + 1 : height;
+    static thread_local std::vector<uint32_t> yuvBuffer;
+    yuvBuffer.resize((size_t)width * (last - first));
+    for (int j = first; j < last; j++)
+        rgb_to_yuv_row((const uint32_t *)((const uint8_t *)src + (size_t)j * srb), yuvBuffer.data() + (size_t)(j - first) * width, width);
+    return yuvBuffer.data() + (size_t)(yFirst - first) * width;
+}
+
+/* Same as hqx_yuv_rows, for indexed input: converts the slice's rows (and the rows above/below it) to 32-bit colors
+   Returns the colors for row yFirst (rows are width pixels apart) */
+static inline const uint32_t *hqx_palette_rows(const uint16_t *src, int srcPitch, const uint32_t *palette, int width, int height, int yFirst, int yLast)
+{
+    int first = yFirst > 0 ? yFirst - 1 : 0;
+    int last = yLast < height ? yLast + 1 : height;
+    static thread_local std::vector<uint32_t> colorBuffer;
+    colorBuffer.resize((size_t)width * (last - first));
+    for (int j = first; j < last; j++) {
+        const uint16_t *in = src + (size_t)j * srcPitch;
+        uint32_t *out = colorBuffer.data() + (size_t)(j - first) * width;
+        for (int i = 0; i < width; i++)
+            out[i] = palette[in[i]];
+    }
+    return colorBuffer.data() + (size_t)(yFirst - first) * width;
 }
 
 /* Interpolate functions */
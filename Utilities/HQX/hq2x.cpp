@@ -72,16 +72,22 @@
 #define PIXEL11_90    *(dp+dpL+1) = Interp9(w[5], w[6], w[8]);
 #define PIXEL11_100   *(dp+dpL+1) = Interp10(w[5], w[6], w[8]);
 
-void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres )
+//Shared by the 32-bit and indexed versions: sp/yp/dp point to row yFirst of the source, key and destination images
+//Keys are compared with diff() to detect different colors (YUV values for 32-bit input, palette indexes for indexed input)
+template<typename Key, typename Diff>
+static void hq2x_body( const uint32_t * sp, uint32_t srb, const Key * yp, int ypL, uint32_t * dp, uint32_t drb, int Xres, int Yres, int yFirst, int yLast, Diff diff )
 {
     int  i, j, k;
     int  prevline, nextline;
     uint32_t  w[10];
     int dpL = (drb >> 2);
     int spL = (srb >> 2);
-    uint8_t *sRowP = (uint8_t *) sp;
+    const uint8_t *sRowP = (const uint8_t *) sp;
     uint8_t *dRowP = (uint8_t *) dp;
+    const Key *yRowP = yp;
     uint32_t yuv1, yuv2;
+    uint32_t  y[10];
+    int  prevYuvLine, nextYuvLine;
 
     //   +----+----+----+
     //   |    |    |    |
@@ -94,28 +100,39 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
     //   | w7 | w8 | w9 |
     //   +----+----+----+
 
-    for (j=0; j<Yres; j++)
+    for (j=yFirst; j<yLast; j++)
     {
         if (j>0)      prevline = -spL; else prevline = 0;
         if (j<Yres-1) nextline =  spL; else nextline = 0;
+        prevYuvLine = prevline ? -ypL : 0;
+        nextYuvLine = nextline ? ypL : 0;
 
         for (i=0; i<Xres; i++)
         {
             w[2] = *(sp + prevline);
             w[5] = *sp;
             w[8] = *(sp + nextline);
+            y[2] = *(yp + prevYuvLine);
+            y[5] = *yp;
+            y[8] = *(yp + nextYuvLine);
 
             if (i>0)
             {
                 w[1] = *(sp + prevline - 1);
                 w[4] = *(sp - 1);
                 w[7] = *(sp + nextline - 1);
+                y[1] = *(yp + prevYuvLine - 1);
+                y[4] = *(yp - 1);
+                y[7] = *(yp + nextYuvLine - 1);
             }
             else
             {
                 w[1] = w[2];
                 w[4] = w[5];
                 w[7] = w[8];
+                y[1] = y[2];
+                y[4] = y[5];
+                y[7] = y[8];
             }
 
             if (i<Xres-1)
@@ -123,18 +140,24 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 w[3] = *(sp + prevline + 1);
                 w[6] = *(sp + 1);
                 w[9] = *(sp + nextline + 1);
+                y[3] = *(yp + prevYuvLine + 1);
+                y[6] = *(yp + 1);
+                y[9] = *(yp + nextYuvLine + 1);
             }
             else
             {
                 w[3] = w[2];
                 w[6] = w[5];
                 w[9] = w[8];
+                y[3] = y[2];
+                y[6] = y[5];
+                y[9] = y[8];
             }
 
             int pattern = 0;
             int flag = 1;
 
-            yuv1 = rgb_to_yuv(w[5]);
+            yuv1 = y[5];
 
             for (k=1; k<=9; k++)
             {
@@ -142,8 +165,8 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
 
                 if ( w[k] != w[5] )
                 {
-                    yuv2 = rgb_to_yuv(w[k]);
-                    if (yuv_diff(yuv1, yuv2))
+                    yuv2 = y[k];
+                    if (diff(yuv1, yuv2))
                         pattern |= flag;
                 }
                 flag <<= 1;
@@ -310,7 +333,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 50:
                     {
                         PIXEL00_22
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_10
                         }
@@ -328,7 +351,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL00_20
                         PIXEL01_22
                         PIXEL10_21
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_10
                         }
@@ -343,7 +366,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_21
                         PIXEL01_20
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_10
                         }
@@ -357,7 +380,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 10:
                 case 138:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_10
                         }
@@ -430,7 +453,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 54:
                     {
                         PIXEL00_22
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                         }
@@ -448,7 +471,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL00_20
                         PIXEL01_22
                         PIXEL10_21
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_0
                         }
@@ -463,7 +486,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_21
                         PIXEL01_20
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                         }
@@ -477,7 +500,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 11:
                 case 139:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -493,7 +516,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 19:
                 case 51:
                     {
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL00_11
                             PIXEL01_10
@@ -511,7 +534,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 178:
                     {
                         PIXEL00_22
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_10
                             PIXEL11_12
@@ -528,7 +551,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 85:
                     {
                         PIXEL00_20
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL01_11
                             PIXEL11_10
@@ -546,7 +569,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_20
                         PIXEL01_22
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL10_12
                             PIXEL11_10
@@ -563,7 +586,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_21
                         PIXEL01_20
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_10
                             PIXEL11_11
@@ -578,7 +601,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 73:
                 case 77:
                     {
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL00_12
                             PIXEL10_10
@@ -595,7 +618,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 42:
                 case 170:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_10
                             PIXEL10_11
@@ -612,7 +635,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 14:
                 case 142:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_10
                             PIXEL01_12
@@ -693,7 +716,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 26:
                 case 31:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -701,7 +724,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL00_20
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                         }
@@ -717,7 +740,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 214:
                     {
                         PIXEL00_22
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                         }
@@ -726,7 +749,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL01_20
                         }
                         PIXEL10_21
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_0
                         }
@@ -741,7 +764,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_21
                         PIXEL01_22
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                         }
@@ -749,7 +772,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL10_20
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_0
                         }
@@ -762,7 +785,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 74:
                 case 107:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -771,7 +794,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL00_20
                         }
                         PIXEL01_21
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                         }
@@ -784,7 +807,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 27:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -800,7 +823,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 86:
                     {
                         PIXEL00_22
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                         }
@@ -817,7 +840,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL00_21
                         PIXEL01_22
                         PIXEL10_10
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_0
                         }
@@ -831,7 +854,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_10
                         PIXEL01_21
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                         }
@@ -845,7 +868,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 30:
                     {
                         PIXEL00_10
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                         }
@@ -862,7 +885,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL00_22
                         PIXEL01_10
                         PIXEL10_21
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_0
                         }
@@ -876,7 +899,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_21
                         PIXEL01_22
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                         }
@@ -889,7 +912,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 75:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -1000,7 +1023,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 58:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_10
                         }
@@ -1008,7 +1031,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL00_70
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_10
                         }
@@ -1023,7 +1046,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 83:
                     {
                         PIXEL00_11
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_10
                         }
@@ -1032,7 +1055,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL01_70
                         }
                         PIXEL10_21
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_10
                         }
@@ -1046,7 +1069,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_21
                         PIXEL01_11
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_10
                         }
@@ -1054,7 +1077,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL10_70
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_10
                         }
@@ -1066,7 +1089,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 202:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_10
                         }
@@ -1075,7 +1098,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL00_70
                         }
                         PIXEL01_21
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_10
                         }
@@ -1088,7 +1111,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 78:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_10
                         }
@@ -1097,7 +1120,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL00_70
                         }
                         PIXEL01_12
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_10
                         }
@@ -1110,7 +1133,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 154:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_10
                         }
@@ -1118,7 +1141,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL00_70
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_10
                         }
@@ -1133,7 +1156,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 114:
                     {
                         PIXEL00_22
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_10
                         }
@@ -1142,7 +1165,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL01_70
                         }
                         PIXEL10_12
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_10
                         }
@@ -1156,7 +1179,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_12
                         PIXEL01_22
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_10
                         }
@@ -1164,7 +1187,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL10_70
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_10
                         }
@@ -1176,7 +1199,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 90:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_10
                         }
@@ -1184,7 +1207,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL00_70
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_10
                         }
@@ -1192,7 +1215,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL01_70
                         }
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_10
                         }
@@ -1200,7 +1223,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL10_70
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_10
                         }
@@ -1213,7 +1236,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 55:
                 case 23:
                     {
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL00_11
                             PIXEL01_0
@@ -1231,7 +1254,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 150:
                     {
                         PIXEL00_22
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                             PIXEL11_12
@@ -1248,7 +1271,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 212:
                     {
                         PIXEL00_20
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL01_11
                             PIXEL11_0
@@ -1266,7 +1289,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_20
                         PIXEL01_22
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL10_12
                             PIXEL11_0
@@ -1283,7 +1306,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_21
                         PIXEL01_20
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                             PIXEL11_11
@@ -1298,7 +1321,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 109:
                 case 105:
                     {
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL00_12
                             PIXEL10_0
@@ -1315,7 +1338,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 171:
                 case 43:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                             PIXEL10_11
@@ -1332,7 +1355,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 143:
                 case 15:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                             PIXEL01_12
@@ -1350,7 +1373,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_21
                         PIXEL01_11
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                         }
@@ -1363,7 +1386,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 203:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -1379,7 +1402,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 62:
                     {
                         PIXEL00_10
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                         }
@@ -1396,7 +1419,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL00_11
                         PIXEL01_10
                         PIXEL10_21
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_0
                         }
@@ -1409,7 +1432,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 118:
                     {
                         PIXEL00_22
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                         }
@@ -1426,7 +1449,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL00_12
                         PIXEL01_22
                         PIXEL10_10
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_0
                         }
@@ -1440,7 +1463,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_10
                         PIXEL01_12
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                         }
@@ -1453,7 +1476,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 155:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -1534,7 +1557,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_21
                         PIXEL01_11
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_10
                         }
@@ -1542,7 +1565,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL10_70
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_0
                         }
@@ -1554,7 +1577,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 158:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_10
                         }
@@ -1562,7 +1585,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL00_70
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                         }
@@ -1576,7 +1599,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 234:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_10
                         }
@@ -1585,7 +1608,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL00_70
                         }
                         PIXEL01_21
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                         }
@@ -1599,7 +1622,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 242:
                     {
                         PIXEL00_22
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_10
                         }
@@ -1608,7 +1631,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL01_70
                         }
                         PIXEL10_12
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_0
                         }
@@ -1620,7 +1643,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 59:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -1628,7 +1651,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL00_20
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_10
                         }
@@ -1644,7 +1667,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_12
                         PIXEL01_22
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                         }
@@ -1652,7 +1675,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL10_20
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_10
                         }
@@ -1665,7 +1688,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 87:
                     {
                         PIXEL00_11
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                         }
@@ -1674,7 +1697,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL01_20
                         }
                         PIXEL10_21
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_10
                         }
@@ -1686,7 +1709,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 79:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -1695,7 +1718,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL00_20
                         }
                         PIXEL01_12
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_10
                         }
@@ -1708,7 +1731,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 122:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_10
                         }
@@ -1716,7 +1739,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL00_70
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_10
                         }
@@ -1724,7 +1747,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL01_70
                         }
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                         }
@@ -1732,7 +1755,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL10_20
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_10
                         }
@@ -1744,7 +1767,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 94:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_10
                         }
@@ -1752,7 +1775,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL00_70
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                         }
@@ -1760,7 +1783,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL01_20
                         }
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_10
                         }
@@ -1768,7 +1791,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL10_70
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_10
                         }
@@ -1780,7 +1803,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 218:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_10
                         }
@@ -1788,7 +1811,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL00_70
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_10
                         }
@@ -1796,7 +1819,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL01_70
                         }
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_10
                         }
@@ -1804,7 +1827,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL10_70
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_0
                         }
@@ -1816,7 +1839,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 91:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -1824,7 +1847,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL00_20
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_10
                         }
@@ -1832,7 +1855,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL01_70
                         }
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_10
                         }
@@ -1840,7 +1863,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL10_70
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_10
                         }
@@ -1884,7 +1907,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 186:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_10
                         }
@@ -1892,7 +1915,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL00_70
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_10
                         }
@@ -1907,7 +1930,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 115:
                     {
                         PIXEL00_11
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_10
                         }
@@ -1916,7 +1939,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL01_70
                         }
                         PIXEL10_12
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_10
                         }
@@ -1930,7 +1953,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_12
                         PIXEL01_11
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_10
                         }
@@ -1938,7 +1961,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL10_70
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_10
                         }
@@ -1950,7 +1973,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 206:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_10
                         }
@@ -1959,7 +1982,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL00_70
                         }
                         PIXEL01_12
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_10
                         }
@@ -1975,7 +1998,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_12
                         PIXEL01_20
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_10
                         }
@@ -1989,7 +2012,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 174:
                 case 46:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_10
                         }
@@ -2006,7 +2029,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 147:
                     {
                         PIXEL00_11
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_10
                         }
@@ -2024,7 +2047,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL00_20
                         PIXEL01_11
                         PIXEL10_12
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_10
                         }
@@ -2053,7 +2076,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 126:
                     {
                         PIXEL00_10
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                         }
@@ -2061,7 +2084,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL01_20
                         }
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                         }
@@ -2074,7 +2097,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 219:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -2084,7 +2107,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         }
                         PIXEL01_10
                         PIXEL10_10
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_0
                         }
@@ -2096,7 +2119,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 125:
                     {
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL00_12
                             PIXEL10_0
@@ -2113,7 +2136,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 221:
                     {
                         PIXEL00_12
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL01_11
                             PIXEL11_0
@@ -2128,7 +2151,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 207:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                             PIXEL01_12
@@ -2146,7 +2169,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_10
                         PIXEL01_12
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                             PIXEL11_11
@@ -2161,7 +2184,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 190:
                     {
                         PIXEL00_10
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                             PIXEL11_12
@@ -2176,7 +2199,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 187:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                             PIXEL10_11
@@ -2194,7 +2217,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_11
                         PIXEL01_10
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL10_12
                             PIXEL11_0
@@ -2208,7 +2231,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 119:
                     {
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL00_11
                             PIXEL01_0
@@ -2227,7 +2250,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_12
                         PIXEL01_20
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                         }
@@ -2241,7 +2264,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 175:
                 case 47:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -2258,7 +2281,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 151:
                     {
                         PIXEL00_11
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                         }
@@ -2276,7 +2299,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL00_20
                         PIXEL01_11
                         PIXEL10_12
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_0
                         }
@@ -2290,7 +2313,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_10
                         PIXEL01_10
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                         }
@@ -2298,7 +2321,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL10_20
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_0
                         }
@@ -2310,7 +2333,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 123:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -2319,7 +2342,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL00_20
                         }
                         PIXEL01_10
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                         }
@@ -2332,7 +2355,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 95:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -2340,7 +2363,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL00_20
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                         }
@@ -2355,7 +2378,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 222:
                     {
                         PIXEL00_10
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                         }
@@ -2364,7 +2387,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL01_20
                         }
                         PIXEL10_10
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_0
                         }
@@ -2378,7 +2401,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_21
                         PIXEL01_11
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                         }
@@ -2386,7 +2409,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL10_20
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_0
                         }
@@ -2400,7 +2423,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_12
                         PIXEL01_22
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                         }
@@ -2408,7 +2431,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL10_100
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_0
                         }
@@ -2420,7 +2443,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 235:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -2429,7 +2452,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL00_20
                         }
                         PIXEL01_21
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                         }
@@ -2442,7 +2465,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 111:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -2451,7 +2474,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL00_100
                         }
                         PIXEL01_12
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                         }
@@ -2464,7 +2487,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 63:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -2472,7 +2495,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL00_100
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                         }
@@ -2486,7 +2509,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 159:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -2494,7 +2517,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL00_20
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                         }
@@ -2509,7 +2532,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 215:
                     {
                         PIXEL00_11
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                         }
@@ -2518,7 +2541,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL01_100
                         }
                         PIXEL10_21
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_0
                         }
@@ -2531,7 +2554,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 246:
                     {
                         PIXEL00_22
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                         }
@@ -2540,7 +2563,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL01_20
                         }
                         PIXEL10_12
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_0
                         }
@@ -2553,7 +2576,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 254:
                     {
                         PIXEL00_10
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                         }
@@ -2561,7 +2584,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL01_20
                         }
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                         }
@@ -2569,7 +2592,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL10_20
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_0
                         }
@@ -2583,7 +2606,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_12
                         PIXEL01_11
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                         }
@@ -2591,7 +2614,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL10_100
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_0
                         }
@@ -2603,7 +2626,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 251:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -2612,7 +2635,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL00_20
                         }
                         PIXEL01_10
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                         }
@@ -2620,7 +2643,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL10_100
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_0
                         }
@@ -2632,7 +2655,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 239:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -2641,7 +2664,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL00_100
                         }
                         PIXEL01_12
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                         }
@@ -2654,7 +2677,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 127:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -2662,7 +2685,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL00_100
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                         }
@@ -2670,7 +2693,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL01_20
                         }
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                         }
@@ -2683,7 +2706,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 191:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -2691,7 +2714,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL00_100
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                         }
@@ -2705,7 +2728,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 223:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -2713,7 +2736,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL00_20
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                         }
@@ -2722,7 +2745,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL01_100
                         }
                         PIXEL10_10
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_0
                         }
@@ -2735,7 +2758,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 247:
                     {
                         PIXEL00_11
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                         }
@@ -2744,7 +2767,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL01_100
                         }
                         PIXEL10_12
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_0
                         }
@@ -2756,7 +2779,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 255:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -2764,7 +2787,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL00_100
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_0
                         }
@@ -2772,7 +2795,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL01_100
                         }
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_0
                         }
@@ -2780,7 +2803,7 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL10_100
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL11_0
                         }
@@ -2792,17 +2815,40 @@ void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
             }
             sp++;
+            yp++;
             dp += 2;
         }
 
         sRowP += srb;
-        sp = (uint32_t *) sRowP;
+        sp = (const uint32_t *) sRowP;
+
+        yRowP += ypL;
+        yp = yRowP;
 
         dRowP += drb * 2;
         dp = (uint32_t *) dRowP;
     }
 }
 
+void HQX_CALLCONV hq2x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres, int yFirst, int yLast )
+{
+    //Only rows [yFirst, yLast) are processed - the source/destination pointers always point to the full image
+    if (!hqx_clamp_rows(yFirst, yLast, Yres)) return;
+
+    const uint32_t *yp = hqx_yuv_rows(sp, srb, Xres, Yres, yFirst, yLast);
+    hq2x_body((const uint32_t *)((const uint8_t *)sp + (size_t)yFirst * srb), srb, yp, Xres,
+        (uint32_t *)((uint8_t *)dp + (size_t)yFirst * drb * 2), drb, Xres, Yres, yFirst, yLast, hqx_yuv_diff());
+}
+
+void HQX_CALLCONV hq2x_indexed_rb( const uint16_t * src, int srcPitch, const uint32_t * palette, const uint8_t * diffTable, int paletteSize, uint32_t * dp, uint32_t drb, int Xres, int Yres, int yFirst, int yLast )
+{
+    if (!hqx_clamp_rows(yFirst, yLast, Yres)) return;
+
+    const uint32_t *colors = hqx_palette_rows(src, srcPitch, palette, Xres, Yres, yFirst, yLast);
+    hq2x_body(colors, Xres * 4, src + (size_t)yFirst * srcPitch, srcPitch,
+        (uint32_t *)((uint8_t *)dp + (size_t)yFirst * drb * 2), drb, Xres, Yres, yFirst, yLast, hqx_table_diff(diffTable, paletteSize));
+}
+
 void HQX_CALLCONV hq2x_32( uint32_t * sp, uint32_t * dp, int Xres, int Yres )
 {
     uint32_t rowBytesL = Xres * 4;
@@ -77,16 +77,22 @@
 #define PIXEL22_5   *(dp+dpL+dpL+2) = Interp5(w[6], w[8]);
 #define PIXEL22_C   *(dp+dpL+dpL+2) = w[5];
 
-void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres )
+//Shared by the 32-bit and indexed versions: sp/yp/dp point to row yFirst of the source, key and destination images
+//Keys are compared with diff() to detect different colors (YUV values for 32-bit input, palette indexes for indexed input)
+template<typename Key, typename Diff>
+static void hq3x_body( const uint32_t * sp, uint32_t srb, const Key * yp, int ypL, uint32_t * dp, uint32_t drb, int Xres, int Yres, int yFirst, int yLast, Diff diff )
 {
     int  i, j, k;
     int  prevline, nextline;
     uint32_t  w[10];
     int dpL = (drb >> 2);
     int spL = (srb >> 2);
-    uint8_t *sRowP = (uint8_t *) sp;
+    const uint8_t *sRowP = (const uint8_t *) sp;
     uint8_t *dRowP = (uint8_t *) dp;
+    const Key *yRowP = yp;
     uint32_t yuv1, yuv2;
+    uint32_t  y[10];
+    int  prevYuvLine, nextYuvLine;
 
     //   +----+----+----+
     //   |    |    |    |
@@ -99,28 +105,39 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
     //   | w7 | w8 | w9 |
     //   +----+----+----+
 
-    for (j=0; j<Yres; j++)
+    for (j=yFirst; j<yLast; j++)
     {
         if (j>0)      prevline = -spL; else prevline = 0;
         if (j<Yres-1) nextline =  spL; else nextline = 0;
+        prevYuvLine = prevline ? -ypL : 0;
+        nextYuvLine = nextline ? ypL : 0;
 
         for (i=0; i<Xres; i++)
         {
             w[2] = *(sp + prevline);
             w[5] = *sp;
             w[8] = *(sp + nextline);
+            y[2] = *(yp + prevYuvLine);
+            y[5] = *yp;
+            y[8] = *(yp + nextYuvLine);
 
             if (i>0)
             {
                 w[1] = *(sp + prevline - 1);
                 w[4] = *(sp - 1);
                 w[7] = *(sp + nextline - 1);
+                y[1] = *(yp + prevYuvLine - 1);
+                y[4] = *(yp - 1);
+                y[7] = *(yp + nextYuvLine - 1);
             }
             else
             {
                 w[1] = w[2];
                 w[4] = w[5];
                 w[7] = w[8];
+                y[1] = y[2];
+                y[4] = y[5];
+                y[7] = y[8];
             }
 
             if (i<Xres-1)
@@ -128,18 +145,24 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 w[3] = *(sp + prevline + 1);
                 w[6] = *(sp + 1);
                 w[9] = *(sp + nextline + 1);
+                y[3] = *(yp + prevYuvLine + 1);
+                y[6] = *(yp + 1);
+                y[9] = *(yp + nextYuvLine + 1);
             }
             else
             {
                 w[3] = w[2];
                 w[6] = w[5];
                 w[9] = w[8];
+                y[3] = y[2];
+                y[6] = y[5];
+                y[9] = y[8];
             }
 
             int pattern = 0;
             int flag = 1;
 
-            yuv1 = rgb_to_yuv(w[5]);
+            yuv1 = y[5];
 
             for (k=1; k<=9; k++)
             {
@@ -147,8 +170,8 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
 
                 if ( w[k] != w[5] )
                 {
-                    yuv2 = rgb_to_yuv(w[k]);
-                    if (yuv_diff(yuv1, yuv2))
+                    yuv2 = y[k];
+                    if (diff(yuv1, yuv2))
                         pattern |= flag;
                 }
                 flag <<= 1;
@@ -380,7 +403,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 50:
                     {
                         PIXEL00_1M
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_C
                             PIXEL02_1M
@@ -408,7 +431,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_1
                         PIXEL11
                         PIXEL20_1M
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL12_C
                             PIXEL21_C
@@ -430,7 +453,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL02_2
                         PIXEL11
                         PIXEL12_1
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_C
                             PIXEL20_1M
@@ -448,7 +471,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 10:
                 case 138:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_1M
                             PIXEL01_C
@@ -558,7 +581,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 54:
                     {
                         PIXEL00_1M
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_C
                             PIXEL02_C
@@ -586,7 +609,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_1
                         PIXEL11
                         PIXEL20_1M
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL12_C
                             PIXEL21_C
@@ -608,7 +631,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL02_2
                         PIXEL11
                         PIXEL12_1
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_C
                             PIXEL20_C
@@ -626,7 +649,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 11:
                 case 139:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                             PIXEL01_C
@@ -649,7 +672,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 19:
                 case 51:
                     {
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL00_1L
                             PIXEL01_C
@@ -673,7 +696,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 146:
                 case 178:
                     {
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_C
                             PIXEL02_1M
@@ -697,7 +720,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 84:
                 case 85:
                     {
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL02_1U
                             PIXEL12_C
@@ -721,7 +744,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 112:
                 case 113:
                     {
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL12_C
                             PIXEL20_1L
@@ -745,7 +768,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 200:
                 case 204:
                     {
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_C
                             PIXEL20_1M
@@ -769,7 +792,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 73:
                 case 77:
                     {
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL00_1U
                             PIXEL10_C
@@ -793,7 +816,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 42:
                 case 170:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_1M
                             PIXEL01_C
@@ -817,7 +840,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 14:
                 case 142:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_1M
                             PIXEL01_C
@@ -945,7 +968,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 26:
                 case 31:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                             PIXEL10_C
@@ -956,7 +979,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL10_3
                         }
                         PIXEL01_C
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_C
                             PIXEL12_C
@@ -976,7 +999,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 214:
                     {
                         PIXEL00_1M
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_C
                             PIXEL02_C
@@ -990,7 +1013,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11
                         PIXEL12_C
                         PIXEL20_1M
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL21_C
                             PIXEL22_C
@@ -1009,7 +1032,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL01_1
                         PIXEL02_1M
                         PIXEL11
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_C
                             PIXEL20_C
@@ -1020,7 +1043,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL20_4
                         }
                         PIXEL21_C
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL12_C
                             PIXEL22_C
@@ -1035,7 +1058,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 74:
                 case 107:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                             PIXEL01_C
@@ -1049,7 +1072,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_C
                         PIXEL11
                         PIXEL12_1
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_C
                             PIXEL21_C
@@ -1064,7 +1087,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 27:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                             PIXEL01_C
@@ -1087,7 +1110,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 86:
                     {
                         PIXEL00_1M
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_C
                             PIXEL02_C
@@ -1114,7 +1137,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_C
                         PIXEL11
                         PIXEL20_1M
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL12_C
                             PIXEL21_C
@@ -1135,7 +1158,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL02_1M
                         PIXEL11
                         PIXEL12_1
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_C
                             PIXEL20_C
@@ -1153,7 +1176,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 30:
                     {
                         PIXEL00_1M
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_C
                             PIXEL02_C
@@ -1180,7 +1203,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_1
                         PIXEL11
                         PIXEL20_1M
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL12_C
                             PIXEL21_C
@@ -1201,7 +1224,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL02_1M
                         PIXEL11
                         PIXEL12_C
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_C
                             PIXEL20_C
@@ -1218,7 +1241,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 75:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                             PIXEL01_C
@@ -1396,7 +1419,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 58:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_1M
                         }
@@ -1405,7 +1428,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL00_2
                         }
                         PIXEL01_C
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_1M
                         }
@@ -1425,7 +1448,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_1L
                         PIXEL01_C
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_1M
                         }
@@ -1438,7 +1461,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL12_C
                         PIXEL20_1M
                         PIXEL21_C
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_1M
                         }
@@ -1456,7 +1479,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_C
                         PIXEL11
                         PIXEL12_C
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_1M
                         }
@@ -1465,7 +1488,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL20_2
                         }
                         PIXEL21_C
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_1M
                         }
@@ -1477,7 +1500,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 202:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_1M
                         }
@@ -1490,7 +1513,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_C
                         PIXEL11
                         PIXEL12_1
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_1M
                         }
@@ -1504,7 +1527,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 78:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_1M
                         }
@@ -1517,7 +1540,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_C
                         PIXEL11
                         PIXEL12_1
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_1M
                         }
@@ -1531,7 +1554,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 154:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_1M
                         }
@@ -1540,7 +1563,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL00_2
                         }
                         PIXEL01_C
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_1M
                         }
@@ -1560,7 +1583,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_1M
                         PIXEL01_C
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_1M
                         }
@@ -1573,7 +1596,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL12_C
                         PIXEL20_1L
                         PIXEL21_C
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_1M
                         }
@@ -1591,7 +1614,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_C
                         PIXEL11
                         PIXEL12_C
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_1M
                         }
@@ -1600,7 +1623,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL20_2
                         }
                         PIXEL21_C
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_1M
                         }
@@ -1612,7 +1635,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 90:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_1M
                         }
@@ -1621,7 +1644,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL00_2
                         }
                         PIXEL01_C
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_1M
                         }
@@ -1632,7 +1655,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_C
                         PIXEL11
                         PIXEL12_C
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_1M
                         }
@@ -1641,7 +1664,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL20_2
                         }
                         PIXEL21_C
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_1M
                         }
@@ -1654,7 +1677,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 55:
                 case 23:
                     {
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL00_1L
                             PIXEL01_C
@@ -1678,7 +1701,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 182:
                 case 150:
                     {
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_C
                             PIXEL02_C
@@ -1702,7 +1725,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 213:
                 case 212:
                     {
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL02_1U
                             PIXEL12_C
@@ -1726,7 +1749,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 241:
                 case 240:
                     {
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL12_C
                             PIXEL20_1L
@@ -1750,7 +1773,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 236:
                 case 232:
                     {
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_C
                             PIXEL20_C
@@ -1774,7 +1797,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 109:
                 case 105:
                     {
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL00_1U
                             PIXEL10_C
@@ -1798,7 +1821,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 171:
                 case 43:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                             PIXEL01_C
@@ -1822,7 +1845,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 143:
                 case 15:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                             PIXEL01_C
@@ -1850,7 +1873,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL02_1U
                         PIXEL11
                         PIXEL12_C
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_C
                             PIXEL20_C
@@ -1867,7 +1890,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 203:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                             PIXEL01_C
@@ -1890,7 +1913,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 62:
                     {
                         PIXEL00_1M
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_C
                             PIXEL02_C
@@ -1917,7 +1940,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_1
                         PIXEL11
                         PIXEL20_1M
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL12_C
                             PIXEL21_C
@@ -1934,7 +1957,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 118:
                     {
                         PIXEL00_1M
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_C
                             PIXEL02_C
@@ -1961,7 +1984,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_C
                         PIXEL11
                         PIXEL20_1M
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL12_C
                             PIXEL21_C
@@ -1982,7 +2005,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL02_1R
                         PIXEL11
                         PIXEL12_1
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_C
                             PIXEL20_C
@@ -1999,7 +2022,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 155:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                             PIXEL01_C
@@ -2130,7 +2153,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL02_1U
                         PIXEL10_C
                         PIXEL11
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_1M
                         }
@@ -2138,7 +2161,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL20_2
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL12_C
                             PIXEL21_C
@@ -2154,7 +2177,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 158:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_1M
                         }
@@ -2162,7 +2185,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL00_2
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_C
                             PIXEL02_C
@@ -2183,7 +2206,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 234:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_1M
                         }
@@ -2195,7 +2218,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL02_1M
                         PIXEL11
                         PIXEL12_1
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_C
                             PIXEL20_C
@@ -2214,7 +2237,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_1M
                         PIXEL01_C
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_1M
                         }
@@ -2225,7 +2248,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_1
                         PIXEL11
                         PIXEL20_1L
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL12_C
                             PIXEL21_C
@@ -2241,7 +2264,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 59:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                             PIXEL01_C
@@ -2253,7 +2276,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL01_3
                             PIXEL10_3
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_1M
                         }
@@ -2275,7 +2298,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL02_1M
                         PIXEL11
                         PIXEL12_C
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_C
                             PIXEL20_C
@@ -2287,7 +2310,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL20_4
                             PIXEL21_3
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_1M
                         }
@@ -2300,7 +2323,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 87:
                     {
                         PIXEL00_1L
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_C
                             PIXEL02_C
@@ -2316,7 +2339,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11
                         PIXEL20_1M
                         PIXEL21_C
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_1M
                         }
@@ -2328,7 +2351,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 79:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                             PIXEL01_C
@@ -2343,7 +2366,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL02_1R
                         PIXEL11
                         PIXEL12_1
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_1M
                         }
@@ -2357,7 +2380,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 122:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_1M
                         }
@@ -2366,7 +2389,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL00_2
                         }
                         PIXEL01_C
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_1M
                         }
@@ -2376,7 +2399,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         }
                         PIXEL11
                         PIXEL12_C
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_C
                             PIXEL20_C
@@ -2388,7 +2411,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL20_4
                             PIXEL21_3
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_1M
                         }
@@ -2400,7 +2423,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 94:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_1M
                         }
@@ -2408,7 +2431,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL00_2
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_C
                             PIXEL02_C
@@ -2422,7 +2445,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         }
                         PIXEL10_C
                         PIXEL11
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_1M
                         }
@@ -2431,7 +2454,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL20_2
                         }
                         PIXEL21_C
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_1M
                         }
@@ -2443,7 +2466,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 218:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_1M
                         }
@@ -2452,7 +2475,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL00_2
                         }
                         PIXEL01_C
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_1M
                         }
@@ -2462,7 +2485,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         }
                         PIXEL10_C
                         PIXEL11
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_1M
                         }
@@ -2470,7 +2493,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         {
                             PIXEL20_2
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL12_C
                             PIXEL21_C
@@ -2486,7 +2509,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 91:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                             PIXEL01_C
@@ -2498,7 +2521,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL01_3
                             PIXEL10_3
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_1M
                         }
@@ -2508,7 +2531,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         }
                         PIXEL11
                         PIXEL12_C
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_1M
                         }
@@ -2517,7 +2540,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL20_2
                         }
                         PIXEL21_C
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_1M
                         }
@@ -2581,7 +2604,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 186:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_1M
                         }
@@ -2590,7 +2613,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL00_2
                         }
                         PIXEL01_C
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_1M
                         }
@@ -2610,7 +2633,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_1L
                         PIXEL01_C
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_1M
                         }
@@ -2623,7 +2646,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL12_C
                         PIXEL20_1L
                         PIXEL21_C
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_1M
                         }
@@ -2641,7 +2664,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_C
                         PIXEL11
                         PIXEL12_C
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_1M
                         }
@@ -2650,7 +2673,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL20_2
                         }
                         PIXEL21_C
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_1M
                         }
@@ -2662,7 +2685,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 206:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_1M
                         }
@@ -2675,7 +2698,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_C
                         PIXEL11
                         PIXEL12_1
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_1M
                         }
@@ -2696,7 +2719,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_C
                         PIXEL11
                         PIXEL12_1
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_1M
                         }
@@ -2711,7 +2734,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 174:
                 case 46:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_1M
                         }
@@ -2734,7 +2757,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_1L
                         PIXEL01_C
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_1M
                         }
@@ -2761,7 +2784,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL12_C
                         PIXEL20_1L
                         PIXEL21_C
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_1M
                         }
@@ -2800,7 +2823,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 126:
                     {
                         PIXEL00_1M
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_C
                             PIXEL02_C
@@ -2813,7 +2836,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL12_3
                         }
                         PIXEL11
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_C
                             PIXEL20_C
@@ -2830,7 +2853,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 219:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                             PIXEL01_C
@@ -2845,7 +2868,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL02_1M
                         PIXEL11
                         PIXEL20_1M
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL12_C
                             PIXEL21_C
@@ -2861,7 +2884,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 125:
                     {
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL00_1U
                             PIXEL10_C
@@ -2884,7 +2907,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 221:
                     {
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL02_1U
                             PIXEL12_C
@@ -2907,7 +2930,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 207:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                             PIXEL01_C
@@ -2930,7 +2953,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 238:
                     {
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_C
                             PIXEL20_C
@@ -2953,7 +2976,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 190:
                     {
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_C
                             PIXEL02_C
@@ -2976,7 +2999,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 187:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                             PIXEL01_C
@@ -2999,7 +3022,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 243:
                     {
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL12_C
                             PIXEL20_1L
@@ -3022,7 +3045,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 119:
                     {
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL00_1L
                             PIXEL01_C
@@ -3052,7 +3075,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_C
                         PIXEL11
                         PIXEL12_1
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_C
                         }
@@ -3067,7 +3090,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 175:
                 case 47:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                         }
@@ -3090,7 +3113,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_1L
                         PIXEL01_C
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_C
                         }
@@ -3117,7 +3140,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL12_C
                         PIXEL20_1L
                         PIXEL21_C
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_C
                         }
@@ -3133,7 +3156,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL01_C
                         PIXEL02_1M
                         PIXEL11
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_C
                             PIXEL20_C
@@ -3144,7 +3167,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL20_4
                         }
                         PIXEL21_C
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL12_C
                             PIXEL22_C
@@ -3158,7 +3181,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 123:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                             PIXEL01_C
@@ -3172,7 +3195,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_C
                         PIXEL11
                         PIXEL12_C
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_C
                             PIXEL21_C
@@ -3187,7 +3210,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 95:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                             PIXEL10_C
@@ -3198,7 +3221,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL10_3
                         }
                         PIXEL01_C
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_C
                             PIXEL12_C
@@ -3217,7 +3240,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 222:
                     {
                         PIXEL00_1M
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_C
                             PIXEL02_C
@@ -3231,7 +3254,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11
                         PIXEL12_C
                         PIXEL20_1M
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL21_C
                             PIXEL22_C
@@ -3250,7 +3273,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL02_1U
                         PIXEL11
                         PIXEL12_C
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_C
                             PIXEL20_C
@@ -3261,7 +3284,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL20_4
                         }
                         PIXEL21_C
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_C
                         }
@@ -3278,7 +3301,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL02_1M
                         PIXEL10_C
                         PIXEL11
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_C
                         }
@@ -3287,7 +3310,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL20_2
                         }
                         PIXEL21_C
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL12_C
                             PIXEL22_C
@@ -3301,7 +3324,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 235:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                             PIXEL01_C
@@ -3315,7 +3338,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_C
                         PIXEL11
                         PIXEL12_1
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_C
                         }
@@ -3329,7 +3352,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 111:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                         }
@@ -3342,7 +3365,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_C
                         PIXEL11
                         PIXEL12_1
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_C
                             PIXEL21_C
@@ -3357,7 +3380,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 63:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                         }
@@ -3366,7 +3389,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL00_2
                         }
                         PIXEL01_C
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_C
                             PIXEL12_C
@@ -3385,7 +3408,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 159:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                             PIXEL10_C
@@ -3396,7 +3419,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL10_3
                         }
                         PIXEL01_C
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_C
                         }
@@ -3415,7 +3438,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_1L
                         PIXEL01_C
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_C
                         }
@@ -3427,7 +3450,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11
                         PIXEL12_C
                         PIXEL20_1M
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL21_C
                             PIXEL22_C
@@ -3442,7 +3465,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 246:
                     {
                         PIXEL00_1M
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_C
                             PIXEL02_C
@@ -3457,7 +3480,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL12_C
                         PIXEL20_1L
                         PIXEL21_C
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_C
                         }
@@ -3470,7 +3493,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 254:
                     {
                         PIXEL00_1M
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_C
                             PIXEL02_C
@@ -3481,7 +3504,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL02_4
                         }
                         PIXEL11
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_C
                             PIXEL20_C
@@ -3491,7 +3514,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL10_3
                             PIXEL20_4
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL12_C
                             PIXEL21_C
@@ -3513,7 +3536,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_C
                         PIXEL11
                         PIXEL12_C
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_C
                         }
@@ -3522,7 +3545,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL20_2
                         }
                         PIXEL21_C
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_C
                         }
@@ -3534,7 +3557,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 251:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                             PIXEL01_C
@@ -3546,7 +3569,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         }
                         PIXEL02_1M
                         PIXEL11
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL10_C
                             PIXEL20_C
@@ -3558,7 +3581,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL20_2
                             PIXEL21_3
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL12_C
                             PIXEL22_C
@@ -3572,7 +3595,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 239:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                         }
@@ -3585,7 +3608,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_C
                         PIXEL11
                         PIXEL12_1
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_C
                         }
@@ -3599,7 +3622,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 127:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                             PIXEL01_C
@@ -3611,7 +3634,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL01_3
                             PIXEL10_3
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_C
                             PIXEL12_C
@@ -3622,7 +3645,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL12_3
                         }
                         PIXEL11
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_C
                             PIXEL21_C
@@ -3637,7 +3660,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 191:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                         }
@@ -3646,7 +3669,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL00_2
                         }
                         PIXEL01_C
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_C
                         }
@@ -3664,7 +3687,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 223:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                             PIXEL10_C
@@ -3674,7 +3697,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL00_4
                             PIXEL10_3
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL01_C
                             PIXEL02_C
@@ -3688,7 +3711,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         }
                         PIXEL11
                         PIXEL20_1M
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL21_C
                             PIXEL22_C
@@ -3704,7 +3727,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_1L
                         PIXEL01_C
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_C
                         }
@@ -3717,7 +3740,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL12_C
                         PIXEL20_1L
                         PIXEL21_C
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_C
                         }
@@ -3729,7 +3752,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 255:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_C
                         }
@@ -3738,7 +3761,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL00_2
                         }
                         PIXEL01_C
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_C
                         }
@@ -3749,7 +3772,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_C
                         PIXEL11
                         PIXEL12_C
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_C
                         }
@@ -3758,7 +3781,7 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL20_2
                         }
                         PIXEL21_C
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_C
                         }
@@ -3770,17 +3793,40 @@ void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
             }
             sp++;
+            yp++;
             dp += 3;
         }
 
         sRowP += srb;
-        sp = (uint32_t *) sRowP;
+        sp = (const uint32_t *) sRowP;
+
+        yRowP += ypL;
+        yp = yRowP;
 
         dRowP += drb * 3;
         dp = (uint32_t *) dRowP;
     }
 }
 
+void HQX_CALLCONV hq3x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres, int yFirst, int yLast )
+{
+    //Only rows [yFirst, yLast) are processed - the source/destination pointers always point to the full image
+    if (!hqx_clamp_rows(yFirst, yLast, Yres)) return;
+
+    const uint32_t *yp = hqx_yuv_rows(sp, srb, Xres, Yres, yFirst, yLast);
+    hq3x_body((const uint32_t *)((const uint8_t *)sp + (size_t)yFirst * srb), srb, yp, Xres,
+        (uint32_t *)((uint8_t *)dp + (size_t)yFirst * drb * 3), drb, Xres, Yres, yFirst, yLast, hqx_yuv_diff());
+}
+
+void HQX_CALLCONV hq3x_indexed_rb( const uint16_t * src, int srcPitch, const uint32_t * palette, const uint8_t * diffTable, int paletteSize, uint32_t * dp, uint32_t drb, int Xres, int Yres, int yFirst, int yLast )
+{
+    if (!hqx_clamp_rows(yFirst, yLast, Yres)) return;
+
+    const uint32_t *colors = hqx_palette_rows(src, srcPitch, palette, Xres, Yres, yFirst, yLast);
+    hq3x_body(colors, Xres * 4, src + (size_t)yFirst * srcPitch, srcPitch,
+        (uint32_t *)((uint8_t *)dp + (size_t)yFirst * drb * 3), drb, Xres, Yres, yFirst, yLast, hqx_table_diff(diffTable, paletteSize));
+}
+
 void HQX_CALLCONV hq3x_32( uint32_t * sp, uint32_t * dp, int Xres, int Yres )
 {
     uint32_t rowBytesL = Xres * 4;
@@ -164,16 +164,22 @@
 #define PIXEL33_81    *(dp+dpL+dpL+dpL+3) = Interp8(w[5], w[6]);
 #define PIXEL33_82    *(dp+dpL+dpL+dpL+3) = Interp8(w[5], w[8]);
 
-void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres )
+//Shared by the 32-bit and indexed versions: sp/yp/dp point to row yFirst of the source, key and destination images
+//Keys are compared with diff() to detect different colors (YUV values for 32-bit input, palette indexes for indexed input)
+template<typename Key, typename Diff>
+static void hq4x_body( const uint32_t * sp, uint32_t srb, const Key * yp, int ypL, uint32_t * dp, uint32_t drb, int Xres, int Yres, int yFirst, int yLast, Diff diff )
 {
     int  i, j, k;
     int  prevline, nextline;
     uint32_t w[10];
     int dpL = (drb >> 2);
     int spL = (srb >> 2);
-    uint8_t *sRowP = (uint8_t *) sp;
+    const uint8_t *sRowP = (const uint8_t *) sp;
     uint8_t *dRowP = (uint8_t *) dp;
+    const Key *yRowP = yp;
     uint32_t yuv1, yuv2;
+    uint32_t  y[10];
+    int  prevYuvLine, nextYuvLine;
 
     //   +----+----+----+
     //   |    |    |    |
@@ -186,28 +192,39 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
     //   | w7 | w8 | w9 |
     //   +----+----+----+
 
-    for (j=0; j<Yres; j++)
+    for (j=yFirst; j<yLast; j++)
     {
         if (j>0)      prevline = -spL; else prevline = 0;
         if (j<Yres-1) nextline =  spL; else nextline = 0;
+        prevYuvLine = prevline ? -ypL : 0;
+        nextYuvLine = nextline ? ypL : 0;
 
         for (i=0; i<Xres; i++)
         {
             w[2] = *(sp + prevline);
             w[5] = *sp;
             w[8] = *(sp + nextline);
+            y[2] = *(yp + prevYuvLine);
+            y[5] = *yp;
+            y[8] = *(yp + nextYuvLine);
 
             if (i>0)
             {
                 w[1] = *(sp + prevline - 1);
                 w[4] = *(sp - 1);
                 w[7] = *(sp + nextline - 1);
+                y[1] = *(yp + prevYuvLine - 1);
+                y[4] = *(yp - 1);
+                y[7] = *(yp + nextYuvLine - 1);
             }
             else
             {
                 w[1] = w[2];
                 w[4] = w[5];
                 w[7] = w[8];
+                y[1] = y[2];
+                y[4] = y[5];
+                y[7] = y[8];
             }
 
             if (i<Xres-1)
@@ -215,18 +232,24 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 w[3] = *(sp + prevline + 1);
                 w[6] = *(sp + 1);
                 w[9] = *(sp + nextline + 1);
+                y[3] = *(yp + prevYuvLine + 1);
+                y[6] = *(yp + 1);
+                y[9] = *(yp + nextYuvLine + 1);
             }
             else
             {
                 w[3] = w[2];
                 w[6] = w[5];
                 w[9] = w[8];
+                y[3] = y[2];
+                y[6] = y[5];
+                y[9] = y[8];
             }
 
             int pattern = 0;
             int flag = 1;
 
-            yuv1 = rgb_to_yuv(w[5]);
+            yuv1 = y[5];
 
             for (k=1; k<=9; k++)
             {
@@ -234,8 +257,8 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
 
                 if ( w[k] != w[5] )
                 {
-                    yuv2 = rgb_to_yuv(w[k]);
-                    if (yuv_diff(yuv1, yuv2))
+                    yuv2 = y[k];
+                    if (diff(yuv1, yuv2))
                         pattern |= flag;
                 }
                 flag <<= 1;
@@ -559,7 +582,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_80
                         PIXEL01_10
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_10
                             PIXEL03_80
@@ -598,7 +621,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL13_10
                         PIXEL20_61
                         PIXEL21_30
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_30
                             PIXEL23_10
@@ -627,7 +650,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11_30
                         PIXEL12_70
                         PIXEL13_60
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_10
                             PIXEL21_30
@@ -650,7 +673,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 10:
                 case 138:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_80
                             PIXEL01_10
@@ -811,7 +834,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_80
                         PIXEL01_10
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_0
                             PIXEL03_0
@@ -850,7 +873,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL20_61
                         PIXEL21_30
                         PIXEL22_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL23_0
                             PIXEL32_0
@@ -877,7 +900,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11_30
                         PIXEL12_70
                         PIXEL13_60
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_0
                             PIXEL30_0
@@ -899,7 +922,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 11:
                 case 139:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                             PIXEL01_0
@@ -929,7 +952,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 19:
                 case 51:
                     {
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL00_81
                             PIXEL01_31
@@ -964,7 +987,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_80
                         PIXEL01_10
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_10
                             PIXEL03_80
@@ -998,7 +1021,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL00_20
                         PIXEL01_60
                         PIXEL02_81
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL03_81
                             PIXEL13_31
@@ -1038,7 +1061,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL13_10
                         PIXEL20_82
                         PIXEL21_32
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_30
                             PIXEL23_10
@@ -1069,7 +1092,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11_30
                         PIXEL12_70
                         PIXEL13_60
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_10
                             PIXEL21_30
@@ -1094,7 +1117,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 73:
                 case 77:
                     {
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL00_82
                             PIXEL10_32
@@ -1127,7 +1150,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 42:
                 case 170:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_80
                             PIXEL01_10
@@ -1160,7 +1183,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 14:
                 case 142:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_80
                             PIXEL01_10
@@ -1353,7 +1376,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 26:
                 case 31:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                             PIXEL01_0
@@ -1365,7 +1388,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL01_50
                             PIXEL10_50
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_0
                             PIXEL03_0
@@ -1394,7 +1417,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_80
                         PIXEL01_10
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_0
                             PIXEL03_0
@@ -1412,7 +1435,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL20_61
                         PIXEL21_30
                         PIXEL22_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL23_0
                             PIXEL32_0
@@ -1439,7 +1462,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11_30
                         PIXEL12_30
                         PIXEL13_10
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_0
                             PIXEL30_0
@@ -1453,7 +1476,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         }
                         PIXEL21_0
                         PIXEL22_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL23_0
                             PIXEL32_0
@@ -1470,7 +1493,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 74:
                 case 107:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                             PIXEL01_0
@@ -1487,7 +1510,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11_0
                         PIXEL12_30
                         PIXEL13_61
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_0
                             PIXEL30_0
@@ -1508,7 +1531,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 27:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                             PIXEL01_0
@@ -1539,7 +1562,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_80
                         PIXEL01_10
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_0
                             PIXEL03_0
@@ -1577,7 +1600,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL20_10
                         PIXEL21_30
                         PIXEL22_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL23_0
                             PIXEL32_0
@@ -1603,7 +1626,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11_30
                         PIXEL12_30
                         PIXEL13_61
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_0
                             PIXEL30_0
@@ -1626,7 +1649,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_80
                         PIXEL01_10
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_0
                             PIXEL03_0
@@ -1664,7 +1687,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL20_61
                         PIXEL21_30
                         PIXEL22_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL23_0
                             PIXEL32_0
@@ -1690,7 +1713,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11_30
                         PIXEL12_30
                         PIXEL13_10
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_0
                             PIXEL30_0
@@ -1711,7 +1734,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 75:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                             PIXEL01_0
@@ -1980,7 +2003,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 58:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_80
                             PIXEL01_10
@@ -1994,7 +2017,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL10_11
                             PIXEL11_0
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_10
                             PIXEL03_80
@@ -2022,7 +2045,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_81
                         PIXEL01_31
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_10
                             PIXEL03_80
@@ -2040,7 +2063,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11_31
                         PIXEL20_61
                         PIXEL21_30
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_30
                             PIXEL23_10
@@ -2068,7 +2091,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11_30
                         PIXEL12_31
                         PIXEL13_31
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_10
                             PIXEL21_30
@@ -2082,7 +2105,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL30_20
                             PIXEL31_11
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_30
                             PIXEL23_10
@@ -2100,7 +2123,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 202:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_80
                             PIXEL01_10
@@ -2118,7 +2141,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL03_80
                         PIXEL12_30
                         PIXEL13_61
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_10
                             PIXEL21_30
@@ -2140,7 +2163,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 78:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_80
                             PIXEL01_10
@@ -2158,7 +2181,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL03_82
                         PIXEL12_32
                         PIXEL13_82
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_10
                             PIXEL21_30
@@ -2180,7 +2203,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 154:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_80
                             PIXEL01_10
@@ -2194,7 +2217,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL10_11
                             PIXEL11_0
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_10
                             PIXEL03_80
@@ -2222,7 +2245,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_80
                         PIXEL01_10
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_10
                             PIXEL03_80
@@ -2240,7 +2263,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11_30
                         PIXEL20_82
                         PIXEL21_32
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_30
                             PIXEL23_10
@@ -2268,7 +2291,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11_32
                         PIXEL12_30
                         PIXEL13_10
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_10
                             PIXEL21_30
@@ -2282,7 +2305,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL30_20
                             PIXEL31_11
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_30
                             PIXEL23_10
@@ -2300,7 +2323,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 90:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_80
                             PIXEL01_10
@@ -2314,7 +2337,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL10_11
                             PIXEL11_0
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_10
                             PIXEL03_80
@@ -2328,7 +2351,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL12_0
                             PIXEL13_12
                         }
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_10
                             PIXEL21_30
@@ -2342,7 +2365,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL30_20
                             PIXEL31_11
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_30
                             PIXEL23_10
@@ -2361,7 +2384,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 55:
                 case 23:
                     {
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL00_81
                             PIXEL01_31
@@ -2396,7 +2419,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_80
                         PIXEL01_10
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_0
                             PIXEL03_0
@@ -2430,7 +2453,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL00_20
                         PIXEL01_60
                         PIXEL02_81
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL03_81
                             PIXEL13_31
@@ -2470,7 +2493,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL13_10
                         PIXEL20_82
                         PIXEL21_32
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_0
                             PIXEL23_0
@@ -2501,7 +2524,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11_30
                         PIXEL12_70
                         PIXEL13_60
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_0
                             PIXEL21_0
@@ -2526,7 +2549,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 109:
                 case 105:
                     {
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL00_82
                             PIXEL10_32
@@ -2559,7 +2582,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 171:
                 case 43:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                             PIXEL01_0
@@ -2592,7 +2615,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 143:
                 case 15:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                             PIXEL01_0
@@ -2632,7 +2655,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11_30
                         PIXEL12_31
                         PIXEL13_31
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_0
                             PIXEL30_0
@@ -2653,7 +2676,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 203:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                             PIXEL01_0
@@ -2684,7 +2707,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_80
                         PIXEL01_10
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_0
                             PIXEL03_0
@@ -2722,7 +2745,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL20_61
                         PIXEL21_30
                         PIXEL22_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL23_0
                             PIXEL32_0
@@ -2742,7 +2765,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_80
                         PIXEL01_10
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_0
                             PIXEL03_0
@@ -2780,7 +2803,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL20_10
                         PIXEL21_30
                         PIXEL22_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL23_0
                             PIXEL32_0
@@ -2806,7 +2829,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11_30
                         PIXEL12_32
                         PIXEL13_82
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_0
                             PIXEL30_0
@@ -2827,7 +2850,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 155:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                             PIXEL01_0
@@ -3024,7 +3047,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11_30
                         PIXEL12_31
                         PIXEL13_31
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_10
                             PIXEL21_30
@@ -3039,7 +3062,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL31_11
                         }
                         PIXEL22_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL23_0
                             PIXEL32_0
@@ -3055,7 +3078,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 158:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_80
                             PIXEL01_10
@@ -3069,7 +3092,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL10_11
                             PIXEL11_0
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_0
                             PIXEL03_0
@@ -3094,7 +3117,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 234:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_80
                             PIXEL01_10
@@ -3112,7 +3135,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL03_80
                         PIXEL12_30
                         PIXEL13_61
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_0
                             PIXEL30_0
@@ -3135,7 +3158,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_80
                         PIXEL01_10
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_10
                             PIXEL03_80
@@ -3154,7 +3177,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL20_82
                         PIXEL21_32
                         PIXEL22_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL23_0
                             PIXEL32_0
@@ -3172,7 +3195,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 59:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                             PIXEL01_0
@@ -3184,7 +3207,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL01_50
                             PIXEL10_50
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_10
                             PIXEL03_80
@@ -3219,7 +3242,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11_32
                         PIXEL12_30
                         PIXEL13_10
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_0
                             PIXEL30_0
@@ -3232,7 +3255,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL31_50
                         }
                         PIXEL21_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_30
                             PIXEL23_10
@@ -3252,7 +3275,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_81
                         PIXEL01_31
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_0
                             PIXEL03_0
@@ -3269,7 +3292,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL12_0
                         PIXEL20_61
                         PIXEL21_30
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_30
                             PIXEL23_10
@@ -3289,7 +3312,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 79:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                             PIXEL01_0
@@ -3306,7 +3329,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11_0
                         PIXEL12_32
                         PIXEL13_82
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_10
                             PIXEL21_30
@@ -3328,7 +3351,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 122:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_80
                             PIXEL01_10
@@ -3342,7 +3365,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL10_11
                             PIXEL11_0
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_10
                             PIXEL03_80
@@ -3356,7 +3379,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL12_0
                             PIXEL13_12
                         }
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_0
                             PIXEL30_0
@@ -3369,7 +3392,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL31_50
                         }
                         PIXEL21_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_30
                             PIXEL23_10
@@ -3387,7 +3410,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 94:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_80
                             PIXEL01_10
@@ -3401,7 +3424,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL10_11
                             PIXEL11_0
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_0
                             PIXEL03_0
@@ -3414,7 +3437,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL13_50
                         }
                         PIXEL12_0
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_10
                             PIXEL21_30
@@ -3428,7 +3451,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL30_20
                             PIXEL31_11
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_30
                             PIXEL23_10
@@ -3446,7 +3469,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 218:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_80
                             PIXEL01_10
@@ -3460,7 +3483,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL10_11
                             PIXEL11_0
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_10
                             PIXEL03_80
@@ -3474,7 +3497,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL12_0
                             PIXEL13_12
                         }
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_10
                             PIXEL21_30
@@ -3489,7 +3512,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL31_11
                         }
                         PIXEL22_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL23_0
                             PIXEL32_0
@@ -3505,7 +3528,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 91:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                             PIXEL01_0
@@ -3517,7 +3540,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL01_50
                             PIXEL10_50
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_10
                             PIXEL03_80
@@ -3532,7 +3555,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL13_12
                         }
                         PIXEL11_0
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_10
                             PIXEL21_30
@@ -3546,7 +3569,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL30_20
                             PIXEL31_11
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_30
                             PIXEL23_10
@@ -3644,7 +3667,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 186:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_80
                             PIXEL01_10
@@ -3658,7 +3681,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL10_11
                             PIXEL11_0
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_10
                             PIXEL03_80
@@ -3686,7 +3709,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_81
                         PIXEL01_31
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_10
                             PIXEL03_80
@@ -3704,7 +3727,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11_31
                         PIXEL20_82
                         PIXEL21_32
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_30
                             PIXEL23_10
@@ -3732,7 +3755,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11_32
                         PIXEL12_31
                         PIXEL13_31
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_10
                             PIXEL21_30
@@ -3746,7 +3769,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL30_20
                             PIXEL31_11
                         }
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_30
                             PIXEL23_10
@@ -3764,7 +3787,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 206:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_80
                             PIXEL01_10
@@ -3782,7 +3805,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL03_82
                         PIXEL12_32
                         PIXEL13_82
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_10
                             PIXEL21_30
@@ -3813,7 +3836,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11_32
                         PIXEL12_70
                         PIXEL13_60
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_10
                             PIXEL21_30
@@ -3836,7 +3859,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 174:
                 case 46:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_80
                             PIXEL01_10
@@ -3869,7 +3892,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_81
                         PIXEL01_31
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_10
                             PIXEL03_80
@@ -3908,7 +3931,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL13_31
                         PIXEL20_82
                         PIXEL21_32
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_30
                             PIXEL23_10
@@ -3970,7 +3993,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_80
                         PIXEL01_10
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_0
                             PIXEL03_0
@@ -3985,7 +4008,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_10
                         PIXEL11_30
                         PIXEL12_0
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_0
                             PIXEL30_0
@@ -4006,7 +4029,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 219:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                             PIXEL01_0
@@ -4026,7 +4049,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL20_10
                         PIXEL21_30
                         PIXEL22_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL23_0
                             PIXEL32_0
@@ -4044,7 +4067,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 125:
                     {
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL00_82
                             PIXEL10_32
@@ -4079,7 +4102,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL00_82
                         PIXEL01_82
                         PIXEL02_81
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL03_81
                             PIXEL13_31
@@ -4108,7 +4131,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 207:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                             PIXEL01_0
@@ -4148,7 +4171,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11_30
                         PIXEL12_32
                         PIXEL13_82
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_0
                             PIXEL21_0
@@ -4174,7 +4197,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_80
                         PIXEL01_10
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_0
                             PIXEL03_0
@@ -4204,7 +4227,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 187:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                             PIXEL01_0
@@ -4246,7 +4269,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL13_10
                         PIXEL20_82
                         PIXEL21_32
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL22_0
                             PIXEL23_0
@@ -4268,7 +4291,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 119:
                     {
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL00_81
                             PIXEL01_31
@@ -4313,7 +4336,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL21_0
                         PIXEL22_31
                         PIXEL23_81
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL30_0
                         }
@@ -4329,7 +4352,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                 case 175:
                 case 47:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -4360,7 +4383,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL00_81
                         PIXEL01_31
                         PIXEL02_0
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL03_0
                         }
@@ -4400,7 +4423,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL30_82
                         PIXEL31_32
                         PIXEL32_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL33_0
                         }
@@ -4420,7 +4443,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11_30
                         PIXEL12_30
                         PIXEL13_10
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_0
                             PIXEL30_0
@@ -4434,7 +4457,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         }
                         PIXEL21_0
                         PIXEL22_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL23_0
                             PIXEL32_0
@@ -4450,7 +4473,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 123:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                             PIXEL01_0
@@ -4467,7 +4490,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11_0
                         PIXEL12_30
                         PIXEL13_10
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_0
                             PIXEL30_0
@@ -4488,7 +4511,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 95:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                             PIXEL01_0
@@ -4500,7 +4523,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL01_50
                             PIXEL10_50
                         }
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_0
                             PIXEL03_0
@@ -4528,7 +4551,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_80
                         PIXEL01_10
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_0
                             PIXEL03_0
@@ -4546,7 +4569,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL20_10
                         PIXEL21_30
                         PIXEL22_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL23_0
                             PIXEL32_0
@@ -4572,7 +4595,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11_30
                         PIXEL12_31
                         PIXEL13_31
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_0
                             PIXEL30_0
@@ -4588,7 +4611,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL22_0
                         PIXEL23_0
                         PIXEL32_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL33_0
                         }
@@ -4611,7 +4634,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL20_0
                         PIXEL21_0
                         PIXEL22_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL23_0
                             PIXEL32_0
@@ -4623,7 +4646,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL32_50
                             PIXEL33_50
                         }
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL30_0
                         }
@@ -4636,7 +4659,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 235:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                             PIXEL01_0
@@ -4657,7 +4680,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL21_0
                         PIXEL22_31
                         PIXEL23_81
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL30_0
                         }
@@ -4672,7 +4695,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 111:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -4687,7 +4710,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL11_0
                         PIXEL12_32
                         PIXEL13_82
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_0
                             PIXEL30_0
@@ -4708,7 +4731,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 63:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -4717,7 +4740,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL00_20
                         }
                         PIXEL01_0
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_0
                             PIXEL03_0
@@ -4744,7 +4767,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 159:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                             PIXEL01_0
@@ -4757,7 +4780,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL10_50
                         }
                         PIXEL02_0
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL03_0
                         }
@@ -4783,7 +4806,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL00_81
                         PIXEL01_31
                         PIXEL02_0
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL03_0
                         }
@@ -4798,7 +4821,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL20_61
                         PIXEL21_30
                         PIXEL22_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL23_0
                             PIXEL32_0
@@ -4818,7 +4841,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_80
                         PIXEL01_10
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_0
                             PIXEL03_0
@@ -4840,7 +4863,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL30_82
                         PIXEL31_32
                         PIXEL32_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL33_0
                         }
@@ -4854,7 +4877,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     {
                         PIXEL00_80
                         PIXEL01_10
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_0
                             PIXEL03_0
@@ -4869,7 +4892,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_10
                         PIXEL11_30
                         PIXEL12_0
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_0
                             PIXEL30_0
@@ -4885,7 +4908,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL22_0
                         PIXEL23_0
                         PIXEL32_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL33_0
                         }
@@ -4909,7 +4932,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL21_0
                         PIXEL22_0
                         PIXEL23_0
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL30_0
                         }
@@ -4919,7 +4942,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         }
                         PIXEL31_0
                         PIXEL32_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL33_0
                         }
@@ -4931,7 +4954,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 251:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                             PIXEL01_0
@@ -4951,7 +4974,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL20_0
                         PIXEL21_0
                         PIXEL22_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL23_0
                             PIXEL32_0
@@ -4963,7 +4986,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL32_50
                             PIXEL33_50
                         }
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL30_0
                         }
@@ -4976,7 +4999,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 239:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -4995,7 +5018,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL21_0
                         PIXEL22_31
                         PIXEL23_81
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL30_0
                         }
@@ -5010,7 +5033,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 127:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -5019,7 +5042,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL00_20
                         }
                         PIXEL01_0
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL02_0
                             PIXEL03_0
@@ -5034,7 +5057,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL10_0
                         PIXEL11_0
                         PIXEL12_0
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL20_0
                             PIXEL30_0
@@ -5055,7 +5078,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 191:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -5065,7 +5088,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         }
                         PIXEL01_0
                         PIXEL02_0
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL03_0
                         }
@@ -5089,7 +5112,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 223:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                             PIXEL01_0
@@ -5102,7 +5125,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                             PIXEL10_50
                         }
                         PIXEL02_0
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL03_0
                         }
@@ -5116,7 +5139,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL20_10
                         PIXEL21_30
                         PIXEL22_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL23_0
                             PIXEL32_0
@@ -5137,7 +5160,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL00_81
                         PIXEL01_31
                         PIXEL02_0
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL03_0
                         }
@@ -5156,7 +5179,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL30_82
                         PIXEL31_32
                         PIXEL32_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL33_0
                         }
@@ -5168,7 +5191,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
                 case 255:
                     {
-                        if (Diff(w[4], w[2]))
+                        if (diff(y[4], y[2]))
                         {
                             PIXEL00_0
                         }
@@ -5178,7 +5201,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         }
                         PIXEL01_0
                         PIXEL02_0
-                        if (Diff(w[2], w[6]))
+                        if (diff(y[2], y[6]))
                         {
                             PIXEL03_0
                         }
@@ -5194,7 +5217,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         PIXEL21_0
                         PIXEL22_0
                         PIXEL23_0
-                        if (Diff(w[8], w[4]))
+                        if (diff(y[8], y[4]))
                         {
                             PIXEL30_0
                         }
@@ -5204,7 +5227,7 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                         }
                         PIXEL31_0
                         PIXEL32_0
-                        if (Diff(w[6], w[8]))
+                        if (diff(y[6], y[8]))
                         {
                             PIXEL33_0
                         }
@@ -5216,17 +5239,40 @@ void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32
                     }
             }
             sp++;
+            yp++;
             dp += 4;
         }
 
         sRowP += srb;
-        sp = (uint32_t *) sRowP;
+        sp = (const uint32_t *) sRowP;
+
+        yRowP += ypL;
+        yp = yRowP;
 
         dRowP += drb * 4;
         dp = (uint32_t *) dRowP;
     }
 }
 
+void HQX_CALLCONV hq4x_32_rb( uint32_t * sp, uint32_t srb, uint32_t * dp, uint32_t drb, int Xres, int Yres, int yFirst, int yLast )
+{
+    //Only rows [yFirst, yLast) are processed - the source/destination pointers always point to the full image
+    if (!hqx_clamp_rows(yFirst, yLast, Yres)) return;
+
+    const uint32_t *yp = hqx_yuv_rows(sp, srb, Xres, Yres, yFirst, yLast);
+    hq4x_body((const uint32_t *)((const uint8_t *)sp + (size_t)yFirst * srb), srb, yp, Xres,
+        (uint32_t *)((uint8_t *)dp + (size_t)yFirst * drb * 4), drb, Xres, Yres, yFirst, yLast, hqx_yuv_diff());
+}
+
+void HQX_CALLCONV hq4x_indexed_rb( const uint16_t * src, int srcPitch, const uint32_t * palette, const uint8_t * diffTable, int paletteSize, uint32_t * dp, uint32_t drb, int Xres, int Yres, int yFirst, int yLast )
+{
+    if (!hqx_clamp_rows(yFirst, yLast, Yres)) return;
+
+    const uint32_t *colors = hqx_palette_rows(src, srcPitch, palette, Xres, Yres, yFirst, yLast);
+    hq4x_body(colors, Xres * 4, src + (size_t)yFirst * srcPitch, srcPitch,
+        (uint32_t *)((uint8_t *)dp + (size_t)yFirst * drb * 4), drb, Xres, Yres, yFirst, yLast, hqx_table_diff(diffTable, paletteSize));
+}
+
 void HQX_CALLCONV hq4x_32( uint32_t * sp, uint32_t * dp, int Xres, int Yres )
 {
     uint32_t rowBytesL = Xres * 4;
@@ -22,6 +22,7 @@
 #define __HQX_H_
 
 #include <stdint.h>
+#include <limits.h>
 
 #if defined( __GNUC__ )
     #ifdef __MINGW32__
@@ -50,8 +51,17 @@ void HQX_CALLCONV hq2x_32( uint32_t * src, uint32_t * dest, int width, int heigh
 void HQX_CALLCONV hq3x_32( uint32_t * src, uint32_t * dest, int width, int height );
 void HQX_CALLCONV hq4x_32( uint32_t * src, uint32_t * dest, int width, int height );
 
-void HQX_CALLCONV hq2x_32_rb( uint32_t * src, uint32_t src_rowBytes, uint32_t * dest, uint32_t dest_rowBytes, int width, int height );
-void HQX_CALLCONV hq3x_32_rb( uint32_t * src, uint32_t src_rowBytes, uint32_t * dest, uint32_t dest_rowBytes, int width, int height );
-void HQX_CALLCONV hq4x_32_rb( uint32_t * src, uint32_t src_rowBytes, uint32_t * dest, uint32_t dest_rowBytes, int width, int height );
+/* The _rb variants can process a slice of rows [yFirst, yLast) of the source image (e.g to split a frame between multiple threads) */
+void HQX_CALLCONV hq2x_32_rb( uint32_t * src, uint32_t src_rowBytes, uint32_t * dest, uint32_t dest_rowBytes, int width, int height, int yFirst = 0, int yLast = INT_MAX );
+void HQX_CALLCONV hq3x_32_rb( uint32_t * src, uint32_t src_rowBytes, uint32_t * dest, uint32_t dest_rowBytes, int width, int height, int yFirst = 0, int yLast = INT_MAX );
+void HQX_CALLCONV hq4x_32_rb( uint32_t * src, uint32_t src_rowBytes, uint32_t * dest, uint32_t dest_rowBytes, int width, int height, int yFirst = 0, int yLast = INT_MAX );
+
+/* Indexed input (e.g the PPU's palette indexes): src contains srcPitch indexes per row, which are converted to colors with palette.
+   diffTable is the paletteSize*paletteSize table built by hqx_build_diff_table for the palette - the result is identical
+   to calling the _32_rb variants with the palette's colors, but the YUV conversion/comparisons are replaced by table lookups */
+void HQX_CALLCONV hqx_build_diff_table( const uint32_t * palette, int paletteSize, uint8_t * diffTable );
+void HQX_CALLCONV hq2x_indexed_rb( const uint16_t * src, int srcPitch, const uint32_t * palette, const uint8_t * diffTable, int paletteSize, uint32_t * dest, uint32_t dest_rowBytes, int width, int height, int yFirst = 0, int yLast = INT_MAX );
+void HQX_CALLCONV hq3x_indexed_rb( const uint16_t * src, int srcPitch, const uint32_t * palette, const uint8_t * diffTable, int paletteSize, uint32_t * dest, uint32_t dest_rowBytes, int width, int height, int yFirst = 0, int yLast = INT_MAX );
+void HQX_CALLCONV hq4x_indexed_rb( const uint16_t * src, int srcPitch, const uint32_t * palette, const uint8_t * diffTable, int paletteSize, uint32_t * dest, uint32_t dest_rowBytes, int width, int height, int yFirst = 0, int yLast = INT_MAX );
 
 #endif
@@ -18,24 +18,12 @@
 
 #include "../pch.h"
 #include <stdint.h>
+#include "common.h"
 #include "hqx.h"
 
-uint32_t   RGBtoYUV[16777216];
-uint32_t   YUV1, YUV2;
-
 void HQX_CALLCONV hqxInit(void)
 {
-    /* Initalize RGB to YUV lookup table */
-    uint32_t c, r, g, b, y, u, v;
-    for (c = 0; c < 16777215; c++) {
-        r = (c & 0xFF0000) >> 16;
-        g = (c & 0x00FF00) >> 8;
-        b = c & 0x0000FF;
-        y = (uint32_t)(0.299*r + 0.587*g + 0.114*b);
-        u = (uint32_t)(-0.169*r - 0.331*g + 0.5*b) + 128;
-        v = (uint32_t)(0.5*r - 0.419*g - 0.081*b) + 128;
-        RGBtoYUV[c] = (y << 16) + (u << 8) + v;
-    }
+    /* Nothing to do - YUV values are now computed as needed, rather than using a 64MB lookup table */
 }
 
 void HQX_CALLCONV hqx(uint32_t scale, uint32_t * src, uint32_t * dest, int width, int height)
@@ -45,4 +33,18 @@ void HQX_CALLCONV hqx(uint32_t scale, uint32_t * src, uint32_t * dest, int width
 		case 3: hq3x_32(src, dest, width, height); break;
 		case 4: hq4x_32(src, dest, width, height); break;
 	}
-}
\ No newline at end of file
+}
+
+void HQX_CALLCONV hqx_build_diff_table(const uint32_t * palette, int paletteSize, uint8_t * diffTable)
+{
+	std::vector<uint32_t> yuv(paletteSize);
+	for(int i = 0; i < paletteSize; i++) {
+		yuv[i] = rgb_to_yuv(palette[i]);
+	}
+
+	for(int i = 0; i < paletteSize; i++) {
+		for(int j = 0; j < paletteSize; j++) {
+			diffTable[i * paletteSize + j] = (uint8_t)yuv_diff(yuv[i], yuv[j]);
+		}
+	}
+}
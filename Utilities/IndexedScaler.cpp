@@ -0,0 +1,58 @@
+#include "pch.h"
+#include <cstring>
+#include "IndexedScaler.h"
+#include "ParallelScaler.h"
+#include "HQX/hqx.h"
+
+IndexedScaler::IndexedScaler(ParallelScaler* parallelScaler)
+{
+	_parallelScaler = parallelScaler;
+}
+
+shared_ptr<IndexedScaler::PaletteTables> IndexedScaler::GetTables(const uint32_t* palette, uint32_t paletteSize)
+{
+	for(size_t i = 0; i < _tables.size(); i++) {
+		shared_ptr<PaletteTables> tables = _tables[i];
+		if(tables->Palette.size() == paletteSize && memcmp(tables->Palette.data(), palette, paletteSize * sizeof(uint32_t)) == 0) {
+			if(i > 0) {
+				_tables.erase(_tables.begin() + i);
+				_tables.insert(_tables.begin(), tables);
+			}
+			return tables;
+		}
+	}
+
+	shared_ptr<PaletteTables> tables(new PaletteTables());
+	tables->Palette.assign(palette, palette + paletteSize);
+	tables->DiffTable.resize(paletteSize * paletteSize);
+	hqx_build_diff_table(palette, (int)paletteSize, tables->DiffTable.data());
+
+	_tables.insert(_tables.begin(), tables);
+	if(_tables.size() > MaxCachedPalettes) {
+		_tables.pop_back();
+	}
+	return tables;
+}
+
+void IndexedScaler::RunRows(uint32_t height, const std::function<void(uint32_t yFirst, uint32_t yLast)>& scaleRows)
+{
+	if(_parallelScaler) {
+		_parallelScaler->Run(height, MinRowsPerThread, scaleRows);
+	} else {
+		scaleRows(0, height);
+	}
+}
+
+void IndexedScaler::Hqx(uint32_t scale, const uint16_t* src, const uint32_t* palette, uint32_t paletteSize, uint32_t* dst, uint32_t width, uint32_t height)
+{
+	shared_ptr<PaletteTables> tables = GetTables(palette, paletteSize);
+	const uint8_t* diffTable = tables->DiffTable.data();
+	uint32_t dstPitch = width * sizeof(uint32_t) * scale;
+	RunRows(height, [=](uint32_t yFirst, uint32_t yLast) {
+		switch(scale) {
+			case 2: hq2x_indexed_rb(src, width, palette, diffTable, paletteSize, dst, dstPitch, width, height, yFirst, yLast); break;
+			case 3: hq3x_indexed_rb(src, width, palette, diffTable, paletteSize, dst, dstPitch, width, height, yFirst, yLast); break;
+			case 4: hq4x_indexed_rb(src, width, palette, diffTable, paletteSize, dst, dstPitch, width, height, yFirst, yLast); break;
+		}
+	});
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "pch.h"
+#include <functional>
+
+class ParallelScaler;
+
+//Runs the HQX filters directly on palette indexes (e.g the PPU's output), rather than on 32-bit colors
+//The YUV comparisons between pixels are replaced by lookups in a paletteSize*paletteSize table, which is built the first
+//time a palette is used (the last few palettes are kept). The output is identical to running the 32-bit filters on the
+//image converted with the palette.
+class IndexedScaler
+{
+private:
+	//Minimum number of rows processed by each thread when a ParallelScaler is used
+	static constexpr uint32_t MinRowsPerThread = 16;
+	static constexpr uint32_t MaxCachedPalettes = 4;
+
+	struct PaletteTables
+	{
+		vector<uint32_t> Palette;
+		vector<uint8_t> DiffTable; //paletteSize*paletteSize, 1 when 2 colors are considered different by HQX
+	};
+
+	ParallelScaler* _parallelScaler;
+	vector<shared_ptr<PaletteTables>> _tables; //most recently used first
+
+	shared_ptr<PaletteTables> GetTables(const uint32_t* palette, uint32_t paletteSize);
+	void RunRows(uint32_t height, const std::function<void(uint32_t yFirst, uint32_t yLast)>& scaleRows);
+
+public:
+	//parallelScaler is optional - when set, each frame is split between its threads
+	IndexedScaler(ParallelScaler* parallelScaler = nullptr);
+
+	//src contains width*height palette indexes (smaller than paletteSize), dst receives (width*scale)*(height*scale) pixels
+	void Hqx(uint32_t scale, const uint16_t* src, const uint32_t* palette, uint32_t paletteSize, uint32_t* dst, uint32_t width, uint32_t height);
+};
@@ -130,18 +130,21 @@
          out += 2
 #endif
 
-void twoxsai_generic_xrgb8888(unsigned width, unsigned height, uint32_t *src, unsigned src_stride, uint32_t *dst, unsigned dst_stride)
+void twoxsai_generic_xrgb8888(unsigned width, unsigned height, uint32_t *src, unsigned src_stride, uint32_t *dst, unsigned dst_stride, unsigned yFirst, unsigned yLast)
 {
    unsigned finish;
-	int y = 0;
 	int x = 0;
-	for(; height; height--) {
+	yLast = std::min(yLast, height);
+	src += yFirst * src_stride;
+	dst += yFirst * 2 * dst_stride;
+	for(unsigned y = yFirst; y < yLast; y++) {
+		unsigned rowsLeft = height - y;
 		uint32_t *in = (uint32_t*)src;
 		uint32_t *out = (uint32_t*)dst;
 
 		int prevline = (y > 0 ? src_stride : 0);
-		int nextline = (height > 1 ? src_stride : 0);
-		int nextline2 = (height > 2 ? src_stride * 2 : nextline);
+		int nextline = (rowsLeft > 1 ? src_stride : 0);
+		int nextline2 = (rowsLeft > 2 ? src_stride * 2 : nextline);
 
 		for(finish = width; finish; finish -= 1) {
 			int prevcolumn = (x > 0 ? 1 : 0);
@@ -162,7 +165,6 @@ void twoxsai_generic_xrgb8888(unsigned width, unsigned height, uint32_t *src, un
 
 		src += src_stride;
 		dst += 2 * dst_stride;
-		y++;
 		x = 0;
 	}
 }
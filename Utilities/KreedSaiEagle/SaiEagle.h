@@ -1,7 +1,9 @@
 #pragma once
 #include "../pch.h"
+#include <climits>
 
-extern void supertwoxsai_generic_xrgb8888(unsigned width, unsigned height, uint32_t *src, unsigned src_stride, uint32_t *dst, unsigned dst_stride);
-extern void twoxsai_generic_xrgb8888(unsigned width, unsigned height, uint32_t *src, unsigned src_stride, uint32_t *dst, unsigned dst_stride);
-extern void supereagle_generic_xrgb8888(unsigned width, unsigned height, uint32_t *src, unsigned src_stride, uint32_t *dst, unsigned dst_stride);
+//yFirst/yLast can be used to only process a slice of rows of the source image (src and dst always point to the full image)
+extern void supertwoxsai_generic_xrgb8888(unsigned width, unsigned height, uint32_t *src, unsigned src_stride, uint32_t *dst, unsigned dst_stride, unsigned yFirst = 0, unsigned yLast = UINT_MAX);
+extern void twoxsai_generic_xrgb8888(unsigned width, unsigned height, uint32_t *src, unsigned src_stride, uint32_t *dst, unsigned dst_stride, unsigned yFirst = 0, unsigned yLast = UINT_MAX);
+extern void supereagle_generic_xrgb8888(unsigned width, unsigned height, uint32_t *src, unsigned src_stride, uint32_t *dst, unsigned dst_stride, unsigned yFirst = 0, unsigned yLast = UINT_MAX);
 
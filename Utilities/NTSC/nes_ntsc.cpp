@@ -235,6 +235,12 @@ void nes_ntsc_init( nes_ntsc_t* ntsc, nes_ntsc_setup_t const* setup )
 
 #ifndef NES_NTSC_NO_BLITTERS
 
+#include "ntsc_simd.h"
+
+#if defined (NTSC_SIMD) && (NES_NTSC_OUT_DEPTH == 24 || NES_NTSC_OUT_DEPTH == 32)
+	#define NES_NTSC_SIMD_BLIT 1
+#endif
+
 void nes_ntsc_blit( nes_ntsc_t const* ntsc, NES_NTSC_IN_T const* input, long in_row_width,
 		int burst_phase, int in_width, int in_height, void* rgb_out, long out_pitch )
 {
@@ -250,6 +256,17 @@ void nes_ntsc_blit( nes_ntsc_t const* ntsc, NES_NTSC_IN_T const* input, long in_
 		
 		for ( n = chunk_count; n; --n )
 		{
+#if NES_NTSC_SIMD_BLIT
+			{
+				nes_ntsc_rgb_t const* const kernelxx1 = kernelx1;
+				nes_ntsc_rgb_t const* const kernelxx2 = kernelx2;
+				NES_NTSC_COLOR_IN( 0, NES_NTSC_ADJ_IN( line_in [0] ) );
+				NES_NTSC_COLOR_IN( 1, NES_NTSC_ADJ_IN( line_in [1] ) );
+				NES_NTSC_COLOR_IN( 2, NES_NTSC_ADJ_IN( line_in [2] ) );
+				ntsc_simd_out_chunk<0, 0>( kernel0, kernelx0, kernel1, kernelx1, kernelxx1,
+						kernel2, kernelx2, kernelxx2, line_out );
+			}
+#else
 			/* order of input and output pixels must not be altered */
 			NES_NTSC_COLOR_IN( 0, NES_NTSC_ADJ_IN( line_in [0] ) );
 			NES_NTSC_RGB_OUT( 0, line_out [0], NES_NTSC_OUT_DEPTH );
@@ -263,12 +280,24 @@ void nes_ntsc_blit( nes_ntsc_t const* ntsc, NES_NTSC_IN_T const* input, long in_
 			NES_NTSC_RGB_OUT( 4, line_out [4], NES_NTSC_OUT_DEPTH );
 			NES_NTSC_RGB_OUT( 5, line_out [5], NES_NTSC_OUT_DEPTH );
 			NES_NTSC_RGB_OUT( 6, line_out [6], NES_NTSC_OUT_DEPTH );
+#endif
 			
 			line_in  += 3;
 			line_out += 7;
 		}
 		
 		/* finish final pixels */
+#if NES_NTSC_SIMD_BLIT
+		{
+			nes_ntsc_rgb_t const* const kernelxx1 = kernelx1;
+			nes_ntsc_rgb_t const* const kernelxx2 = kernelx2;
+			NES_NTSC_COLOR_IN( 0, nes_ntsc_black );
+			NES_NTSC_COLOR_IN( 1, nes_ntsc_black );
+			NES_NTSC_COLOR_IN( 2, nes_ntsc_black );
+			ntsc_simd_out_chunk<0, 0>( kernel0, kernelx0, kernel1, kernelx1, kernelxx1,
+					kernel2, kernelx2, kernelxx2, line_out );
+		}
+#else
 		NES_NTSC_COLOR_IN( 0, nes_ntsc_black );
 		NES_NTSC_RGB_OUT( 0, line_out [0], NES_NTSC_OUT_DEPTH );
 		NES_NTSC_RGB_OUT( 1, line_out [1], NES_NTSC_OUT_DEPTH );
@@ -281,6 +310,7 @@ void nes_ntsc_blit( nes_ntsc_t const* ntsc, NES_NTSC_IN_T const* input, long in_
 		NES_NTSC_RGB_OUT( 4, line_out [4], NES_NTSC_OUT_DEPTH );
 		NES_NTSC_RGB_OUT( 5, line_out [5], NES_NTSC_OUT_DEPTH );
 		NES_NTSC_RGB_OUT( 6, line_out [6], NES_NTSC_OUT_DEPTH );
+#endif
 		
 		burst_phase = (burst_phase + 1) % nes_ntsc_burst_count;
 		input += in_row_width;
@@ -0,0 +1,154 @@
+/* SIMD version of the common 3->7 ntsc output macros, shared by nes_ntsc, snes_ntsc and sms_ntsc */
+
+#ifndef NTSC_SIMD_H
+#define NTSC_SIMD_H
+
+#include <stdint.h>
+
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define NTSC_SIMD 1
+	#define NTSC_SIMD_SSE2 1
+	#include <emmintrin.h>
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+	#define NTSC_SIMD 1
+	#define NTSC_SIMD_NEON 1
+	#include <arm_neon.h>
+#endif
+
+#ifdef NTSC_SIMD
+
+/* same values as the xxx_ntsc_rgb_builder/clamp macros of each library */
+enum { ntsc_simd_rgb_builder = (1 << 21) | (1 << 11) | (1 << 1) };
+enum { ntsc_simd_clamp_mask  = ntsc_simd_rgb_builder * 3 / 2 };
+enum { ntsc_simd_clamp_add   = ntsc_simd_rgb_builder * 0x101 };
+
+/* Generates the 7 output pixels of a chunk at once, with the same result as calling xxx_NTSC_RGB_OUT
+for pixels 0 to 6 after the 3 calls to xxx_NTSC_COLOR_IN for the chunk (with 24 or 32-bit output).
+k0/k1/k2 are the current kernels (kernel0/1/2), x0/x1/x2 the previous ones (kernelx0/1/2) and xx1/xx2
+the values kernelx1/kernelx2 had before the chunk started. Entries are summed as 32-bit values, which
+matches the scalar code even when rgb_t is 64-bit, since the clamp/output only use the lower 32 bits. */
+#ifdef NTSC_SIMD_SSE2
+
+template<typename rgb_t>
+static inline __m128i ntsc_simd_load( rgb_t const* in )
+{
+	if ( sizeof (rgb_t) == 4 )
+		return _mm_loadu_si128( (__m128i const*) in );
+
+	/* 64-bit entries, keep the lower half of each */
+	__m128 lo = _mm_castsi128_ps( _mm_loadu_si128( (__m128i const*) in ) );
+	__m128 hi = _mm_castsi128_ps( _mm_loadu_si128( (__m128i const*) (in + 2) ) );
+	return _mm_castps_si128( _mm_shuffle_ps( lo, hi, _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+}
+
+/* lanes 0-1 of a, lanes 2-3 of b */
+static inline __m128i ntsc_simd_merge( __m128i a, __m128i b )
+{
+	return _mm_castps_si128( _mm_shuffle_ps( _mm_castsi128_ps( a ), _mm_castsi128_ps( b ), _MM_SHUFFLE( 3, 2, 1, 0 ) ) );
+}
+
+template<int shift, uint32_t alpha>
+static inline __m128i ntsc_simd_clamp_out( __m128i raw )
+{
+	__m128i sub = _mm_and_si128( _mm_srli_epi32( raw, 9 - shift ), _mm_set1_epi32( ntsc_simd_clamp_mask ) );
+	__m128i clamp = _mm_sub_epi32( _mm_set1_epi32( ntsc_simd_clamp_add ), sub );
+	raw = _mm_or_si128( raw, clamp );
+	clamp = _mm_sub_epi32( clamp, sub );
+	raw = _mm_and_si128( raw, clamp );
+
+	__m128i r = _mm_and_si128( _mm_srli_epi32( raw, 5 - shift ), _mm_set1_epi32( 0xFF0000 ) );
+	__m128i g = _mm_and_si128( _mm_srli_epi32( raw, 3 - shift ), _mm_set1_epi32( 0xFF00 ) );
+	__m128i b = _mm_and_si128( _mm_srli_epi32( raw, 1 - shift ), _mm_set1_epi32( 0xFF ) );
+	return _mm_or_si128( _mm_or_si128( r, g ), _mm_or_si128( b, _mm_set1_epi32( (int) alpha ) ) );
+}
+
+template<int shift, uint32_t alpha, typename rgb_t>
+static inline void ntsc_simd_out_chunk( rgb_t const* k0, rgb_t const* x0, rgb_t const* k1, rgb_t const* x1,
+		rgb_t const* xx1, rgb_t const* k2, rgb_t const* x2, rgb_t const* xx2, void* rgb_out )
+{
+	/* pixels 0-3: kernel1/kernelx1 change after pixel 1, kernel2/kernelx2 after pixel 3 */
+	__m128i x1_19 = ntsc_simd_load( x1 + 19 );
+	__m128i sum0 = _mm_add_epi32( ntsc_simd_load( k0 ), ntsc_simd_load( x0 + 7 ) );
+	sum0 = _mm_add_epi32( sum0, ntsc_simd_merge( x1_19, ntsc_simd_load( k1 + 12 ) ) );
+	sum0 = _mm_add_epi32( sum0, ntsc_simd_merge( ntsc_simd_load( xx1 + 26 ), x1_19 ) );
+	sum0 = _mm_add_epi32( sum0, ntsc_simd_load( x2 + 31 ) );
+	sum0 = _mm_add_epi32( sum0, ntsc_simd_load( xx2 + 38 ) );
+
+	/* pixels 4-6 (lane 3 is not used) */
+	__m128i sum1 = _mm_add_epi32( ntsc_simd_load( k0 + 4 ), ntsc_simd_load( x0 + 11 ) );
+	sum1 = _mm_add_epi32( sum1, ntsc_simd_load( k1 + 16 ) );
+	sum1 = _mm_add_epi32( sum1, ntsc_simd_load( x1 + 23 ) );
+	sum1 = _mm_add_epi32( sum1, ntsc_simd_load( k2 + 28 ) );
+	sum1 = _mm_add_epi32( sum1, ntsc_simd_load( x2 + 35 ) );
+
+	uint32_t* out = (uint32_t*) rgb_out;
+	__m128i out1 = ntsc_simd_clamp_out<shift, alpha>( sum1 );
+	_mm_storeu_si128( (__m128i*) out, ntsc_simd_clamp_out<shift, alpha>( sum0 ) );
+	_mm_storel_epi64( (__m128i*) (out + 4), out1 );
+	out [6] = (uint32_t) _mm_cvtsi128_si32( _mm_srli_si128( out1, 8 ) );
+}
+
+#else
+
+template<typename rgb_t>
+static inline uint32x4_t ntsc_simd_load( rgb_t const* in )
+{
+	if ( sizeof (rgb_t) == 4 )
+		return vld1q_u32( (uint32_t const*) in );
+
+	/* 64-bit entries, keep the lower half of each */
+	return vld2q_u32( (uint32_t const*) in ).val [0];
+}
+
+/* lanes 0-1 of a, lanes 2-3 of b */
+static inline uint32x4_t ntsc_simd_merge( uint32x4_t a, uint32x4_t b )
+{
+	return vcombine_u32( vget_low_u32( a ), vget_high_u32( b ) );
+}
+
+template<int shift, uint32_t alpha>
+static inline uint32x4_t ntsc_simd_clamp_out( uint32x4_t raw )
+{
+	uint32x4_t sub = vandq_u32( vshrq_n_u32( raw, 9 - shift ), vdupq_n_u32( ntsc_simd_clamp_mask ) );
+	uint32x4_t clamp = vsubq_u32( vdupq_n_u32( ntsc_simd_clamp_add ), sub );
+	raw = vorrq_u32( raw, clamp );
+	clamp = vsubq_u32( clamp, sub );
+	raw = vandq_u32( raw, clamp );
+
+	uint32x4_t r = vandq_u32( vshrq_n_u32( raw, 5 - shift ), vdupq_n_u32( 0xFF0000 ) );
+	uint32x4_t g = vandq_u32( vshrq_n_u32( raw, 3 - shift ), vdupq_n_u32( 0xFF00 ) );
+	uint32x4_t b = vandq_u32( shift == 1 ? raw : vshrq_n_u32( raw, 1 ), vdupq_n_u32( 0xFF ) );
+	return vorrq_u32( vorrq_u32( r, g ), vorrq_u32( b, vdupq_n_u32( alpha ) ) );
+}
+
+template<int shift, uint32_t alpha, typename rgb_t>
+static inline void ntsc_simd_out_chunk( rgb_t const* k0, rgb_t const* x0, rgb_t const* k1, rgb_t const* x1,
+		rgb_t const* xx1, rgb_t const* k2, rgb_t const* x2, rgb_t const* xx2, void* rgb_out )
+{
+	/* pixels 0-3: kernel1/kernelx1 change after pixel 1, kernel2/kernelx2 after pixel 3 */
+	uint32x4_t x1_19 = ntsc_simd_load( x1 + 19 );
+	uint32x4_t sum0 = vaddq_u32( ntsc_simd_load( k0 ), ntsc_simd_load( x0 + 7 ) );
+	sum0 = vaddq_u32( sum0, ntsc_simd_merge( x1_19, ntsc_simd_load( k1 + 12 ) ) );
+	sum0 = vaddq_u32( sum0, ntsc_simd_merge( ntsc_simd_load( xx1 + 26 ), x1_19 ) );
+	sum0 = vaddq_u32( sum0, ntsc_simd_load( x2 + 31 ) );
+	sum0 = vaddq_u32( sum0, ntsc_simd_load( xx2 + 38 ) );
+
+	/* pixels 4-6 (lane 3 is not used) */
+	uint32x4_t sum1 = vaddq_u32( ntsc_simd_load( k0 + 4 ), ntsc_simd_load( x0 + 11 ) );
+	sum1 = vaddq_u32( sum1, ntsc_simd_load( k1 + 16 ) );
+	sum1 = vaddq_u32( sum1, ntsc_simd_load( x1 + 23 ) );
+	sum1 = vaddq_u32( sum1, ntsc_simd_load( k2 + 28 ) );
+	sum1 = vaddq_u32( sum1, ntsc_simd_load( x2 + 35 ) );
+
+	uint32_t* out = (uint32_t*) rgb_out;
+	uint32x4_t out1 = ntsc_simd_clamp_out<shift, alpha>( sum1 );
+	vst1q_u32( out, ntsc_simd_clamp_out<shift, alpha>( sum0 ) );
+	vst1_u32( out + 4, vget_low_u32( out1 ) );
+	vst1q_lane_u32( out + 6, out1, 2 );
+}
+
+#endif
+
+#endif
+
+#endif
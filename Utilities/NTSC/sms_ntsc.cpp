@@ -85,6 +85,12 @@ void sms_ntsc_init( sms_ntsc_t* ntsc, sms_ntsc_setup_t const* setup )
 
 #ifndef SMS_NTSC_NO_BLITTERS
 
+#include "ntsc_simd.h"
+
+#if defined (NTSC_SIMD) && (SMS_NTSC_OUT_DEPTH == 24 || SMS_NTSC_OUT_DEPTH == 32)
+	#define SMS_NTSC_SIMD_BLIT 1
+#endif
+
 void sms_ntsc_blit( sms_ntsc_t const* ntsc, SMS_NTSC_IN_T const* input, long in_row_width,
 		int in_width, int in_height, void* rgb_out, long out_pitch )
 {
@@ -107,6 +113,17 @@ void sms_ntsc_blit( sms_ntsc_t const* ntsc, SMS_NTSC_IN_T const* input, long in_
 		
 		for ( n = chunk_count; n; --n )
 		{
+#if SMS_NTSC_SIMD_BLIT
+			{
+				sms_ntsc_rgb_t const* const kernelxx1 = kernelx1;
+				sms_ntsc_rgb_t const* const kernelxx2 = kernelx2;
+				SMS_NTSC_COLOR_IN( 0, ntsc, SMS_NTSC_ADJ_IN( line_in [0] ) );
+				SMS_NTSC_COLOR_IN( 1, ntsc, SMS_NTSC_ADJ_IN( line_in [1] ) );
+				SMS_NTSC_COLOR_IN( 2, ntsc, SMS_NTSC_ADJ_IN( line_in [2] ) );
+				ntsc_simd_out_chunk<0, 0>( kernel0, kernelx0, kernel1, kernelx1, kernelxx1,
+						kernel2, kernelx2, kernelxx2, line_out );
+			}
+#else
 			/* order of input and output pixels must not be altered */
 			SMS_NTSC_COLOR_IN( 0, ntsc, SMS_NTSC_ADJ_IN( line_in [0] ) );
 			SMS_NTSC_RGB_OUT( 0, line_out [0], SMS_NTSC_OUT_DEPTH );
@@ -120,12 +137,24 @@ void sms_ntsc_blit( sms_ntsc_t const* ntsc, SMS_NTSC_IN_T const* input, long in_
 			SMS_NTSC_RGB_OUT( 4, line_out [4], SMS_NTSC_OUT_DEPTH );
 			SMS_NTSC_RGB_OUT( 5, line_out [5], SMS_NTSC_OUT_DEPTH );
 			SMS_NTSC_RGB_OUT( 6, line_out [6], SMS_NTSC_OUT_DEPTH );
+#endif
 			
 			line_in  += 3;
 			line_out += 7;
 		}
 		
 		/* finish final pixels */
+#if SMS_NTSC_SIMD_BLIT
+		{
+			sms_ntsc_rgb_t const* const kernelxx1 = kernelx1;
+			sms_ntsc_rgb_t const* const kernelxx2 = kernelx2;
+			SMS_NTSC_COLOR_IN( 0, ntsc, sms_ntsc_black );
+			SMS_NTSC_COLOR_IN( 1, ntsc, sms_ntsc_black );
+			SMS_NTSC_COLOR_IN( 2, ntsc, sms_ntsc_black );
+			ntsc_simd_out_chunk<0, 0>( kernel0, kernelx0, kernel1, kernelx1, kernelxx1,
+					kernel2, kernelx2, kernelxx2, line_out );
+		}
+#else
 		SMS_NTSC_COLOR_IN( 0, ntsc, sms_ntsc_black );
 		SMS_NTSC_RGB_OUT( 0, line_out [0], SMS_NTSC_OUT_DEPTH );
 		SMS_NTSC_RGB_OUT( 1, line_out [1], SMS_NTSC_OUT_DEPTH );
@@ -138,6 +167,7 @@ void sms_ntsc_blit( sms_ntsc_t const* ntsc, SMS_NTSC_IN_T const* input, long in_
 		SMS_NTSC_RGB_OUT( 4, line_out [4], SMS_NTSC_OUT_DEPTH );
 		SMS_NTSC_RGB_OUT( 5, line_out [5], SMS_NTSC_OUT_DEPTH );
 		SMS_NTSC_RGB_OUT( 6, line_out [6], SMS_NTSC_OUT_DEPTH );
+#endif
 		
 		input += in_row_width;
 		rgb_out = (char*) rgb_out + out_pitch;
@@ -130,6 +130,12 @@ void snes_ntsc_init( snes_ntsc_t* ntsc, snes_ntsc_setup_t const* setup )
 
 #ifndef SNES_NTSC_NO_BLITTERS
 
+#include "ntsc_simd.h"
+
+#if defined (NTSC_SIMD) && (SNES_NTSC_OUT_DEPTH == 24 || SNES_NTSC_OUT_DEPTH == 32)
+	#define SNES_NTSC_SIMD_BLIT 1
+#endif
+
 void snes_ntsc_blit( snes_ntsc_t const* ntsc, SNES_NTSC_IN_T const* input, long in_row_width,
 		int burst_phase, int in_width, int in_height, void* rgb_out, long out_pitch )
 {
@@ -145,6 +151,17 @@ void snes_ntsc_blit( snes_ntsc_t const* ntsc, SNES_NTSC_IN_T const* input, long
 		
 		for ( n = chunk_count; n; --n )
 		{
+#if SNES_NTSC_SIMD_BLIT
+			{
+				snes_ntsc_rgb_t const* const kernelxx1 = kernelx1;
+				snes_ntsc_rgb_t const* const kernelxx2 = kernelx2;
+				SNES_NTSC_COLOR_IN( 0, SNES_NTSC_ADJ_IN( line_in [0] ) );
+				SNES_NTSC_COLOR_IN( 1, SNES_NTSC_ADJ_IN( line_in [1] ) );
+				SNES_NTSC_COLOR_IN( 2, SNES_NTSC_ADJ_IN( line_in [2] ) );
+				ntsc_simd_out_chunk<1, 0xFF000000>( kernel0, kernelx0, kernel1, kernelx1, kernelxx1,
+						kernel2, kernelx2, kernelxx2, line_out );
+			}
+#else
 			/* order of input and output pixels must not be altered */
 			SNES_NTSC_COLOR_IN( 0, SNES_NTSC_ADJ_IN( line_in [0] ) );
 			SNES_NTSC_RGB_OUT( 0, line_out [0], SNES_NTSC_OUT_DEPTH );
@@ -158,12 +175,24 @@ void snes_ntsc_blit( snes_ntsc_t const* ntsc, SNES_NTSC_IN_T const* input, long
 			SNES_NTSC_RGB_OUT( 4, line_out [4], SNES_NTSC_OUT_DEPTH );
 			SNES_NTSC_RGB_OUT( 5, line_out [5], SNES_NTSC_OUT_DEPTH );
 			SNES_NTSC_RGB_OUT( 6, line_out [6], SNES_NTSC_OUT_DEPTH );
+#endif
 			
 			line_in  += 3;
 			line_out += 7;
 		}
 		
 		/* finish final pixels */
+#if SNES_NTSC_SIMD_BLIT
+		{
+			snes_ntsc_rgb_t const* const kernelxx1 = kernelx1;
+			snes_ntsc_rgb_t const* const kernelxx2 = kernelx2;
+			SNES_NTSC_COLOR_IN( 0, snes_ntsc_black );
+			SNES_NTSC_COLOR_IN( 1, snes_ntsc_black );
+			SNES_NTSC_COLOR_IN( 2, snes_ntsc_black );
+			ntsc_simd_out_chunk<1, 0xFF000000>( kernel0, kernelx0, kernel1, kernelx1, kernelxx1,
+					kernel2, kernelx2, kernelxx2, line_out );
+		}
+#else
 		SNES_NTSC_COLOR_IN( 0, snes_ntsc_black );
 		SNES_NTSC_RGB_OUT( 0, line_out [0], SNES_NTSC_OUT_DEPTH );
 		SNES_NTSC_RGB_OUT( 1, line_out [1], SNES_NTSC_OUT_DEPTH );
@@ -176,6 +205,7 @@ void snes_ntsc_blit( snes_ntsc_t const* ntsc, SNES_NTSC_IN_T const* input, long
 		SNES_NTSC_RGB_OUT( 4, line_out [4], SNES_NTSC_OUT_DEPTH );
 		SNES_NTSC_RGB_OUT( 5, line_out [5], SNES_NTSC_OUT_DEPTH );
 		SNES_NTSC_RGB_OUT( 6, line_out [6], SNES_NTSC_OUT_DEPTH );
+#endif
 		
 		burst_phase = (burst_phase + 1) % snes_ntsc_burst_count;
 		input += in_row_width;
@@ -0,0 +1,261 @@
+#include "pch.h"
+#include <cstring>
+#include "NtscKernelCache.h"
+#include "CRC32.h"
+
+namespace
+{
+	//Keys contain the setup's parameters, followed by a copy of the arrays the setup points to
+	//Arrays are aligned to 8 bytes, so GetSetup() can point directly to the copy stored in the key
+	template<typename T>
+	void WriteValue(vector<uint8_t>& key, T value)
+	{
+		size_t pos = key.size();
+		key.resize(pos + sizeof(T));
+		memcpy(key.data() + pos, &value, sizeof(T));
+	}
+
+	template<typename T>
+	void WriteArray(vector<uint8_t>& key, const T* data, size_t count)
+	{
+		WriteValue<uint8_t>(key, data ? 1 : 0);
+		key.resize((key.size() + 7) & ~7);
+		if(data) {
+			size_t pos = key.size();
+			key.resize(pos + count * sizeof(T));
+			memcpy(key.data() + pos, data, count * sizeof(T));
+			key.resize((key.size() + 7) & ~7);
+		}
+	}
+
+	template<typename T>
+	void ReadValue(const vector<uint8_t>& key, size_t& pos, T& value)
+	{
+		memcpy(&value, key.data() + pos, sizeof(T));
+		pos += sizeof(T);
+	}
+
+	template<typename T>
+	void ReadArray(const vector<uint8_t>& key, size_t& pos, const T*& data, size_t count)
+	{
+		uint8_t present;
+		ReadValue(key, pos, present);
+		pos = (pos + 7) & ~7;
+		data = nullptr;
+		if(present) {
+			data = (const T*)(key.data() + pos);
+			pos = (pos + count * sizeof(T) + 7) & ~7;
+		}
+	}
+
+	//Parameters common to all 3 filters
+	template<typename SetupType>
+	void WriteCommonParams(vector<uint8_t>& key, const SetupType& setup)
+	{
+		for(double value : { setup.hue, setup.saturation, setup.contrast, setup.brightness, setup.sharpness, setup.gamma, setup.resolution, setup.artifacts, setup.fringing, setup.bleed }) {
+			WriteValue(key, value);
+		}
+		WriteArray(key, setup.decoder_matrix, 6);
+	}
+
+	template<typename SetupType>
+	void ReadCommonParams(const vector<uint8_t>& key, size_t& pos, SetupType& setup)
+	{
+		for(double* value : { &setup.hue, &setup.saturation, &setup.contrast, &setup.brightness, &setup.sharpness, &setup.gamma, &setup.resolution, &setup.artifacts, &setup.fringing, &setup.bleed }) {
+			ReadValue(key, pos, *value);
+		}
+		ReadArray(key, pos, setup.decoder_matrix, 6);
+	}
+
+	void NtscInit(nes_ntsc_t* ntsc, const nes_ntsc_setup_t* setup) { nes_ntsc_init(ntsc, setup); }
+	void NtscInit(snes_ntsc_t* ntsc, const snes_ntsc_setup_t* setup) { snes_ntsc_init(ntsc, setup); }
+	void NtscInit(sms_ntsc_t* ntsc, const sms_ntsc_setup_t* setup) { sms_ntsc_init(ntsc, setup); }
+}
+
+template<>
+void NtscKernelCache<nes_ntsc_t>::GetKey(const nes_ntsc_setup_t& setup, vector<uint8_t>& key)
+{
+	WriteCommonParams(key, setup);
+	WriteValue(key, setup.merge_fields);
+	WriteArray(key, setup.palette, nes_ntsc_palette_size * 3);
+	WriteArray(key, setup.base_palette, 64 * 3);
+}
+
+template<>
+nes_ntsc_setup_t NtscKernelCache<nes_ntsc_t>::GetSetup(const vector<uint8_t>& key)
+{
+	nes_ntsc_setup_t setup = {};
+	size_t pos = 0;
+	ReadCommonParams(key, pos, setup);
+	ReadValue(key, pos, setup.merge_fields);
+	ReadArray(key, pos, setup.palette, nes_ntsc_palette_size * 3);
+	ReadArray(key, pos, setup.base_palette, 64 * 3);
+	return setup;
+}
+
+template<>
+void NtscKernelCache<snes_ntsc_t>::GetKey(const snes_ntsc_setup_t& setup, vector<uint8_t>& key)
+{
+	WriteCommonParams(key, setup);
+	WriteValue(key, setup.merge_fields);
+	WriteArray(key, setup.bsnes_colortbl, 0x8000);
+}
+
+template<>
+snes_ntsc_setup_t NtscKernelCache<snes_ntsc_t>::GetSetup(const vector<uint8_t>& key)
+{
+	snes_ntsc_setup_t setup = {};
+	size_t pos = 0;
+	ReadCommonParams(key, pos, setup);
+	ReadValue(key, pos, setup.merge_fields);
+	ReadArray(key, pos, setup.bsnes_colortbl, 0x8000);
+	return setup;
+}
+
+template<>
+void NtscKernelCache<sms_ntsc_t>::GetKey(const sms_ntsc_setup_t& setup, vector<uint8_t>& key)
+{
+	WriteCommonParams(key, setup);
+}
+
+template<>
+sms_ntsc_setup_t NtscKernelCache<sms_ntsc_t>::GetSetup(const vector<uint8_t>& key)
+{
+	sms_ntsc_setup_t setup = {};
+	size_t pos = 0;
+	ReadCommonParams(key, pos, setup);
+	return setup;
+}
+
+template<typename NtscType>
+NtscKernelCache<NtscType>::NtscKernelCache(uint32_t maxEntries)
+{
+	_maxEntries = std::max(1u, maxEntries);
+}
+
+template<typename NtscType>
+NtscKernelCache<NtscType>::~NtscKernelCache()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopFlag = true;
+		_buildSignal.notify_all();
+	}
+
+	if(_buildThread.joinable()) {
+		_buildThread.join();
+	}
+}
+
+template<typename NtscType>
+shared_ptr<const NtscType> NtscKernelCache<NtscType>::Build(const vector<uint8_t>& key)
+{
+	SetupType setup = GetSetup(key);
+	shared_ptr<NtscType> tables(new NtscType());
+	NtscInit(tables.get(), &setup);
+	return tables;
+}
+
+template<typename NtscType>
+void NtscKernelCache<NtscType>::AddEntry(uint32_t hash, const vector<uint8_t>& key, shared_ptr<const NtscType> tables)
+{
+	_entries.insert(_entries.begin(), CacheEntry { hash, key, tables });
+	if(_entries.size() > _maxEntries) {
+		_entries.pop_back();
+	}
+}
+
+template<typename NtscType>
+void NtscKernelCache<NtscType>::SetTables(const vector<uint8_t>& key, shared_ptr<const NtscType> tables)
+{
+	_currentKey = key;
+	std::atomic_store(&_tables, tables);
+}
+
+template<typename NtscType>
+void NtscKernelCache<NtscType>::SetSetup(const SetupType& setup)
+{
+	vector<uint8_t> key;
+	GetKey(setup, key);
+	uint32_t hash = CRC32::GetCRC(key);
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	_requestedKey = key;
+	if(key == _currentKey && std::atomic_load(&_tables)) {
+		//Already in use - cancel any build that was requested for another setup
+		_buildPending = false;
+		return;
+	}
+
+	for(size_t i = 0; i < _entries.size(); i++) {
+		if(_entries[i].Hash == hash && _entries[i].Key == key) {
+			CacheEntry entry = _entries[i];
+			_entries.erase(_entries.begin() + i);
+			_entries.insert(_entries.begin(), entry);
+			SetTables(key, entry.Tables);
+			_buildPending = false;
+			return;
+		}
+	}
+
+	if(!std::atomic_load(&_tables)) {
+		//Nothing to display yet, build the tables immediately
+		shared_ptr<const NtscType> tables = Build(key);
+		AddEntry(hash, key, tables);
+		SetTables(key, tables);
+		return;
+	}
+
+	//Replaces any older request that hasn't been started yet
+	_pendingKey = std::move(key);
+	_buildPending = true;
+	if(!_buildThread.joinable()) {
+		_buildThread = std::thread([this]() { BuildThread(); });
+	}
+	_buildSignal.notify_all();
+}
+
+template<typename NtscType>
+void NtscKernelCache<NtscType>::BuildThread()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	while(true) {
+		_buildSignal.wait(lock, [this] { return _stopFlag || _buildPending; });
+		if(_stopFlag) {
+			break;
+		}
+
+		vector<uint8_t> key = std::move(_pendingKey);
+		_buildPending = false;
+		_building = true;
+
+		lock.unlock();
+		shared_ptr<const NtscType> tables = Build(key);
+		uint32_t hash = CRC32::GetCRC(key);
+		lock.lock();
+
+		_building = false;
+		AddEntry(hash, key, tables);
+		if(key == _requestedKey) {
+			//Only use the new tables if no other setup was selected while they were being built
+			SetTables(key, tables);
+		}
+	}
+}
+
+template<typename NtscType>
+shared_ptr<const NtscType> NtscKernelCache<NtscType>::GetTables()
+{
+	return std::atomic_load(&_tables);
+}
+
+template<typename NtscType>
+bool NtscKernelCache<NtscType>::IsBuilding()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _building || _buildPending;
+}
+
+template class NtscKernelCache<nes_ntsc_t>;
+template class NtscKernelCache<snes_ntsc_t>;
+template class NtscKernelCache<sms_ntsc_t>;
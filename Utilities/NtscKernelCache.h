@@ -0,0 +1,68 @@
+#pragma once
+#include "pch.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "NTSC/nes_ntsc.h"
+#include "NTSC/snes_ntsc.h"
+#include "NTSC/sms_ntsc.h"
+
+template<typename NtscType> struct NtscSetupType;
+template<> struct NtscSetupType<nes_ntsc_t> { typedef nes_ntsc_setup_t Type; };
+template<> struct NtscSetupType<snes_ntsc_t> { typedef snes_ntsc_setup_t Type; };
+template<> struct NtscSetupType<sms_ntsc_t> { typedef sms_ntsc_setup_t Type; };
+
+//Keeps the kernel tables of the last few NTSC filter setups, and builds new ones on a background thread
+//Setups are identified by the content of the setup struct (including the palettes/decoder matrix it points to), so
+//going back to a previous setting swaps the tables immediately. When a setup is not in the cache, the current tables
+//stay in use until the new ones are ready, and only the most recent request is built if several are made in a row
+//(e.g while a slider is being dragged). Note: palette_out is not supported (it is ignored).
+//Instantiated for nes_ntsc_t, snes_ntsc_t and sms_ntsc_t.
+template<typename NtscType>
+class NtscKernelCache
+{
+public:
+	typedef typename NtscSetupType<NtscType>::Type SetupType;
+
+private:
+	struct CacheEntry
+	{
+		uint32_t Hash;
+		vector<uint8_t> Key;
+		shared_ptr<const NtscType> Tables;
+	};
+
+	uint32_t _maxEntries;
+	vector<CacheEntry> _entries; //most recently used first
+	shared_ptr<const NtscType> _tables;
+	vector<uint8_t> _currentKey;
+	vector<uint8_t> _requestedKey;
+
+	std::thread _buildThread;
+	std::mutex _mutex;
+	std::condition_variable _buildSignal;
+	vector<uint8_t> _pendingKey;
+	bool _buildPending = false;
+	bool _building = false;
+	bool _stopFlag = false;
+
+	static void GetKey(const SetupType& setup, vector<uint8_t>& key);
+	static SetupType GetSetup(const vector<uint8_t>& key);
+	static shared_ptr<const NtscType> Build(const vector<uint8_t>& key);
+
+	void AddEntry(uint32_t hash, const vector<uint8_t>& key, shared_ptr<const NtscType> tables);
+	void SetTables(const vector<uint8_t>& key, shared_ptr<const NtscType> tables);
+	void BuildThread();
+
+public:
+	NtscKernelCache(uint32_t maxEntries = 4);
+	~NtscKernelCache();
+
+	//Selects the tables for the given setup - never blocks, except for the very first call (so GetTables() always returns valid tables after it)
+	void SetSetup(const SetupType& setup);
+
+	//Tables for the most recent setup that is ready - the caller keeps the returned pointer for the duration of the frame
+	shared_ptr<const NtscType> GetTables();
+
+	bool IsBuilding();
+};
@@ -1,59 +1,20 @@
 #include "pch.h"
 #include <sstream>
 #include "PNGHelper.h"
+#include "PNGWriter.h"
 #include "miniz.h"
 
 #define SPNG_USE_MINIZ
 #include "spng.h"
 
-bool PNGHelper::WritePNG(std::stringstream &stream, uint32_t* buffer, uint32_t xSize, uint32_t ySize, uint32_t bitsPerPixel)
+bool PNGHelper::WritePNG(std::stringstream &stream, uint32_t* buffer, uint32_t xSize, uint32_t ySize, uint32_t bitsPerPixel, uint32_t compressionLevel)
 {
-	size_t pngSize = 0;
-
-	uint32_t size = xSize * ySize * bitsPerPixel / 8;
-	vector<uint8_t> convertedData(size, 0);
-	if(bitsPerPixel == 32) {
-		//ARGB -> ABGR
-		for(uint32_t i = 0; i < size / 4; i++) {
-			convertedData[i * 4] = (buffer[i] & 0xFF0000) >> 16;
-			convertedData[i * 4 + 1] = (buffer[i] & 0xFF00) >> 8;
-			convertedData[i * 4 + 2] = (buffer[i] & 0xFF);
-			convertedData[i * 4 + 3] = (buffer[i] & 0xFF000000) >> 24;
-		}
-	} else if(bitsPerPixel == 24) {
-		//ARGB -> BGR
-		for(uint32_t i = 0; i < size / 3; i++) {
-			convertedData[i * 3] = (buffer[i] & 0xFF0000) >> 16;
-			convertedData[i * 3 + 1] = (buffer[i] & 0xFF00) >> 8;
-			convertedData[i * 3 + 2] = (buffer[i] & 0xFF);
-		}
-	} else {
-		return false;
-	}
-
-	void* pngData = tdefl_write_image_to_png_file_in_memory_ex(convertedData.data(), xSize, ySize, bitsPerPixel / 8, &pngSize, MZ_DEFAULT_LEVEL, MZ_FALSE);
-	if(!pngData) {
-		std::cout << "tdefl_write_image_to_png_file_in_memory_ex() failed!" << std::endl;
-		return false;
-	} else {
-		stream.write((char*)pngData, pngSize);
-		mz_free(pngData);
-		return true;
-	}
+	return PNGWriter::Write(stream, buffer, xSize, ySize, bitsPerPixel, compressionLevel);
 }
 
-bool PNGHelper::WritePNG(string filename, uint32_t* buffer, uint32_t xSize, uint32_t ySize, uint32_t bitsPerPixel)
+bool PNGHelper::WritePNG(string filename, uint32_t* buffer, uint32_t xSize, uint32_t ySize, uint32_t bitsPerPixel, uint32_t compressionLevel)
 {
-	std::stringstream stream;
-	if(WritePNG(stream, buffer, xSize, ySize, bitsPerPixel)) {
-		ofstream file(filename, std::ios::out | std::ios::binary);
-		if(file.good()) {
-			file << stream.rdbuf();
-		}
-		file.close();
-		return true;
-	}
-	return false;
+	return PNGWriter::Write(filename, buffer, xSize, ySize, bitsPerPixel, compressionLevel);
 }
 
 template<typename T>
@@ -0,0 +1,363 @@
+#include "pch.h"
+#include "PNGWriter.h"
+#include "CpuFeatures.h"
+#include "miniz.h"
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+	#include <arm_neon.h>
+	#define PNGWRITER_NEON
+#elif defined(__SSE2__) || defined(_M_X64)
+	//SSE2 is always used, SSSE3 is used when the CPU supports it
+	#include <emmintrin.h>
+	#include <tmmintrin.h>
+	#define PNGWRITER_SSE2
+#endif
+
+namespace {
+	//Collects the deflate output into IDAT chunks
+	struct PNGChunkWriter
+	{
+		static constexpr size_t MaxChunkSize = 0x10000;
+
+		const std::function<bool(const uint8_t*, size_t)>& Output;
+		vector<uint8_t> Buffer;
+		bool Failed = false;
+
+		PNGChunkWriter(const std::function<bool(const uint8_t*, size_t)>& output) : Output(output)
+		{
+			Buffer.reserve(MaxChunkSize + 12);
+		}
+
+		void WriteChunk(const char* type, const uint8_t* data, uint32_t size)
+		{
+			uint8_t header[8] = {
+				(uint8_t)(size >> 24), (uint8_t)(size >> 16), (uint8_t)(size >> 8), (uint8_t)size,
+				(uint8_t)type[0], (uint8_t)type[1], (uint8_t)type[2], (uint8_t)type[3]
+			};
+
+			uint32_t crc = (uint32_t)mz_crc32(MZ_CRC32_INIT, header + 4, 4);
+			crc = (uint32_t)mz_crc32(crc, data, size);
+			uint8_t footer[4] = { (uint8_t)(crc >> 24), (uint8_t)(crc >> 16), (uint8_t)(crc >> 8), (uint8_t)crc };
+
+			if(!Failed) {
+				Failed = !Output(header, 8) || (size > 0 && !Output(data, size)) || !Output(footer, 4);
+			}
+		}
+
+		void FlushIdat()
+		{
+			if(!Buffer.empty()) {
+				WriteChunk("IDAT", Buffer.data(), (uint32_t)Buffer.size());
+				Buffer.clear();
+			}
+		}
+
+		static mz_bool PutBuffer(const void* data, int len, void* userData)
+		{
+			PNGChunkWriter* writer = (PNGChunkWriter*)userData;
+			const uint8_t* src = (const uint8_t*)data;
+			while(len > 0) {
+				size_t count = std::min<size_t>(len, MaxChunkSize - writer->Buffer.size());
+				writer->Buffer.insert(writer->Buffer.end(), src, src + count);
+				src += count;
+				len -= (int)count;
+				if(writer->Buffer.size() == MaxChunkSize) {
+					writer->FlushIdat();
+				}
+			}
+			return !writer->Failed;
+		}
+	};
+}
+
+namespace {
+	//ARGB (BGRA in memory) -> RGB/RGBA, for as many pixels as possible (returns the number of pixels converted)
+	//Output buffers have 16 bytes of padding at the end, which lets the SIMD versions store full vectors
+	uint32_t ConvertPixelsScalar(const uint32_t*, uint8_t*, uint32_t, bool)
+	{
+		//Nothing to do, ConvertRow's loop converts all the pixels
+		return 0;
+	}
+
+#if defined(PNGWRITER_NEON)
+	uint32_t ConvertPixelsNeon(const uint32_t* src, uint8_t* dst, uint32_t width, bool withAlpha)
+	{
+		uint32_t i = 0;
+		for(; i + 16 <= width; i += 16) {
+			uint8x16x4_t bgra = vld4q_u8((const uint8_t*)(src + i));
+			if(withAlpha) {
+				uint8x16x4_t rgba = { { bgra.val[2], bgra.val[1], bgra.val[0], bgra.val[3] } };
+				vst4q_u8(dst + i * 4, rgba);
+			} else {
+				uint8x16x3_t rgb = { { bgra.val[2], bgra.val[1], bgra.val[0] } };
+				vst3q_u8(dst + i * 3, rgb);
+			}
+		}
+		return i;
+	}
+#elif defined(PNGWRITER_SSE2)
+	CPU_TARGET_SSSE3 uint32_t ConvertPixelsSsse3(const uint32_t* src, uint8_t* dst, uint32_t width, bool withAlpha)
+	{
+		uint32_t i = 0;
+		if(withAlpha) {
+			const __m128i mask = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+			for(; i + 4 <= width; i += 4) {
+				__m128i pixels = _mm_loadu_si128((const __m128i*)(src + i));
+				_mm_storeu_si128((__m128i*)(dst + i * 4), _mm_shuffle_epi8(pixels, mask));
+			}
+		} else {
+			const __m128i mask = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+			for(; i + 4 <= width; i += 4) {
+				__m128i pixels = _mm_loadu_si128((const __m128i*)(src + i));
+				_mm_storeu_si128((__m128i*)(dst + i * 3), _mm_shuffle_epi8(pixels, mask));
+			}
+		}
+		return i;
+	}
+
+	uint32_t ConvertPixelsSse2(const uint32_t* src, uint8_t* dst, uint32_t width, bool withAlpha)
+	{
+		uint32_t i = 0;
+		if(withAlpha) {
+			const __m128i greenAlpha = _mm_set1_epi32(0xFF00FF00);
+			const __m128i lowByte = _mm_set1_epi32(0xFF);
+			for(; i + 4 <= width; i += 4) {
+				__m128i pixels = _mm_loadu_si128((const __m128i*)(src + i));
+				__m128i red = _mm_and_si128(_mm_srli_epi32(pixels, 16), lowByte);
+				__m128i blue = _mm_slli_epi32(_mm_and_si128(pixels, lowByte), 16);
+				__m128i result = _mm_or_si128(_mm_and_si128(pixels, greenAlpha), _mm_or_si128(red, blue));
+				_mm_storeu_si128((__m128i*)(dst + i * 4), result);
+			}
+		}
+		return i;
+	}
+#endif
+
+	CpuDispatch<uint32_t(*)(const uint32_t*, uint8_t*, uint32_t, bool)> ConvertPixels({
+		{ CpuTier::Scalar, ConvertPixelsScalar },
+#if defined(PNGWRITER_NEON)
+		{ CpuTier::Neon, ConvertPixelsNeon },
+#elif defined(PNGWRITER_SSE2)
+		{ CpuTier::Sse2, ConvertPixelsSse2 },
+		{ CpuTier::Ssse3, ConvertPixelsSsse3 },
+#endif
+	});
+}
+
+void PNGWriter::ConvertRow(const uint32_t* src, uint8_t* dst, uint32_t width, bool withAlpha)
+{
+	uint32_t i = ConvertPixels(src, dst, width, withAlpha);
+
+	if(withAlpha) {
+		for(; i < width; i++) {
+			uint32_t color = src[i];
+			dst[i * 4] = (uint8_t)(color >> 16);
+			dst[i * 4 + 1] = (uint8_t)(color >> 8);
+			dst[i * 4 + 2] = (uint8_t)color;
+			dst[i * 4 + 3] = (uint8_t)(color >> 24);
+		}
+	} else {
+		for(; i < width; i++) {
+			uint32_t color = src[i];
+			dst[i * 3] = (uint8_t)(color >> 16);
+			dst[i * 3 + 1] = (uint8_t)(color >> 8);
+			dst[i * 3 + 2] = (uint8_t)color;
+		}
+	}
+}
+
+uint8_t* PNGWriter::FilterRow(const uint8_t* row, const uint8_t* prevRow, uint32_t rowSize, uint32_t bytesPerPixel, uint8_t* filterBuffers)
+{
+	//Applies the Sub, Up and Paeth filters and returns the one with the lowest sum of absolute
+	//values (the heuristic recommended by the PNG spec), or nullptr if the unfiltered row is better.
+	//Both rows must be preceded by (at least) bytesPerPixel zero bytes, which avoids special-casing the first pixel.
+	uint8_t* sub = filterBuffers;
+	uint8_t* up = sub + rowSize + 1;
+	uint8_t* paeth = up + rowSize + 1;
+	sub[0] = 1;
+	up[0] = 2;
+	paeth[0] = 4;
+	sub++;
+	up++;
+	paeth++;
+
+	uint32_t noneSum = 0;
+	uint32_t subSum = 0;
+	uint32_t upSum = 0;
+	uint32_t paethSum = 0;
+	uint32_t i = 0;
+
+#if defined(PNGWRITER_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	__m128i noneTotal = zero;
+	__m128i subTotal = zero;
+	__m128i upTotal = zero;
+	__m128i paethTotal = zero;
+
+	//Sum of the absolute values of the bytes, interpreted as signed values
+	auto sumAbs = [zero](__m128i v) {
+		return _mm_sad_epu8(_mm_min_epu8(v, _mm_sub_epi8(zero, v)), zero);
+	};
+
+	//Paeth predictor, computed on 16-bit lanes
+	auto predict = [](__m128i a, __m128i b, __m128i c) {
+		__m128i pa = _mm_sub_epi16(b, c);
+		__m128i pb = _mm_sub_epi16(a, c);
+		__m128i pc = _mm_add_epi16(pa, pb);
+		pa = _mm_max_epi16(pa, _mm_sub_epi16(_mm_setzero_si128(), pa));
+		pb = _mm_max_epi16(pb, _mm_sub_epi16(_mm_setzero_si128(), pb));
+		pc = _mm_max_epi16(pc, _mm_sub_epi16(_mm_setzero_si128(), pc));
+
+		//a if pa <= pb && pa <= pc, otherwise b if pb <= pc, otherwise c
+		__m128i useA = _mm_andnot_si128(_mm_or_si128(_mm_cmpgt_epi16(pa, pb), _mm_cmpgt_epi16(pa, pc)), _mm_set1_epi16(-1));
+		__m128i useB = _mm_andnot_si128(_mm_cmpgt_epi16(pb, pc), _mm_set1_epi16(-1));
+		__m128i bc = _mm_or_si128(_mm_and_si128(useB, b), _mm_andnot_si128(useB, c));
+		return _mm_or_si128(_mm_and_si128(useA, a), _mm_andnot_si128(useA, bc));
+	};
+
+	for(; i + 16 <= rowSize; i += 16) {
+		__m128i x = _mm_loadu_si128((const __m128i*)(row + i));
+		__m128i a = _mm_loadu_si128((const __m128i*)(row + i - bytesPerPixel));
+		__m128i b = _mm_loadu_si128((const __m128i*)(prevRow + i));
+		__m128i c = _mm_loadu_si128((const __m128i*)(prevRow + i - bytesPerPixel));
+
+		__m128i predLow = predict(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero), _mm_unpacklo_epi8(c, zero));
+		__m128i predHigh = predict(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero), _mm_unpackhi_epi8(c, zero));
+		__m128i predictor = _mm_packus_epi16(predLow, predHigh);
+
+		__m128i subValue = _mm_sub_epi8(x, a);
+		__m128i upValue = _mm_sub_epi8(x, b);
+		__m128i paethValue = _mm_sub_epi8(x, predictor);
+		_mm_storeu_si128((__m128i*)(sub + i), subValue);
+		_mm_storeu_si128((__m128i*)(up + i), upValue);
+		_mm_storeu_si128((__m128i*)(paeth + i), paethValue);
+
+		noneTotal = _mm_add_epi64(noneTotal, sumAbs(x));
+		subTotal = _mm_add_epi64(subTotal, sumAbs(subValue));
+		upTotal = _mm_add_epi64(upTotal, sumAbs(upValue));
+		paethTotal = _mm_add_epi64(paethTotal, sumAbs(paethValue));
+	}
+
+	noneSum = _mm_cvtsi128_si32(noneTotal) + _mm_cvtsi128_si32(_mm_srli_si128(noneTotal, 8));
+	subSum = _mm_cvtsi128_si32(subTotal) + _mm_cvtsi128_si32(_mm_srli_si128(subTotal, 8));
+	upSum = _mm_cvtsi128_si32(upTotal) + _mm_cvtsi128_si32(_mm_srli_si128(upTotal, 8));
+	paethSum = _mm_cvtsi128_si32(paethTotal) + _mm_cvtsi128_si32(_mm_srli_si128(paethTotal, 8));
+#endif
+
+	for(; i < rowSize; i++) {
+		uint8_t x = row[i];
+		int a = row[i - bytesPerPixel];
+		int b = prevRow[i];
+		int c = prevRow[i - bytesPerPixel];
+
+		int pa = std::abs(b - c);
+		int pb = std::abs(a - c);
+		int pc = std::abs(a + b - 2 * c);
+		uint8_t predictor = (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+
+		sub[i] = x - a;
+		up[i] = x - b;
+		paeth[i] = x - predictor;
+
+		noneSum += std::abs((int8_t)x);
+		subSum += std::abs((int8_t)sub[i]);
+		upSum += std::abs((int8_t)up[i]);
+		paethSum += std::abs((int8_t)paeth[i]);
+	}
+
+	uint32_t best = std::min({ noneSum, subSum, upSum, paethSum });
+	if(best == noneSum) {
+		return nullptr;
+	} else if(best == subSum) {
+		return sub - 1;
+	} else if(best == upSum) {
+		return up - 1;
+	} else {
+		return paeth - 1;
+	}
+}
+
+bool PNGWriter::Encode(const uint32_t* buffer, uint32_t width, uint32_t height, uint32_t bitsPerPixel, uint32_t compressionLevel, const OutputFunc& output)
+{
+	if(bitsPerPixel != 24 && bitsPerPixel != 32) {
+		return false;
+	}
+
+	bool withAlpha = bitsPerPixel == 32;
+	uint32_t bytesPerPixel = bitsPerPixel / 8;
+	uint32_t rowSize = width * bytesPerPixel;
+
+	//Reused across calls to avoid allocating the compressor's state (~300kb) for every image
+	thread_local unique_ptr<tdefl_compressor> compressor;
+	if(!compressor) {
+		compressor.reset(new tdefl_compressor());
+	}
+
+	PNGChunkWriter writer(output);
+
+	static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	if(!output(signature, 8)) {
+		return false;
+	}
+
+	uint8_t ihdr[13] = {
+		(uint8_t)(width >> 24), (uint8_t)(width >> 16), (uint8_t)(width >> 8), (uint8_t)width,
+		(uint8_t)(height >> 24), (uint8_t)(height >> 16), (uint8_t)(height >> 8), (uint8_t)height,
+		8, (uint8_t)(withAlpha ? 6 : 2), 0, 0, 0 //8-bit RGB(A), deflate, adaptive filtering, no interlacing
+	};
+	writer.WriteChunk("IHDR", ihdr, 13);
+
+	mz_uint flags = tdefl_create_comp_flags_from_zip_params(std::min(compressionLevel, 10u), 15, MZ_DEFAULT_STRATEGY);
+	tdefl_init(compressor.get(), PNGChunkWriter::PutBuffer, &writer, flags);
+
+	//Each row buffer contains 4 zero bytes (used by FilterRow for the first pixel), the filter
+	//type byte (0 = none), the pixels and 16 bytes of padding (for ConvertRow's SIMD stores)
+	vector<uint8_t> rows[2];
+	rows[0].resize(4 + rowSize + 1 + 16, 0);
+	rows[1].resize(4 + rowSize + 1 + 16, 0);
+	vector<uint8_t> filterBuffers((rowSize + 1) * 3);
+
+	for(uint32_t y = 0; y < height; y++) {
+		uint8_t* row = rows[y & 1].data() + 4;
+		uint8_t* prevRow = rows[(y & 1) ^ 1].data() + 4;
+		ConvertRow(buffer + y * width, row + 1, width, withAlpha);
+
+		uint8_t* filteredRow = compressionLevel > 0 ? FilterRow(row + 1, prevRow + 1, rowSize, bytesPerPixel, filterBuffers.data()) : nullptr;
+		if(tdefl_compress_buffer(compressor.get(), filteredRow ? filteredRow : row, rowSize + 1, TDEFL_NO_FLUSH) != TDEFL_STATUS_OKAY) {
+			return false;
+		}
+	}
+
+	if(tdefl_compress_buffer(compressor.get(), nullptr, 0, TDEFL_FINISH) != TDEFL_STATUS_DONE) {
+		return false;
+	}
+
+	writer.FlushIdat();
+	writer.WriteChunk("IEND", nullptr, 0);
+	return !writer.Failed;
+}
+
+bool PNGWriter::Write(ostream& stream, const uint32_t* buffer, uint32_t width, uint32_t height, uint32_t bitsPerPixel, uint32_t compressionLevel)
+{
+	return Encode(buffer, width, height, bitsPerPixel, compressionLevel, [&stream](const uint8_t* data, size_t size) {
+		stream.write((const char*)data, size);
+		return stream.good();
+	});
+}
+
+bool PNGWriter::Write(vector<uint8_t>& output, const uint32_t* buffer, uint32_t width, uint32_t height, uint32_t bitsPerPixel, uint32_t compressionLevel)
+{
+	return Encode(buffer, width, height, bitsPerPixel, compressionLevel, [&output](const uint8_t* data, size_t size) {
+		output.insert(output.end(), data, data + size);
+		return true;
+	});
+}
+
+bool PNGWriter::Write(string filename, const uint32_t* buffer, uint32_t width, uint32_t height, uint32_t bitsPerPixel, uint32_t compressionLevel)
+{
+	ofstream file(filename, std::ios::out | std::ios::binary);
+	if(!file) {
+		return false;
+	}
+	return Write(file, buffer, width, height, bitsPerPixel, compressionLevel);
+}
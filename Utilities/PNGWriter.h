@@ -0,0 +1,21 @@
+#pragma once
+#include "pch.h"
+#include <functional>
+
+//PNG encoder for 32-bit ARGB frame buffers
+//Pixels are swizzled with SIMD where available, each row uses the filter (None/Sub/Up/Paeth) that
+//minimizes the sum of absolute differences, and the compressed data is streamed directly to the output.
+class PNGWriter
+{
+private:
+	typedef std::function<bool(const uint8_t* data, size_t size)> OutputFunc;
+
+	static void ConvertRow(const uint32_t* src, uint8_t* dst, uint32_t width, bool withAlpha);
+	static uint8_t* FilterRow(const uint8_t* row, const uint8_t* prevRow, uint32_t rowSize, uint32_t bytesPerPixel, uint8_t* filterBuffers);
+	static bool Encode(const uint32_t* buffer, uint32_t width, uint32_t height, uint32_t bitsPerPixel, uint32_t compressionLevel, const OutputFunc& output);
+
+public:
+	static bool Write(ostream& stream, const uint32_t* buffer, uint32_t width, uint32_t height, uint32_t bitsPerPixel = 24, uint32_t compressionLevel = 6);
+	static bool Write(vector<uint8_t>& output, const uint32_t* buffer, uint32_t width, uint32_t height, uint32_t bitsPerPixel = 24, uint32_t compressionLevel = 6);
+	static bool Write(string filename, const uint32_t* buffer, uint32_t width, uint32_t height, uint32_t bitsPerPixel = 24, uint32_t compressionLevel = 6);
+};
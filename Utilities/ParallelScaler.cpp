@@ -0,0 +1,183 @@
+#include "pch.h"
+#include "ParallelScaler.h"
+#include "HQX/hqx.h"
+#include "Scale2x/scalebit.h"
+#include "KreedSaiEagle/SaiEagle.h"
+
+ParallelScaler::ParallelScaler(uint32_t threadCount)
+{
+	if(threadCount == 0) {
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	//The calling thread also processes bands, so it counts as one of the threads
+	for(uint32_t i = 1; i < threadCount; i++) {
+		_workers.push_back(std::thread([this]() { WorkerThread(); }));
+	}
+}
+
+ParallelScaler::~ParallelScaler()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopFlag = true;
+		_workAvailable.notify_all();
+	}
+
+	for(std::thread& worker : _workers) {
+		worker.join();
+	}
+}
+
+uint32_t ParallelScaler::GetThreadCount()
+{
+	return (uint32_t)_workers.size() + 1;
+}
+
+void ParallelScaler::WorkerThread()
+{
+	uint32_t generation = 0;
+	while(true) {
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_workAvailable.wait(lock, [&] { return _stopFlag || _generation != generation; });
+			if(_stopFlag) {
+				break;
+			}
+			generation = _generation;
+			_activeWorkers++;
+		}
+
+		ProcessBands();
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		_activeWorkers--;
+		_workDone.notify_all();
+	}
+}
+
+void ParallelScaler::ProcessBands()
+{
+	uint32_t band;
+	while((band = _nextBand++) < _bandCount) {
+		uint32_t yFirst = band * _bandSize;
+		uint32_t yLast = std::min(_height, yFirst + _bandSize);
+		(*_scaleRows)(yFirst, yLast);
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		_completedBands++;
+	}
+}
+
+void ParallelScaler::Run(uint32_t height, uint32_t minRowsPerBand, const std::function<void(uint32_t yFirst, uint32_t yLast)>& scaleRows)
+{
+	uint32_t threadCount = GetThreadCount();
+	minRowsPerBand = std::max(1u, minRowsPerBand);
+	if(threadCount == 1 || height < minRowsPerBand * 2) {
+		scaleRows(0, height);
+		return;
+	}
+
+	//Use a few more bands than threads, so threads that finish early can pick up some of the remaining work
+	uint32_t bandCount = std::min((height + minRowsPerBand - 1) / minRowsPerBand, threadCount * 2);
+	uint32_t bandSize = (height + bandCount - 1) / bandCount;
+
+	std::lock_guard<std::mutex> runLock(_runLock);
+	{
+		//A worker may have woken up too late to help with the previous call, wait for it to go back to sleep
+		std::unique_lock<std::mutex> workLock(_mutex);
+		_workDone.wait(workLock, [this] { return _activeWorkers == 0; });
+
+		_scaleRows = &scaleRows;
+		_height = height;
+		_bandSize = bandSize;
+		_bandCount = (height + bandSize - 1) / bandSize;
+		_completedBands = 0;
+		_nextBand = 0;
+		_generation++;
+		_workAvailable.notify_all();
+	}
+
+	ProcessBands();
+
+	//Wait until all bands are done and all workers are idle, before the parameters are modified by the next call
+	std::unique_lock<std::mutex> workLock(_mutex);
+	_workDone.wait(workLock, [this] { return _completedBands == _bandCount && _activeWorkers == 0; });
+	_scaleRows = nullptr;
+}
+
+void ParallelScaler::Xbrz(uint32_t scale, const uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height, xbrz::ColorFormat format, const xbrz::ScalerCfg& cfg)
+{
+	Run(height, MinRowsPerBand, [=, &cfg](uint32_t yFirst, uint32_t yLast) {
+		xbrz::scale(scale, src, dst, width, height, format, cfg, yFirst, yLast);
+	});
+}
+
+void ParallelScaler::Hqx(uint32_t scale, uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height)
+{
+	uint32_t srcPitch = width * sizeof(uint32_t);
+	uint32_t dstPitch = srcPitch * scale;
+	Run(height, MinRowsPerBand, [=](uint32_t yFirst, uint32_t yLast) {
+		switch(scale) {
+			case 2: hq2x_32_rb(src, srcPitch, dst, dstPitch, width, height, yFirst, yLast); break;
+			case 3: hq3x_32_rb(src, srcPitch, dst, dstPitch, width, height, yFirst, yLast); break;
+			case 4: hq4x_32_rb(src, srcPitch, dst, dstPitch, width, height, yFirst, yLast); break;
+		}
+	});
+}
+
+void ParallelScaler::Scale2x(uint32_t scale, uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height)
+{
+	uint32_t srcPitch = width * sizeof(uint32_t);
+	uint32_t dstPitch = srcPitch * scale;
+	Run(height, MinRowsPerBand, [=](uint32_t yFirst, uint32_t yLast) {
+		scale_rows(scale, dst, dstPitch, src, srcPitch, sizeof(uint32_t), width, height, yFirst, yLast);
+	});
+}
+
+void ParallelScaler::TwoXSai(uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height)
+{
+	Run(height, MinRowsPerBand, [=](uint32_t yFirst, uint32_t yLast) {
+		twoxsai_generic_xrgb8888(width, height, src, width, dst, width * 2, yFirst, yLast);
+	});
+}
+
+void ParallelScaler::SuperTwoXSai(uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height)
+{
+	Run(height, MinRowsPerBand, [=](uint32_t yFirst, uint32_t yLast) {
+		supertwoxsai_generic_xrgb8888(width, height, src, width, dst, width * 2, yFirst, yLast);
+	});
+}
+
+void ParallelScaler::SuperEagle(uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height)
+{
+	Run(height, MinRowsPerBand, [=](uint32_t yFirst, uint32_t yLast) {
+		supereagle_generic_xrgb8888(width, height, src, width, dst, width * 2, yFirst, yLast);
+	});
+}
+
+void ParallelScaler::NesNtsc(const nes_ntsc_t* ntsc, const uint16_t* src, uint32_t width, uint32_t height, int burstPhase, uint32_t* dst, uint32_t dstPitch)
+{
+	Run(height, MinRowsPerBand, [=](uint32_t yFirst, uint32_t yLast) {
+		nes_ntsc_blit(ntsc, src + yFirst * width, width, (burstPhase + yFirst) % nes_ntsc_burst_count, width, yLast - yFirst, (uint8_t*)dst + yFirst * dstPitch, dstPitch);
+	});
+}
+
+void ParallelScaler::SnesNtsc(const snes_ntsc_t* ntsc, const uint16_t* src, uint32_t srcWidth, uint32_t width, uint32_t height, int burstPhase, bool hires, uint32_t* dst, uint32_t dstPitch)
+{
+	Run(height, MinRowsPerBand, [=](uint32_t yFirst, uint32_t yLast) {
+		int burst = (burstPhase + yFirst) % snes_ntsc_burst_count;
+		if(hires) {
+			snes_ntsc_blit_hires(ntsc, src + yFirst * srcWidth, srcWidth, burst, width, yLast - yFirst, (uint8_t*)dst + yFirst * dstPitch, dstPitch);
+		} else {
+			snes_ntsc_blit(ntsc, src + yFirst * srcWidth, srcWidth, burst, width, yLast - yFirst, (uint8_t*)dst + yFirst * dstPitch, dstPitch);
+		}
+	});
+}
+
+void ParallelScaler::SmsNtsc(const sms_ntsc_t* ntsc, const uint16_t* src, uint32_t width, uint32_t height, uint32_t* dst, uint32_t dstPitch)
+{
+	Run(height, MinRowsPerBand, [=](uint32_t yFirst, uint32_t yLast) {
+		sms_ntsc_blit(ntsc, src + yFirst * width, width, width, yLast - yFirst, (uint8_t*)dst + yFirst * dstPitch, dstPitch);
+	});
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "pch.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "xBRZ/xbrz.h"
+#include "NTSC/nes_ntsc.h"
+#include "NTSC/snes_ntsc.h"
+#include "NTSC/sms_ntsc.h"
+
+//Runs the software scalers on multiple threads
+//Each frame is split into bands of rows which are processed by a persistent pool of worker threads (and
+//by the calling thread). Every band reads the rows above/below it that the filter needs directly from the
+//source image, but only writes the output rows for its own rows, so the bands never overlap in the output.
+class ParallelScaler
+{
+private:
+	static constexpr uint32_t MinRowsPerBand = 16;
+
+	vector<std::thread> _workers;
+	std::mutex _runLock;
+
+	std::mutex _mutex;
+	std::condition_variable _workAvailable;
+	std::condition_variable _workDone;
+	bool _stopFlag = false;
+	uint32_t _generation = 0;
+	uint32_t _activeWorkers = 0;
+
+	const std::function<void(uint32_t, uint32_t)>* _scaleRows = nullptr;
+	uint32_t _height = 0;
+	uint32_t _bandSize = 0;
+	uint32_t _bandCount = 0;
+	uint32_t _completedBands = 0;
+	atomic<uint32_t> _nextBand;
+
+	void WorkerThread();
+	void ProcessBands();
+
+public:
+	//threadCount is the total number of threads used, including the calling thread (0 = one per core)
+	ParallelScaler(uint32_t threadCount = 0);
+	~ParallelScaler();
+
+	uint32_t GetThreadCount();
+
+	//Calls scaleRows(yFirst, yLast) for bands of rows covering [0, height), in parallel, and returns once they are all done
+	void Run(uint32_t height, uint32_t minRowsPerBand, const std::function<void(uint32_t yFirst, uint32_t yLast)>& scaleRows);
+
+	void Xbrz(uint32_t scale, const uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height, xbrz::ColorFormat format, const xbrz::ScalerCfg& cfg = xbrz::ScalerCfg());
+	void Hqx(uint32_t scale, uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height);
+	void Scale2x(uint32_t scale, uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height);
+	void TwoXSai(uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height);
+	void SuperTwoXSai(uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height);
+	void SuperEagle(uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height);
+
+	//NTSC filters - each row only depends on its own input and on its burst phase ((burstPhase + row) % 3)
+	void NesNtsc(const nes_ntsc_t* ntsc, const uint16_t* src, uint32_t width, uint32_t height, int burstPhase, uint32_t* dst, uint32_t dstPitch);
+	void SnesNtsc(const snes_ntsc_t* ntsc, const uint16_t* src, uint32_t srcWidth, uint32_t width, uint32_t height, int burstPhase, bool hires, uint32_t* dst, uint32_t dstPitch);
+	void SmsNtsc(const sms_ntsc_t* ntsc, const uint16_t* src, uint32_t width, uint32_t height, uint32_t* dst, uint32_t dstPitch);
+};
@@ -3,6 +3,10 @@
 
 #ifdef _WIN32
 #include <Windows.h>
+#include <Psapi.h>
+#elif defined(__linux__)
+#include <fstream>
+#include <unistd.h>
 #endif
 
 void PlatformUtilities::DisableScreensaver()
@@ -34,4 +38,25 @@ void PlatformUtilities::RestoreTimerResolution()
 	#ifdef _WIN32
 	timeEndPeriod(1);
 	#endif
-}
\ No newline at end of file
+}
+
+size_t PlatformUtilities::GetResidentMemory()
+{
+	#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters = {};
+	if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return counters.WorkingSetSize;
+	}
+	return 0;
+	#elif defined(__linux__)
+	//statm: total program size, resident set size (in pages)
+	std::ifstream statm("/proc/self/statm");
+	size_t size = 0, resident = 0;
+	if(statm >> size >> resident) {
+		return resident * (size_t)sysconf(_SC_PAGESIZE);
+	}
+	return 0;
+	#else
+	return 0;
+	#endif
+}
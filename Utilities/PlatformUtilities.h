@@ -9,4 +9,7 @@ public:
 
 	static void EnableHighResolutionTimer();
 	static void RestoreTimerResolution();
+
+	//Physical memory currently used by the process, in bytes (0 if not supported on this platform)
+	static size_t GetResidentMemory();
 };
\ No newline at end of file
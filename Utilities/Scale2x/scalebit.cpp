@@ -471,3 +471,99 @@ void scale(unsigned scale, void* void_dst, unsigned dst_slice, const void* void_
 	}
 }
 
+#define ROW_ABOVE(y) ((y) > 0 ? (y) - 1 : 0)
+#define ROW_BELOW(y, height) ((y) + 1 < (height) ? (y) + 1 : (y))
+
+/**
+ * Apply the Scale4x effect on a slice of rows of a bitmap. Used internally.
+ */
+static void scale4x_rows(void* void_dst, unsigned dst_slice, const void* void_src, unsigned src_slice, unsigned pixel, unsigned width, unsigned height, unsigned row_first, unsigned row_last)
+{
+	unsigned char* dst = (unsigned char*)void_dst;
+	const unsigned char* src = (const unsigned char*)void_src;
+	unsigned char* mid;
+	unsigned mid_slice;
+	unsigned mid_first;
+	unsigned mid_last;
+	unsigned y;
+
+	/* the source rows used by the slice are first scaled by 2x into the intermediate buffer */
+	mid_first = ROW_ABOVE(row_first);
+	mid_last = ROW_BELOW(row_last - 1, height);
+
+	mid_slice = 2 * pixel * width;
+	mid_slice = (mid_slice + 0x7) & ~0x7; /* align to 8 bytes */
+
+	mid = (unsigned char*)malloc(2 * (mid_last - mid_first + 1) * mid_slice);
+	if (!mid)
+		return;
+
+#define SCMIDROW(i) (mid + ((i) - 2 * mid_first) * mid_slice)
+
+	for (y = mid_first; y <= mid_last; ++y)
+		stage_scale2x(SCMIDROW(2 * y), SCMIDROW(2 * y + 1), SCSRC(ROW_ABOVE(y)), SCSRC(y), SCSRC(ROW_BELOW(y, height)), pixel, width);
+
+	for (y = row_first; y < row_last; ++y) {
+		/* intermediate rows 2y-1 to 2y+2, clamped to the bitmap */
+		unsigned above = y > 0 ? 2 * y - 1 : 0;
+		unsigned below = y + 1 < height ? 2 * y + 2 : 2 * y + 1;
+		stage_scale4x(SCDST(4 * y), SCDST(4 * y + 1), SCDST(4 * y + 2), SCDST(4 * y + 3), SCMIDROW(above), SCMIDROW(2 * y), SCMIDROW(2 * y + 1), SCMIDROW(below), pixel, width);
+	}
+
+#undef SCMIDROW
+
+	free(mid);
+}
+
+/**
+ * Apply the Scale effect on a slice of rows of a bitmap.
+ * The result is the same as calling ::scale() on the whole bitmap, but only the
+ * rows [row_first, row_last) of the source bitmap are processed. This allows
+ * multiple threads to process different slices of the same bitmap.
+ * \param scale Scale factor. 2, 203 (fox 2x3), 204 (for 2x4), 3 or 4.
+ * \param void_dst Pointer at the first pixel of the destination bitmap (not of the slice).
+ * \param dst_slice Size in bytes of a destination bitmap row.
+ * \param void_src Pointer at the first pixel of the source bitmap (not of the slice).
+ * \param src_slice Size in bytes of a source bitmap row.
+ * \param pixel Bytes per pixel of the source and destination bitmap.
+ * \param width Horizontal size in pixels of the source bitmap.
+ * \param height Vertical size in pixels of the source bitmap.
+ * \param row_first First source row to process.
+ * \param row_last Source row after the last row to process.
+ */
+void scale_rows(unsigned scale, void* void_dst, unsigned dst_slice, const void* void_src, unsigned src_slice, unsigned pixel, unsigned width, unsigned height, unsigned row_first, unsigned row_last)
+{
+	unsigned char* dst = (unsigned char*)void_dst;
+	const unsigned char* src = (const unsigned char*)void_src;
+	unsigned y;
+
+	if (row_last > height)
+		row_last = height;
+	if (row_first >= row_last)
+		return;
+
+	switch (scale) {
+	case 202 :
+	case 2 :
+		for (y = row_first; y < row_last; ++y)
+			stage_scale2x(SCDST(2 * y), SCDST(2 * y + 1), SCSRC(ROW_ABOVE(y)), SCSRC(y), SCSRC(ROW_BELOW(y, height)), pixel, width);
+		break;
+	case 203 :
+		for (y = row_first; y < row_last; ++y)
+			stage_scale2x3(SCDST(3 * y), SCDST(3 * y + 1), SCDST(3 * y + 2), SCSRC(ROW_ABOVE(y)), SCSRC(y), SCSRC(ROW_BELOW(y, height)), pixel, width);
+		break;
+	case 204 :
+		for (y = row_first; y < row_last; ++y)
+			stage_scale2x4(SCDST(4 * y), SCDST(4 * y + 1), SCDST(4 * y + 2), SCDST(4 * y + 3), SCSRC(ROW_ABOVE(y)), SCSRC(y), SCSRC(ROW_BELOW(y, height)), pixel, width);
+		break;
+	case 303 :
+	case 3 :
+		for (y = row_first; y < row_last; ++y)
+			stage_scale3x(SCDST(3 * y), SCDST(3 * y + 1), SCDST(3 * y + 2), SCSRC(ROW_ABOVE(y)), SCSRC(y), SCSRC(ROW_BELOW(y, height)), pixel, width);
+		break;
+	case 404 :
+	case 4 :
+		scale4x_rows(void_dst, dst_slice, void_src, src_slice, pixel, width, height, row_first, row_last);
+		break;
+	}
+}
@@ -0,0 +1,478 @@
+#include "pch.h"
+#include <random>
+#include "ScalerBenchmark.h"
+#include "ParallelScaler.h"
+#include "PNGHelper.h"
+#include "CRC32.h"
+#include "Timer.h"
+#include "PlatformUtilities.h"
+#include "NTSC/nes_ntsc.h"
+#include "HQX/hqx.h"
+#include "HQX/common.h"
+
+ScalerBenchmark::ScalerBenchmark()
+{
+	InitPalette();
+	AddGeneratedFrames();
+}
+
+void ScalerBenchmark::InitPalette()
+{
+	//Approximation of the NES palette, using integers only so the frames are identical on all platforms
+	static const int hues[12][3] = {
+		{ 0, 0, 4 }, { 2, 0, 4 }, { 3, 0, 3 }, { 4, 0, 2 }, { 4, 0, 0 }, { 4, 1, 0 },
+		{ 3, 2, 0 }, { 2, 3, 0 }, { 0, 4, 0 }, { 0, 4, 1 }, { 0, 3, 3 }, { 0, 2, 4 }
+	};
+
+	for(int i = 0; i < 64; i++) {
+		int hue = i & 0x0F;
+		int luma = i >> 4;
+		int r, g, b;
+		if(hue >= 0x0D) {
+			r = g = b = hue == 0x0D && luma > 0 ? luma * 40 : 0;
+		} else if(hue == 0) {
+			r = g = b = 80 + luma * 55;
+		} else {
+			int base = luma * 56;
+			r = std::min(255, base + hues[hue - 1][0] * 30);
+			g = std::min(255, base + hues[hue - 1][1] * 30);
+			b = std::min(255, base + hues[hue - 1][2] * 30);
+		}
+		_palette[i] = 0xFF000000 | (r << 16) | (g << 8) | b;
+	}
+}
+
+void ScalerBenchmark::SetIndexes(Frame& frame, vector<uint16_t>&& indexes)
+{
+	frame.Indexes = std::move(indexes);
+	frame.Argb.resize(frame.Indexes.size());
+	for(size_t i = 0; i < frame.Indexes.size(); i++) {
+		frame.Argb[i] = _palette[frame.Indexes[i] & 0x3F];
+	}
+}
+
+void ScalerBenchmark::AddGeneratedFrames()
+{
+	//Raw mt19937 output is the same on all platforms (unlike the std distributions)
+	std::mt19937 rng(0x5CA1E);
+	constexpr uint32_t width = 256;
+	constexpr uint32_t height = 240;
+
+	//Background made of 8x8 tiles with 4 colors each
+	{
+		uint8_t tiles[32][64];
+		uint8_t tilePalettes[32][4];
+		for(int i = 0; i < 32; i++) {
+			for(int j = 0; j < 64; j++) {
+				//Mostly uniform areas with some details, like actual game graphics
+				tiles[i][j] = (rng() % 4 == 0) ? rng() % 4 : (j > 0 ? tiles[i][j - 1] : 0);
+			}
+			for(int j = 0; j < 4; j++) {
+				tilePalettes[i][j] = j == 0 ? 0x0F : rng() % 64;
+			}
+		}
+
+		vector<uint16_t> indexes(width * height);
+		for(uint32_t ty = 0; ty < height / 8; ty++) {
+			for(uint32_t tx = 0; tx < width / 8; tx++) {
+				uint32_t tile = rng() % 32;
+				for(int y = 0; y < 8; y++) {
+					for(int x = 0; x < 8; x++) {
+						indexes[(ty * 8 + y) * width + tx * 8 + x] = tilePalettes[tile][tiles[tile][y * 8 + x]];
+					}
+				}
+			}
+		}
+		_frames.push_back({ width, height, {}, {}, true });
+		SetIndexes(_frames.back(), std::move(indexes));
+	}
+
+	//Sky, brick ground and sprites (large flat areas)
+	{
+		vector<uint16_t> indexes(width * height);
+		for(uint32_t y = 0; y < height; y++) {
+			for(uint32_t x = 0; x < width; x++) {
+				uint16_t color = 0x21;
+				if(y >= 176) {
+					bool mortar = (y % 8) == 0 || ((x + ((y / 8) % 2) * 8) % 16) == 0;
+					color = mortar ? 0x0F : 0x17;
+				}
+				indexes[y * width + x] = color;
+			}
+		}
+
+		for(int i = 0; i < 12; i++) {
+			uint32_t left = rng() % (width - 16);
+			uint32_t top = rng() % (height - 16);
+			uint16_t colors[3] = { (uint16_t)(rng() % 64), (uint16_t)(rng() % 64), 0x30 };
+			for(int y = 0; y < 16; y++) {
+				for(int x = 0; x < 16; x++) {
+					//Symmetrical sprite with transparent pixels
+					uint32_t value = (rng() >> 8) % 4;
+					if(value > 0) {
+						indexes[(top + y) * width + left + x] = colors[value - 1];
+						indexes[(top + y) * width + left + 15 - x] = colors[value - 1];
+					}
+				}
+			}
+		}
+		_frames.push_back({ width, height, {}, {}, true });
+		SetIndexes(_frames.back(), std::move(indexes));
+	}
+
+	//Random noise including color emphasis bits (worst case for most filters)
+	{
+		vector<uint16_t> indexes(width * height);
+		for(uint16_t& index : indexes) {
+			index = rng() % 512;
+		}
+		_frames.push_back({ width, height, {}, {}, true });
+		SetIndexes(_frames.back(), std::move(indexes));
+	}
+}
+
+bool ScalerBenchmark::AddFrame(string pngFile)
+{
+	vector<uint8_t> pngData;
+	uint32_t width, height;
+	if(!PNGHelper::ReadPNG(pngFile, pngData, width, height) || width == 0 || height == 0) {
+		return false;
+	}
+
+	Frame frame = { width, height, {}, {}, false };
+	frame.Argb.resize(width * height);
+	memcpy(frame.Argb.data(), pngData.data(), frame.Argb.size() * sizeof(uint32_t));
+
+	//Use the closest palette color as the NTSC filter's input
+	frame.Indexes.resize(frame.Argb.size());
+	for(size_t i = 0; i < frame.Argb.size(); i++) {
+		uint32_t color = frame.Argb[i];
+		int bestDist = INT32_MAX;
+		for(int j = 0; j < 64; j++) {
+			int r = (int)((color >> 16) & 0xFF) - (int)((_palette[j] >> 16) & 0xFF);
+			int g = (int)((color >> 8) & 0xFF) - (int)((_palette[j] >> 8) & 0xFF);
+			int b = (int)(color & 0xFF) - (int)(_palette[j] & 0xFF);
+			int dist = r * r + g * g + b * b;
+			if(dist < bestDist) {
+				bestDist = dist;
+				frame.Indexes[i] = j;
+			}
+		}
+	}
+
+	_frames.push_back(std::move(frame));
+	return true;
+}
+
+vector<ScalerBenchmark::Filter> ScalerBenchmark::GetFilters(ParallelScaler& scaler)
+{
+	vector<Filter> filters;
+	for(uint32_t scale = 2; scale <= 6; scale++) {
+		filters.push_back({ "xBRZ " + std::to_string(scale) + "x", [&scaler, scale](const Frame& f, uint32_t* out) {
+			scaler.Xbrz(scale, f.Argb.data(), out, f.Width, f.Height, xbrz::ColorFormat::RGB);
+			return f.Width * f.Height * scale * scale;
+		} });
+	}
+	for(uint32_t scale = 2; scale <= 4; scale++) {
+		filters.push_back({ "HQ" + std::to_string(scale) + "x", [&scaler, scale](const Frame& f, uint32_t* out) {
+			scaler.Hqx(scale, (uint32_t*)f.Argb.data(), out, f.Width, f.Height);
+			return f.Width * f.Height * scale * scale;
+		} });
+	}
+	for(uint32_t scale = 2; scale <= 4; scale++) {
+		filters.push_back({ "Scale" + std::to_string(scale) + "x", [&scaler, scale](const Frame& f, uint32_t* out) {
+			scaler.Scale2x(scale, (uint32_t*)f.Argb.data(), out, f.Width, f.Height);
+			return f.Width * f.Height * scale * scale;
+		} });
+	}
+	filters.push_back({ "2xSaI", [&scaler](const Frame& f, uint32_t* out) {
+		scaler.TwoXSai((uint32_t*)f.Argb.data(), out, f.Width, f.Height);
+		return f.Width * f.Height * 4;
+	} });
+	filters.push_back({ "Super2xSaI", [&scaler](const Frame& f, uint32_t* out) {
+		scaler.SuperTwoXSai((uint32_t*)f.Argb.data(), out, f.Width, f.Height);
+		return f.Width * f.Height * 4;
+	} });
+	filters.push_back({ "SuperEagle", [&scaler](const Frame& f, uint32_t* out) {
+		scaler.SuperEagle((uint32_t*)f.Argb.data(), out, f.Width, f.Height);
+		return f.Width * f.Height * 4;
+	} });
+
+	shared_ptr<nes_ntsc_t> ntsc(new nes_ntsc_t());
+	nes_ntsc_init(ntsc.get(), &nes_ntsc_composite);
+	filters.push_back({ "NTSC", [&scaler, ntsc](const Frame& f, uint32_t* out) {
+		uint32_t outWidth = NES_NTSC_OUT_WIDTH(f.Width);
+		scaler.NesNtsc(ntsc.get(), f.Indexes.data(), f.Width, f.Height, 0, out, outWidth * sizeof(uint32_t));
+		return outWidth * f.Height;
+	} });
+
+	return filters;
+}
+
+size_t ScalerBenchmark::GetMaxOutputSize()
+{
+	size_t maxOutputSize = 0;
+	for(Frame& frame : _frames) {
+		maxOutputSize = std::max<size_t>(maxOutputSize, std::max<size_t>(frame.Width * 6, NES_NTSC_OUT_WIDTH(frame.Width)) * frame.Height * 6);
+	}
+	return maxOutputSize;
+}
+
+vector<ScalerBenchmark::Result> ScalerBenchmark::Run(uint32_t iterations, uint32_t threadCount)
+{
+	iterations = std::max(1u, iterations);
+	ParallelScaler scaler(threadCount);
+
+	vector<uint32_t> output(GetMaxOutputSize());
+
+	vector<Result> results;
+	for(Filter& filter : GetFilters(scaler)) {
+		vector<double> frameTimes;
+		vector<uint32_t> crcs;
+		double totalTime = 0;
+		uint64_t totalPixels = 0;
+
+		//Warm up (lookup tables, thread pool, caches) before measuring
+		filter.Run(_frames[0], output.data());
+
+		for(Frame& frame : _frames) {
+			for(uint32_t i = 0; i < iterations; i++) {
+				Timer timer;
+				uint32_t outputSize = filter.Run(frame, output.data());
+				double time = timer.GetElapsedMS();
+
+				frameTimes.push_back(time);
+				totalTime += time;
+				totalPixels += frame.Width * frame.Height;
+				if(i == 0 && frame.Generated) {
+					crcs.push_back(CRC32::GetCRC((uint8_t*)output.data(), outputSize * sizeof(uint32_t)));
+				}
+			}
+		}
+
+		std::sort(frameTimes.begin(), frameTimes.end());
+		auto percentile = [&](double p) { return frameTimes[std::min(frameTimes.size() - 1, (size_t)(p * frameTimes.size()))]; };
+
+		Result result = {};
+		result.Name = filter.Name;
+		result.MegaPixelsPerSecond = totalTime > 0 ? totalPixels / totalTime / 1000.0 : 0;
+		result.AverageMs = totalTime / frameTimes.size();
+		result.P50Ms = percentile(0.50);
+		result.P95Ms = percentile(0.95);
+		result.P99Ms = percentile(0.99);
+		result.Crc = CRC32::GetCRC((uint8_t*)crcs.data(), crcs.size() * sizeof(uint32_t));
+		result.GoldenCrc = GetGoldenCrc(filter.Name);
+		result.Passed = result.GoldenCrc == 0 || result.GoldenCrc == result.Crc;
+		results.push_back(result);
+	}
+	return results;
+}
+
+vector<ScalerBenchmark::TierResult> ScalerBenchmark::CompareTiers(uint32_t threadCount)
+{
+	ParallelScaler scaler(threadCount);
+	vector<Filter> filters = GetFilters(scaler);
+	for(uint32_t scale = 2; scale <= 6; scale++) {
+		filters.push_back({ "xBRZ " + std::to_string(scale) + "x ARGB", [&scaler, scale](const Frame& f, uint32_t* out) {
+			//The generated frames are opaque, give the pixels a few different alpha values
+			vector<uint32_t> src(f.Argb.size());
+			for(size_t i = 0; i < src.size(); i++) {
+				src[i] = (f.Argb[i] & 0xFFFFFF) | ((uint32_t)(i % 7 < 4 ? 0xFF : (i % 7 - 4) * 0x55) << 24);
+			}
+			scaler.Xbrz(scale, src.data(), out, f.Width, f.Height, xbrz::ColorFormat::ARGB);
+			return f.Width * f.Height * scale * scale;
+		} });
+	}
+
+	vector<CpuTier> tiers;
+	for(CpuTier tier : { CpuTier::Sse2, CpuTier::Ssse3, CpuTier::Avx2, CpuTier::Avx512, CpuTier::Neon }) {
+		if(CpuFeatures::IsSupported(tier)) {
+			tiers.push_back(tier);
+		}
+	}
+
+	size_t maxOutputSize = GetMaxOutputSize();
+	vector<uint32_t> scalarOutput(maxOutputSize);
+	vector<uint32_t> output(maxOutputSize);
+
+	vector<TierResult> results;
+	for(Filter& filter : filters) {
+		size_t first = results.size();
+		for(CpuTier tier : tiers) {
+			results.push_back({ filter.Name, tier, 0 });
+		}
+
+		for(Frame& frame : _frames) {
+			CpuFeatures::SetMaxTier(CpuTier::Scalar);
+			uint32_t outputSize = filter.Run(frame, scalarOutput.data());
+
+			for(size_t i = 0; i < tiers.size(); i++) {
+				CpuFeatures::SetMaxTier(tiers[i]);
+				std::fill(output.begin(), output.begin() + outputSize, 0);
+				filter.Run(frame, output.data());
+				if(memcmp(output.data(), scalarOutput.data(), outputSize * sizeof(uint32_t)) != 0) {
+					results[first + i].MismatchCount++;
+				}
+			}
+		}
+	}
+
+	CpuFeatures::ResetMaxTier();
+	return results;
+}
+
+string ScalerBenchmark::GetTierReport(const vector<TierResult>& results)
+{
+	string report = "Filter          Tier    Result\n";
+	for(const TierResult& r : results) {
+		char line[200];
+		if(r.MismatchCount == 0) {
+			snprintf(line, sizeof(line), "%-15s %-7s OK\n", r.Name.c_str(), CpuFeatures::GetTierName(r.Tier).c_str());
+		} else {
+			snprintf(line, sizeof(line), "%-15s %-7s MISMATCH (%u frames)\n", r.Name.c_str(), CpuFeatures::GetTierName(r.Tier).c_str(), r.MismatchCount);
+		}
+		report += line;
+	}
+	return report;
+}
+
+ScalerBenchmark::HqxYuvResult ScalerBenchmark::RunHqxYuvBenchmark(uint32_t iterations)
+{
+	iterations = std::max(1u, iterations);
+	vector<uint32_t> output(GetMaxOutputSize());
+
+	HqxYuvResult result = {};
+	result.YuvMatch = true;
+
+	//Same table as the one hqxInit used to build at startup
+	size_t memoryBefore = PlatformUtilities::GetResidentMemory();
+	Timer timer;
+	vector<uint32_t> yuvTable(0x1000000);
+	for(uint32_t c = 0; c < 0x1000000; c++) {
+		yuvTable[c] = rgb_to_yuv(c);
+	}
+	result.TableInitMs = timer.GetElapsedMS();
+	size_t memoryAfter = PlatformUtilities::GetResidentMemory();
+	result.TableMemory = memoryBefore && memoryAfter ? (int64_t)memoryAfter - (int64_t)memoryBefore : 0;
+
+	//Both conversions are run alternately on each frame, so they are equally affected by changes in CPU load/frequency
+	vector<double> yuvTimes[2];
+	for(Frame& frame : _frames) {
+		vector<uint32_t> computed(frame.Argb.size());
+		vector<uint32_t> lookedUp(frame.Argb.size());
+		for(uint32_t i = 0; i <= iterations; i++) {
+			timer.Reset();
+			for(uint32_t y = 0; y < frame.Height; y++) {
+				rgb_to_yuv_row(frame.Argb.data() + y * frame.Width, computed.data() + y * frame.Width, frame.Width);
+			}
+			double computedTime = timer.GetElapsedMS();
+
+			timer.Reset();
+			for(size_t j = 0; j < frame.Argb.size(); j++) {
+				lookedUp[j] = yuvTable[frame.Argb[j] & MASK_RGB];
+			}
+			double tableTime = timer.GetElapsedMS();
+
+			if(i > 0) {
+				//The first run is a warm up (caches)
+				yuvTimes[0].push_back(computedTime);
+				yuvTimes[1].push_back(tableTime);
+			}
+		}
+		result.YuvMatch &= computed == lookedUp;
+	}
+
+	for(vector<double>& times : yuvTimes) {
+		std::sort(times.begin(), times.end());
+	}
+	result.ComputedYuvMs = yuvTimes[0][yuvTimes[0].size() / 2];
+	result.TableYuvMs = yuvTimes[1][yuvTimes[1].size() / 2];
+
+	for(uint32_t scale = 2; scale <= 4; scale++) {
+		vector<double> frameTimes;
+		for(Frame& frame : _frames) {
+			for(uint32_t i = 0; i <= iterations; i++) {
+				timer.Reset();
+				hqx(scale, frame.Argb.data(), output.data(), frame.Width, frame.Height);
+				double time = timer.GetElapsedMS();
+				if(i > 0) {
+					frameTimes.push_back(time);
+				}
+			}
+		}
+
+		std::sort(frameTimes.begin(), frameTimes.end());
+		double computedMs = frameTimes[frameTimes.size() / 2];
+		result.Filters.push_back({ "HQ" + std::to_string(scale) + "x", computedMs, computedMs - result.ComputedYuvMs + result.TableYuvMs });
+	}
+
+	return result;
+}
+
+string ScalerBenchmark::GetHqxYuvReport(const HqxYuvResult& result)
+{
+	char line[200];
+	snprintf(line, sizeof(line), "YUV table: %.1f ms to build, %.1f MB resident memory\n", result.TableInitMs, result.TableMemory / 1024.0 / 1024.0);
+	string report = line;
+	snprintf(line, sizeof(line), "YUV conversion per frame: %.3f ms computed, %.3f ms with the table (%s)\n", result.ComputedYuvMs, result.TableYuvMs, result.YuvMatch ? "identical" : "MISMATCH");
+	report += line;
+	report += "Filter  Computed ms  Table ms (est.)\n";
+	for(const HqxYuvTiming& r : result.Filters) {
+		snprintf(line, sizeof(line), "%-8s %11.3f %16.3f\n", r.Name.c_str(), r.ComputedMs, r.TableMs);
+		report += line;
+	}
+	return report;
+}
+
+string ScalerBenchmark::GetReport(const vector<Result>& results)
+{
+	string report = "Filter        MPix/s   Avg ms   P50 ms   P95 ms   P99 ms  CRC       Result\n";
+	for(const Result& r : results) {
+		char line[200];
+		snprintf(line, sizeof(line), "%-12s %7.2f %8.3f %8.3f %8.3f %8.3f  %08X  %s\n",
+			r.Name.c_str(), r.MegaPixelsPerSecond, r.AverageMs, r.P50Ms, r.P95Ms, r.P99Ms, r.Crc,
+			r.GoldenCrc == 0 ? "no golden" : (r.Passed ? "OK" : "MISMATCH"));
+		report += line;
+	}
+	return report;
+}
+
+string ScalerBenchmark::GetGoldenTable(const vector<Result>& results)
+{
+	string table;
+	for(const Result& r : results) {
+		char line[100];
+		snprintf(line, sizeof(line), "\t\t{ \"%s\", 0x%08X },\n", r.Name.c_str(), r.Crc);
+		table += line;
+	}
+	return table;
+}
+
+uint32_t ScalerBenchmark::GetGoldenCrc(const string& name)
+{
+	//CRCs of the output for the generated frames (update with GetGoldenTable when a filter's output changes on purpose)
+	static const std::pair<const char*, uint32_t> goldens[] = {
+		{ "xBRZ 2x", 0x6A539888 },
+		{ "xBRZ 3x", 0x3521B961 },
+		{ "xBRZ 4x", 0x26F6F0DC },
+		{ "xBRZ 5x", 0x4E8BA2DD },
+		{ "xBRZ 6x", 0xDC63D415 },
+		{ "HQ2x", 0xB59E96DA },
+		{ "HQ3x", 0x7BB3D989 },
+		{ "HQ4x", 0x1FD54E1B },
+		{ "Scale2x", 0x0343E0B0 },
+		{ "Scale3x", 0x66766BE1 },
+		{ "Scale4x", 0x760F7480 },
+		{ "2xSaI", 0x155A30BB },
+		{ "Super2xSaI", 0xB2DA0877 },
+		{ "SuperEagle", 0xC400D65B },
+		{ "NTSC", 0x62FCBA63 },
+	};
+
+	for(const std::pair<const char*, uint32_t>& golden : goldens) {
+		if(name == golden.first) {
+			return golden.second;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include "pch.h"
+#include <functional>
+#include "CpuFeatures.h"
+
+class ParallelScaler;
+
+//Benchmark and regression check for the software scalers (xBRZ, HQX, Scale2x, SaI/Eagle, NTSC)
+//Each filter is run at each supported factor over a corpus of frames (3 procedurally generated 256x240 frames,
+//plus any PNG files added with AddFrame). The CRC of the output for the generated frames is compared with the
+//known good values, so optimizations to the filters can be checked for regressions.
+//CompareTiers checks that the SIMD implementations produce exactly the same output as the scalar code.
+class ScalerBenchmark
+{
+public:
+	struct Result
+	{
+		string Name;
+		double MegaPixelsPerSecond; //source pixels
+		double AverageMs;
+		double P50Ms;
+		double P95Ms;
+		double P99Ms;
+		uint32_t Crc; //CRC of the output for the generated frames
+		uint32_t GoldenCrc; //0 = no known value
+		bool Passed;
+	};
+
+	struct TierResult
+	{
+		string Name;
+		CpuTier Tier;
+		uint32_t MismatchCount; //number of frames for which the output differs from the scalar output
+	};
+
+	struct HqxYuvTiming
+	{
+		string Name;
+		double ComputedMs; //median time per frame (the filters compute the YUV values)
+		double TableMs; //estimated time per frame with the lookup table: ComputedMs - ComputedYuvMs + TableYuvMs
+	};
+
+	struct HqxYuvResult
+	{
+		double TableInitMs; //time taken to build the lookup table (this used to be done at startup by hqxInit)
+		int64_t TableMemory; //increase of the process' resident memory after building the table, in bytes
+		double ComputedYuvMs; //median time to convert a frame to YUV, as done by the filters
+		double TableYuvMs; //median time to convert a frame to YUV with the lookup table
+		bool YuvMatch; //true when both conversions give the same values
+		vector<HqxYuvTiming> Filters;
+	};
+
+private:
+	struct Frame
+	{
+		uint32_t Width;
+		uint32_t Height;
+		vector<uint32_t> Argb;
+		vector<uint16_t> Indexes; //NES palette indexes, used by the NTSC filter
+		bool Generated;
+	};
+
+	struct Filter
+	{
+		string Name;
+		std::function<uint32_t(const Frame& frame, uint32_t* out)> Run; //returns the number of output pixels
+	};
+
+	vector<Frame> _frames;
+	uint32_t _palette[64];
+
+	void InitPalette();
+	void AddGeneratedFrames();
+	void SetIndexes(Frame& frame, vector<uint16_t>&& indexes);
+	vector<Filter> GetFilters(ParallelScaler& scaler);
+	size_t GetMaxOutputSize();
+	static uint32_t GetGoldenCrc(const string& name);
+
+public:
+	ScalerBenchmark();
+
+	//Adds a frame loaded from a PNG file to the corpus (these are benchmarked but have no known CRC)
+	bool AddFrame(string pngFile);
+
+	//Runs every filter <iterations> times over each frame, using <threadCount> threads
+	vector<Result> Run(uint32_t iterations = 20, uint32_t threadCount = 1);
+
+	static string GetReport(const vector<Result>& results);
+
+	//Runs every filter over each frame with only the scalar code enabled (CpuFeatures::SetMaxTier), then at each
+	//supported SIMD tier, and compares the outputs bit for bit (includes xBRZ's ARGB mode, with translucent pixels)
+	vector<TierResult> CompareTiers(uint32_t threadCount = 1);
+
+	static string GetTierReport(const vector<TierResult>& results);
+
+	//Compares the 64MB RGB to YUV lookup table HQX used before with the current per-frame YUV computation:
+	//time to build the table, memory used by the table, and the time taken to convert each frame to YUV both ways.
+	//The filters convert each source pixel once per frame (this is the only part the table would affect), so the
+	//HQ2x/3x/4x frame times (single thread) with the table are estimated from the difference between both conversions.
+	//The table is built by the benchmark itself, HQX only uses the computed values.
+	HqxYuvResult RunHqxYuvBenchmark(uint32_t iterations = 20);
+
+	static string GetHqxYuvReport(const HqxYuvResult& result);
+
+	//Returns the golden CRC table (in the format used by GetGoldenCrc) for the current results
+	static string GetGoldenTable(const vector<Result>& results);
+};
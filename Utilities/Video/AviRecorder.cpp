@@ -25,6 +25,41 @@ AviRecorder::~AviRecorder()
 	}
 }
 
+void AviRecorder::SetSegmentLimits(uint32_t maxMinutes, uint32_t maxSizeMb)
+{
+	_maxSegmentMinutes = maxMinutes;
+	_maxSegmentSize = (uint64_t)maxSizeMb * 1024 * 1024;
+}
+
+string AviRecorder::GetSegmentFilename(uint32_t segmentIndex)
+{
+	if(segmentIndex == 0) {
+		return _outputFile;
+	}
+
+	//e.g "movie.avi" -> "movie_002.avi"
+	string suffix = "_" + std::to_string(segmentIndex + 1);
+	suffix.insert(1, suffix.size() < 4 ? 4 - suffix.size() : 0, '0');
+
+	size_t extPos = _outputFile.find_last_of('.');
+	size_t folderPos = _outputFile.find_last_of("/\\");
+	if(extPos == string::npos || (folderPos != string::npos && extPos < folderPos)) {
+		return _outputFile + suffix;
+	}
+	return _outputFile.substr(0, extPos) + suffix + _outputFile.substr(extPos);
+}
+
+void AviRecorder::StartNextSegmentIfNeeded()
+{
+	bool frameLimitReached = _maxSegmentFrames && _aviWriter->GetFrameCount() >= _maxSegmentFrames;
+	bool sizeLimitReached = _maxSegmentSize && _aviWriter->GetFileSize() >= _maxSegmentSize;
+	if(frameLimitReached || sizeLimitReached) {
+		//Done on the writer thread before the next frame is accepted, so no frames are lost between segments
+		_segmentIndex++;
+		_aviWriter->StartNewSegment(GetSegmentFilename(_segmentIndex));
+	}
+}
+
 bool AviRecorder::Init(string filename)
 {
 	_outputFile = filename;
@@ -46,6 +81,15 @@ bool AviRecorder::StartRecording(uint32_t width, uint32_t height, uint32_t bpp,
 		_fps = fps;
 		_frameBufferLength = height * width * bpp;
 		_frameBuffer = new uint8_t[_frameBufferLength];
+		_segmentIndex = 0;
+		_videoFrameCount = 0;
+		_audioSampleCount = 0;
+		_pendingAudio.clear();
+		_pendingAudioBlocks.clear();
+		//Recordings are not played in real time, use the best quality
+		_resampler.SetQuality(SincResampler::Quality::High);
+		_resampler.Reset();
+		_maxSegmentFrames = (uint32_t)(_maxSegmentMinutes * 60 * fps);
 
 		_aviWriter.reset(new AviWriter());
 		if(!_aviWriter->StartWrite(_outputFile, _codec, width, height, bpp, (uint32_t)(_fps * 1000000), audioSampleRate, _compressionLevel)) {
@@ -61,7 +105,9 @@ bool AviRecorder::StartRecording(uint32_t width, uint32_t height, uint32_t bpp,
 				}
 
 				auto lock = _lock.AcquireSafe();
+				WriteAudio();
 				_aviWriter->AddFrame(_frameBuffer);
+				StartNextSegmentIfNeeded();
 				_framePending = false;
 			}
 		});
@@ -108,15 +154,71 @@ bool AviRecorder::AddFrame(void* frameBuffer, uint32_t width, uint32_t height, d
 bool AviRecorder::AddSound(int16_t* soundBuffer, uint32_t sampleCount, uint32_t sampleRate)
 {
 	if(_recording) {
-		if(_sampleRate != sampleRate) {
-			return false;
-		} else {
-			_aviWriter->AddSound(soundBuffer, sampleCount);
+		auto lock = _audioLock.AcquireSafe();
+		if(_pendingAudioBlocks.empty() || _pendingAudioBlocks.back().SampleRate != sampleRate) {
+			_pendingAudioBlocks.push_back({ sampleRate, 0 });
 		}
+		_pendingAudioBlocks.back().SampleCount += sampleCount;
+		_pendingAudio.insert(_pendingAudio.end(), soundBuffer, soundBuffer + sampleCount * 2);
 	}
 	return true;
 }
 
+void AviRecorder::WriteAudio()
+{
+	{
+		auto lock = _audioLock.AcquireSafe();
+		_audioInput.swap(_pendingAudio);
+		_audioInputBlocks.swap(_pendingAudioBlocks);
+		_pendingAudio.clear();
+		_pendingAudioBlocks.clear();
+	}
+
+	if(_sampleRate == 0) {
+		_videoFrameCount++;
+		return;
+	}
+
+	//Compare the amount of audio written so far with the amount expected for the number of video
+	//frames, and slightly adjust the resampling ratio (max 0.5%) to bring them back in sync over ~1 second.
+	double expectedSampleCount = (double)_videoFrameCount * _sampleRate / _fps;
+	double drift = (double)_audioSampleCount - expectedSampleCount;
+	double correction = std::clamp(-drift / _sampleRate, -0.005, 0.005);
+
+	_resampledAudio.clear();
+	int16_t* in = _audioInput.data();
+	for(AudioBlock& block : _audioInputBlocks) {
+		double dstRate = _sampleRate * (1.0 + correction);
+		_resampler.SetSampleRates(block.SampleRate, dstRate);
+
+		size_t outPos = _resampledAudio.size();
+		size_t maxOutSampleCount = (size_t)(block.SampleCount * dstRate / block.SampleRate) + 16;
+		_resampledAudio.resize(outPos + maxOutSampleCount * 2);
+		uint32_t outSampleCount = _resampler.Resample<false>(in, block.SampleCount, _resampledAudio.data() + outPos, maxOutSampleCount);
+		_resampledAudio.resize(outPos + outSampleCount * 2);
+
+		in += block.SampleCount * 2;
+	}
+
+	//Large gaps (e.g when emulation speed changes or audio is paused) are too big to be fixed by the
+	//resampler, fill them with silence or drop the extra samples instead
+	int64_t sampleCount = _resampledAudio.size() / 2;
+	int64_t maxDrift = _sampleRate / 10;
+	int64_t newDrift = (int64_t)(_audioSampleCount + sampleCount) - (int64_t)((double)(_videoFrameCount + 1) * _sampleRate / _fps);
+	if(newDrift < -maxDrift) {
+		_resampledAudio.resize((sampleCount - newDrift) * 2, 0);
+	} else if(newDrift > maxDrift) {
+		_resampledAudio.resize(std::max<int64_t>(0, sampleCount - newDrift) * 2);
+	}
+
+	sampleCount = _resampledAudio.size() / 2;
+	if(sampleCount > 0) {
+		_aviWriter->AddSound(_resampledAudio.data(), (uint32_t)sampleCount);
+	}
+	_audioSampleCount += sampleCount;
+	_videoFrameCount++;
+}
+
 bool AviRecorder::IsRecording()
 {
 	return _recording;
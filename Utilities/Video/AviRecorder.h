@@ -3,6 +3,7 @@
 #include <thread>
 #include "Utilities/AutoResetEvent.h"
 #include "Utilities/SimpleLock.h"
+#include "Utilities/Audio/SincResampler.h"
 #include "Utilities/Video/AviWriter.h"
 #include "Utilities/Video/IVideoRecorder.h"
 
@@ -32,10 +33,40 @@ private:
 	VideoCodec _codec;
 	uint32_t _compressionLevel;
 
+	uint32_t _maxSegmentMinutes = 0;
+	uint32_t _maxSegmentFrames = 0;
+	uint64_t _maxSegmentSize = 0;
+	uint32_t _segmentIndex = 0;
+
+	//Audio is queued by AddSound and resampled to the file's sample rate on the writer thread
+	struct AudioBlock
+	{
+		uint32_t SampleRate;
+		uint32_t SampleCount;
+	};
+
+	SimpleLock _audioLock;
+	vector<int16_t> _pendingAudio;
+	vector<AudioBlock> _pendingAudioBlocks;
+	vector<int16_t> _audioInput;
+	vector<AudioBlock> _audioInputBlocks;
+	vector<int16_t> _resampledAudio;
+	SincResampler _resampler;
+	uint32_t _videoFrameCount = 0;
+	uint64_t _audioSampleCount = 0;
+
+	void WriteAudio();
+
+	string GetSegmentFilename(uint32_t segmentIndex);
+	void StartNextSegmentIfNeeded();
+
 public:
 	AviRecorder(VideoCodec codec, uint32_t compressionLevel);
 	virtual ~AviRecorder();
 
+	//Splits the recording into multiple files once either limit is reached (0 = no limit)
+	void SetSegmentLimits(uint32_t maxMinutes, uint32_t maxSizeMb);
+
 	bool Init(string filename) override;
 	bool StartRecording(uint32_t width, uint32_t height, uint32_t bpp, uint32_t audioSampleRate, double fps) override;
 	void StopRecording() override;
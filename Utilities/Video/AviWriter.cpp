@@ -64,51 +64,168 @@ void AviWriter::host_writed(uint8_t* buffer, uint32_t value)
 	buffer[3] = value >> 24;
 }
 
-bool AviWriter::StartWrite(string filename, VideoCodec codec, uint32_t width, uint32_t height, uint32_t bpp, uint32_t fps, uint32_t audioSampleRate, uint32_t compressionLevel)
+void AviWriter::CreateCodec()
 {
-	_codecType = codec;
-	_file.open(filename, std::ios::out | std::ios::binary);
-	if(!_file) {
-		return false;
-	}
-	
 	switch(_codecType) {
 		default:
 		case VideoCodec::None: _codec.reset(new RawCodec()); break;
 		case VideoCodec::ZMBV: _codec.reset(new ZmbvCodec()); break;
 		case VideoCodec::CSCD: _codec.reset(new CamstudioCodec()); break;
 	}
+}
 
-	if(!_codec->SetupCompress(width, height, compressionLevel)) {
+string AviWriter::GetJournalFilename(string filename)
+{
+	return filename + ".idx";
+}
+
+bool AviWriter::OpenFile(string filename)
+{
+	_filename = filename;
+	_file.open(filename, std::ios::out | std::ios::binary);
+	if(!_file) {
 		return false;
 	}
 
-	_frameBuffer = new uint8_t[width*height*bpp];
+	//The journal contains the recording's parameters followed by a copy of the index entries,
+	//it's flushed periodically so that RecoverFile can rebuild the index if the process dies.
+	_journal.open(GetJournalFilename(filename), std::ios::out | std::ios::binary);
+	if(!_journal) {
+		_file.close();
+		return false;
+	}
+
+	uint8_t journalHeader[AviWriter::JournalHeaderSize] = { 'M', 'A', 'V', 'J' };
+	host_writed(&journalHeader[4], 1);
+	host_writed(&journalHeader[8], (uint32_t)_codecType);
+	host_writed(&journalHeader[12], _width);
+	host_writed(&journalHeader[16], _height);
+	host_writed(&journalHeader[20], _bpp);
+	host_writed(&journalHeader[24], _fps);
+	host_writed(&journalHeader[28], _audiorate);
+	_journal.write((char*)journalHeader, AviWriter::JournalHeaderSize);
+	_journal.flush();
 
 	_aviIndex.clear();
 	_aviIndex.insert(_aviIndex.end(), 8, 0);
+	_journaledIndexSize = 8;
+
+	for(int i = 0; i < AviWriter::AviHeaderSize; i++) {
+		_file.put(0);
+	}
+	_frames = 0;
+	_written = 0;
+	_audiowritten = 0;
+
+	return true;
+}
 
+bool AviWriter::StartWrite(string filename, VideoCodec codec, uint32_t width, uint32_t height, uint32_t bpp, uint32_t fps, uint32_t audioSampleRate, uint32_t compressionLevel)
+{
+	_codecType = codec;
 	_width = width;
 	_height = height;
 	_bpp = bpp;
 	_fps = fps;
-
 	_audiorate = audioSampleRate;
 
-	for(int i = 0; i < AviWriter::AviHeaderSize; i++) {
-		_file.put(0);
+	CreateCodec();
+	if(!_codec->SetupCompress(width, height, compressionLevel)) {
+		return false;
 	}
-	_frames = 0;
-	_written = 0;
-	_audioPos = 0;
-	_audiowritten = 0;
 
+	_frameBuffer = new uint8_t[width*height*bpp];
+	_audiobuf.clear();
+
+	return OpenFile(filename);
+}
+
+bool AviWriter::StartNewSegment(string filename)
+{
+	//Any audio that hasn't been written yet stays in the buffer and goes to the new segment
+	auto lock = _audioLock.AcquireSafe();
+	EndWrite();
+
+	//The codec's state is reset on the next frame, since it is always a key frame (_frames == 0)
+	return OpenFile(filename);
+}
+
+uint32_t AviWriter::GetFrameCount()
+{
+	return _frames;
+}
+
+uint64_t AviWriter::GetFileSize()
+{
+	return (uint64_t)AviWriter::AviHeaderSize + _written + _aviIndex.size();
+}
+
+void AviWriter::FlushJournal()
+{
+	//Chunks must be on disk before the journal refers to them
+	_file.flush();
+
+	_journal.write((char*)_aviIndex.data() + _journaledIndexSize, _aviIndex.size() - _journaledIndexSize);
+	_journal.flush();
+	_journaledIndexSize = (uint32_t)_aviIndex.size();
+
+	//Keep the header up to date, so the file is playable even without an index
+	WriteHeader(false);
+	_file.seekp(AviWriter::AviHeaderSize + _written);
+	_file.flush();
+}
+
+bool AviWriter::RecoverFile(string filename)
+{
+	ifstream journal(GetJournalFilename(filename), std::ios::in | std::ios::binary);
+	if(!journal) {
+		return false;
+	}
+
+	uint8_t journalHeader[AviWriter::JournalHeaderSize] = {};
+	journal.read((char*)journalHeader, AviWriter::JournalHeaderSize);
+	if(journal.gcount() != AviWriter::JournalHeaderSize || memcmp(journalHeader, "MAVJ", 4) != 0) {
+		return false;
+	}
+
+	auto readDword = [](uint8_t* buffer) { return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | ((uint32_t)buffer[3] << 24); };
+
+	AviWriter writer;
+	writer._codecType = (VideoCodec)readDword(&journalHeader[8]);
+	writer._width = readDword(&journalHeader[12]);
+	writer._height = readDword(&journalHeader[16]);
+	writer._bpp = readDword(&journalHeader[20]);
+	writer._fps = readDword(&journalHeader[24]);
+	writer._audiorate = readDword(&journalHeader[28]);
+	writer.CreateCodec();
+
+	writer._aviIndex.insert(writer._aviIndex.end(), 8, 0);
+	uint8_t entry[16];
+	while(journal.read((char*)entry, 16) && journal.gcount() == 16) {
+		uint32_t pos = readDword(&entry[8]);
+		uint32_t size = readDword(&entry[12]);
+		if(entry[0] == '0' && entry[1] == '0') {
+			writer._frames++;
+		} else {
+			writer._audiowritten += size;
+		}
+		writer._written = std::max(writer._written, pos - 4 + 8 + ((size + 1) & ~1));
+		writer._aviIndex.insert(writer._aviIndex.end(), entry, entry + 16);
+	}
+	journal.close();
+
+	//Open without truncating, anything after the last journaled chunk is overwritten by the index
+	writer._file.open(filename, std::ios::in | std::ios::out | std::ios::binary);
+	if(!writer._file) {
+		return false;
+	}
+	writer._filename = filename;
+	writer.EndWrite();
 	return true;
 }
 
-void AviWriter::EndWrite()
+void AviWriter::WriteHeader(bool includeIndex)
 {
-	/* Close the video */
 	uint8_t avi_header[AviWriter::AviHeaderSize];
 	uint32_t main_list;
 	uint32_t header_pos = 0;
@@ -117,7 +234,7 @@ void AviWriter::EndWrite()
 #define AVIOUTd(_S_) host_writed(&avi_header[header_pos], _S_);header_pos+=4;
 	/* Try and write an avi header */
 	AVIOUT4("RIFF");                    // Riff header 
-	AVIOUTd(AviWriter::AviHeaderSize + _written - 8 + (uint32_t)_aviIndex.size());
+	AVIOUTd(AviWriter::AviHeaderSize + _written - 8 + (includeIndex ? (uint32_t)_aviIndex.size() : 0));
 	AVIOUT4("AVI ");
 	AVIOUT4("LIST");                    // List header
 	main_list = header_pos;
@@ -223,14 +340,28 @@ void AviWriter::EndWrite()
 	AVIOUT4("LIST");
 	AVIOUTd(_written + 4); /* Length of list in bytes */
 	AVIOUT4("movi");
+
+	_file.seekp(std::ios::beg);
+	_file.write((char*)avi_header, AviWriter::AviHeaderSize);
+}
+
+void AviWriter::EndWrite()
+{
+	/* Close the video */
 	/* First add the index table to the end */
 	memcpy(_aviIndex.data(), "idx1", 4);
 	host_writed(_aviIndex.data() + 4, (uint32_t)_aviIndex.size() - 8);
 	
+	_file.seekp(AviWriter::AviHeaderSize + _written);
 	_file.write((char*)_aviIndex.data(), _aviIndex.size());
-	_file.seekp(std::ios::beg);
-	_file.write((char*)avi_header, AviWriter::AviHeaderSize);
+	WriteHeader(true);
 	_file.close();
+
+	//The file is complete, the journal is no longer needed
+	if(_journal.is_open()) {
+		_journal.close();
+	}
+	std::remove(GetJournalFilename(_filename).c_str());
 }
 
 void AviWriter::AddFrame(uint8_t *frameData)
@@ -253,21 +384,27 @@ void AviWriter::AddFrame(uint8_t *frameData)
 	WriteAviChunk(_codecType == VideoCodec::None ? "00db" : "00dc", written, compressedData, isKeyFrame ? 0x10 : 0);
 	_frames++;
 
-	if(_audioPos) {
+	{
 		auto lock = _audioLock.AcquireSafe();
-		WriteAviChunk("01wb", _audioPos, _audiobuf, 0);
-		_audiowritten += _audioPos;
-		_audioPos = 0;
+		if(!_audiobuf.empty()) {
+			uint32_t audioSize = (uint32_t)_audiobuf.size() * sizeof(int16_t);
+			WriteAviChunk("01wb", audioSize, _audiobuf.data(), 0);
+			_audiowritten += audioSize;
+			_audiobuf.clear();
+		}
+	}
+
+	if(_frames % AviWriter::JournalFlushInterval == 0) {
+		FlushJournal();
 	}
 }
 
 void AviWriter::AddSound(int16_t *data, uint32_t sampleCount)
 {
+	auto lock = _audioLock.AcquireSafe();
 	if(!_file) {
 		return;
 	}
 
-	auto lock = _audioLock.AcquireSafe();
-	memcpy(_audiobuf+_audioPos/2, data, sampleCount * 4);
-	_audioPos += sampleCount * 4;
+	_audiobuf.insert(_audiobuf.end(), data, data + sampleCount * 2);
 }
\ No newline at end of file
@@ -17,16 +17,20 @@ enum class VideoCodec
 class AviWriter
 {
 private:
-	static constexpr int WaveBufferSize = 16 * 1024;
 	static constexpr int AviHeaderSize = 500;
+	static constexpr int JournalHeaderSize = 32;
+	static constexpr uint32_t JournalFlushInterval = 60;
+
+	string _filename;
+	ofstream _journal;
+	uint32_t _journaledIndexSize = 0;
 
 	std::unique_ptr<BaseCodec> _codec;
 	ofstream _file;
 
 	VideoCodec _codecType;
 
-	int16_t _audiobuf[WaveBufferSize];
-	uint32_t _audioPos = 0;
+	vector<int16_t> _audiobuf;
 	uint32_t _audiorate = 0;
 	uint32_t _audiowritten = 0;
 
@@ -48,10 +52,22 @@ private:
 	void host_writed(uint8_t* buffer, uint32_t value);
 	void WriteAviChunk(const char * tag, uint32_t size, void * data, uint32_t flags);
 
+	void CreateCodec();
+	bool OpenFile(string filename);
+	void WriteHeader(bool includeIndex);
+	void FlushJournal();
+	static string GetJournalFilename(string filename);
+
 public:
 	void AddFrame(uint8_t* frameData);
 	void AddSound(int16_t * data, uint32_t sampleCount);
 
 	bool StartWrite(string filename, VideoCodec codec, uint32_t width, uint32_t height, uint32_t bpp, uint32_t fps, uint32_t audioSampleRate, uint32_t compressionLevel);
 	void EndWrite();
+
+	bool StartNewSegment(string filename);
+	uint32_t GetFrameCount();
+	uint64_t GetFileSize();
+
+	static bool RecoverFile(string filename);
 };
\ No newline at end of file
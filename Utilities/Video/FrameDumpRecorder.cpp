@@ -0,0 +1,195 @@
+#include "pch.h"
+#include "FrameDumpRecorder.h"
+#include "Utilities/CRC32.h"
+#include "Utilities/FolderUtilities.h"
+#include "Utilities/PNGHelper.h"
+#include "Utilities/HexUtilities.h"
+
+FrameDumpRecorder::FrameDumpRecorder(FrameDumpFormat format)
+{
+	_format = format;
+}
+
+FrameDumpRecorder::~FrameDumpRecorder()
+{
+	StopRecording();
+}
+
+bool FrameDumpRecorder::Init(string filename)
+{
+	_outputFile = filename;
+
+	if(_format == FrameDumpFormat::Container) {
+		ofstream fileTest(filename, std::ios::out | std::ios::binary);
+		return (bool)fileTest;
+	} else {
+		//Frames are written to a folder
+		FolderUtilities::CreateFolder(filename);
+		ofstream fileTest(FolderUtilities::CombinePath(filename, "manifest.csv"), std::ios::out | std::ios::binary);
+		return (bool)fileTest;
+	}
+}
+
+string FrameDumpRecorder::GetFrameFilename(uint32_t frameNumber)
+{
+	string number = std::to_string(frameNumber);
+	if(number.size() < 6) {
+		number.insert(0, 6 - number.size(), '0');
+	}
+	return "frame_" + number + (_format == FrameDumpFormat::Png ? ".png" : ".bgra");
+}
+
+bool FrameDumpRecorder::StartRecording(uint32_t width, uint32_t height, uint32_t bpp, uint32_t audioSampleRate, double fps)
+{
+	if(_recording || bpp != 4) {
+		return false;
+	}
+
+	_width = width;
+	_height = height;
+	_fps = fps;
+	_frameCounter = 0;
+
+	if(_format == FrameDumpFormat::Container) {
+		_container.open(_outputFile, std::ios::out | std::ios::binary);
+		if(!_container) {
+			return false;
+		}
+
+		_manifest.open(_outputFile + ".manifest.csv", std::ios::out | std::ios::binary);
+		if(!_manifest) {
+			_container.close();
+			return false;
+		}
+
+		uint32_t header[5] = { 0x5044464D, 1, width, height, (uint32_t)(fps * 1000) }; //"MFDP", version, size, frame rate
+		_container.write((char*)header, sizeof(header));
+	} else {
+		//The manifest must be opened before the workers start (StopRecording only joins them once recording has started)
+		_manifest.open(FolderUtilities::CombinePath(_outputFile, "manifest.csv"), std::ios::out | std::ios::binary);
+		if(!_manifest) {
+			return false;
+		}
+
+		_stopFlag = false;
+		uint32_t workerCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+		for(uint32_t i = 0; i < workerCount; i++) {
+			_workers.push_back(std::thread([this]() { WorkerThread(); }));
+		}
+	}
+
+	_manifest << "frame,crc32,file\n";
+
+	_recording = true;
+	return true;
+}
+
+void FrameDumpRecorder::StopRecording()
+{
+	if(!_recording) {
+		return;
+	}
+	_recording = false;
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopFlag = true;
+		_jobAvailable.notify_all();
+	}
+	for(std::thread& worker : _workers) {
+		worker.join();
+	}
+	_workers.clear();
+	_freeBuffers.clear();
+
+	if(_container.is_open()) {
+		_container.close();
+	}
+	_manifest.close();
+}
+
+void FrameDumpRecorder::WorkerThread()
+{
+	while(true) {
+		std::unique_lock<std::mutex> lock(_mutex);
+		_jobAvailable.wait(lock, [this] { return _stopFlag || !_jobs.empty(); });
+		if(_jobs.empty()) {
+			//Stop requested and all frames were written
+			break;
+		}
+
+		FrameDumpJob job = std::move(_jobs.front());
+		_jobs.pop_front();
+		lock.unlock();
+
+		if(_format == FrameDumpFormat::Png) {
+			PNGHelper::WritePNG(job.Filename, job.Buffer.data(), _width, _height, 24, FrameDumpRecorder::PngCompressionLevel);
+		} else {
+			ofstream file(job.Filename, std::ios::out | std::ios::binary);
+			file.write((char*)job.Buffer.data(), job.Buffer.size() * sizeof(uint32_t));
+		}
+
+		lock.lock();
+		_freeBuffers.push_back(std::move(job.Buffer));
+		_queueUpdated.notify_one();
+	}
+}
+
+bool FrameDumpRecorder::AddFrame(void* frameBuffer, uint32_t width, uint32_t height, double fps)
+{
+	if(!_recording) {
+		return true;
+	}
+
+	if(_width != width || _height != height) {
+		return false;
+	}
+
+	uint32_t frameNumber = _frameCounter++;
+	uint32_t frameSize = width * height * sizeof(uint32_t);
+	uint32_t crc = CRC32::GetCRC((uint8_t*)frameBuffer, frameSize);
+
+	string filename;
+	if(_format == FrameDumpFormat::Container) {
+		_container.write((char*)frameBuffer, frameSize);
+	} else {
+		filename = GetFrameFilename(frameNumber);
+
+		FrameDumpJob job;
+		job.Filename = FolderUtilities::CombinePath(_outputFile, filename);
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+
+			//Block the emulation if the workers can't keep up, rather than dropping frames
+			_queueUpdated.wait(lock, [this] { return _jobs.size() < FrameDumpRecorder::MaxQueuedFrames; });
+
+			if(!_freeBuffers.empty()) {
+				job.Buffer = std::move(_freeBuffers.back());
+				_freeBuffers.pop_back();
+			}
+		}
+		job.Buffer.assign((uint32_t*)frameBuffer, (uint32_t*)frameBuffer + width * height);
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		_jobs.push_back(std::move(job));
+		_jobAvailable.notify_one();
+	}
+
+	_manifest << frameNumber << "," << HexUtilities::ToHex32(crc) << "," << filename << "\n";
+	return true;
+}
+
+bool FrameDumpRecorder::AddSound(int16_t* soundBuffer, uint32_t sampleCount, uint32_t sampleRate)
+{
+	return true;
+}
+
+bool FrameDumpRecorder::IsRecording()
+{
+	return _recording;
+}
+
+string FrameDumpRecorder::GetOutputFile()
+{
+	return _outputFile;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "pch.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include "Utilities/Video/IVideoRecorder.h"
+
+enum class FrameDumpFormat
+{
+	Raw = 0, //One file per frame in the output folder
+	Png = 1, //One PNG file per frame in the output folder
+	Container = 2 //All frames appended to a single uncompressed file
+};
+
+//Writes every frame it receives (no frame skipping), along with a manifest containing the
+//CRC32 of each frame's pixel data, for golden-image comparisons in regression tests.
+//Raw frames are stored as 32-bit pixels in BGRA byte order.
+class FrameDumpRecorder final : public IVideoRecorder
+{
+private:
+	static constexpr uint32_t MaxQueuedFrames = 32;
+	static constexpr uint32_t PngCompressionLevel = 1;
+
+	struct FrameDumpJob
+	{
+		string Filename;
+		vector<uint32_t> Buffer;
+	};
+
+	FrameDumpFormat _format;
+	string _outputFile;
+	bool _recording = false;
+
+	uint32_t _width = 0;
+	uint32_t _height = 0;
+	double _fps = 0;
+	uint32_t _frameCounter = 0;
+
+	ofstream _container;
+	ofstream _manifest;
+
+	vector<std::thread> _workers;
+	std::mutex _mutex;
+	std::condition_variable _jobAvailable;
+	std::condition_variable _queueUpdated;
+	std::deque<FrameDumpJob> _jobs;
+	vector<vector<uint32_t>> _freeBuffers;
+	bool _stopFlag = false;
+
+	void WorkerThread();
+	string GetFrameFilename(uint32_t frameNumber);
+
+public:
+	FrameDumpRecorder(FrameDumpFormat format);
+	virtual ~FrameDumpRecorder();
+
+	bool Init(string filename) override;
+	bool StartRecording(uint32_t width, uint32_t height, uint32_t bpp, uint32_t audioSampleRate, double fps) override;
+	void StopRecording() override;
+	bool AddFrame(void* frameBuffer, uint32_t width, uint32_t height, double fps) override;
+	bool AddSound(int16_t* soundBuffer, uint32_t sampleCount, uint32_t sampleRate) override;
+	bool IsRecording() override;
+	string GetOutputFile() override;
+};
@@ -0,0 +1,460 @@
+#include "pch.h"
+#include "GifEncoder.h"
+#include "gif.h"
+
+//Packs variable-length LZW codes into the 255-byte sub-blocks used by the GIF format
+class GifLzwWriter
+{
+private:
+	vector<uint8_t>& _output;
+	uint8_t _chunk[255];
+	uint32_t _chunkSize = 0;
+	uint32_t _bitBuffer = 0;
+	uint32_t _bitCount = 0;
+
+	void PushByte(uint8_t value)
+	{
+		_chunk[_chunkSize++] = value;
+		if(_chunkSize == 255) {
+			FlushChunk();
+		}
+	}
+
+	void FlushChunk()
+	{
+		_output.push_back((uint8_t)_chunkSize);
+		_output.insert(_output.end(), _chunk, _chunk + _chunkSize);
+		_chunkSize = 0;
+	}
+
+public:
+	GifLzwWriter(vector<uint8_t>& output) : _output(output)
+	{
+	}
+
+	void WriteCode(uint32_t code, uint32_t length)
+	{
+		_bitBuffer |= code << _bitCount;
+		_bitCount += length;
+		while(_bitCount >= 8) {
+			PushByte((uint8_t)_bitBuffer);
+			_bitBuffer >>= 8;
+			_bitCount -= 8;
+		}
+	}
+
+	void Finish()
+	{
+		if(_bitCount) {
+			PushByte((uint8_t)_bitBuffer);
+			_bitBuffer = 0;
+			_bitCount = 0;
+		}
+		if(_chunkSize) {
+			FlushChunk();
+		}
+	}
+};
+
+GifEncoder::GifEncoder()
+{
+}
+
+GifEncoder::~GifEncoder()
+{
+	End();
+}
+
+bool GifEncoder::Begin(string filename, uint32_t width, uint32_t height)
+{
+	_file.open(filename, std::ios::out | std::ios::binary);
+	if(!_file) {
+		return false;
+	}
+
+	_width = width;
+	_height = height;
+	_prevFrame.resize(width * height);
+	_firstFrame = true;
+	_paletteLookup.clear();
+	_paletteSize = 1;
+	_stopFlag = false;
+	_stopWorkers = false;
+
+	uint8_t header[] = {
+		'G', 'I', 'F', '8', '9', 'a',
+		(uint8_t)width, (uint8_t)(width >> 8), (uint8_t)height, (uint8_t)(height >> 8),
+		0xF0, 0, 0, //Global color table with 2 entries, background color, square pixels
+		0, 0, 0, 0, 0, 0, //Dummy global palette (2 black entries), each frame has its own local palette
+		0x21, 0xFF, 11, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0', 3, 1, 0, 0, 0 //Loop forever
+	};
+	_file.write((char*)header, sizeof(header));
+
+	uint32_t workerCount = std::max(1u, std::min(4u, std::thread::hardware_concurrency() / 2));
+	for(uint32_t i = 0; i < workerCount; i++) {
+		_lzwWorkers.push_back(std::thread([this]() { LzwWorker(); }));
+	}
+	_paletteThread = std::thread([this]() { PaletteThread(); });
+
+	return true;
+}
+
+void GifEncoder::AddFrame(const uint32_t* frameBuffer, uint16_t delay)
+{
+	vector<uint32_t> frame;
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		//Block the caller if the encoder falls too far behind, rather than dropping frames
+		_queueUpdated.wait(lock, [this] { return _pendingFrames.size() + _writeQueue.size() < GifEncoder::MaxQueuedFrames; });
+
+		if(!_freeBuffers.empty()) {
+			frame = std::move(_freeBuffers.back());
+			_freeBuffers.pop_back();
+		}
+	}
+
+	frame.assign(frameBuffer, frameBuffer + _width * _height);
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	_pendingFrames.push_back(std::move(frame));
+	_pendingDelays.push_back(delay);
+	_frameAvailable.notify_one();
+}
+
+void GifEncoder::End()
+{
+	if(!_file.is_open()) {
+		return;
+	}
+
+	//Let the palette thread process all pending frames, then let the workers drain the encode queue
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopFlag = true;
+		_frameAvailable.notify_all();
+	}
+	_paletteThread.join();
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopWorkers = true;
+		_jobAvailable.notify_all();
+	}
+	for(std::thread& worker : _lzwWorkers) {
+		worker.join();
+	}
+	_lzwWorkers.clear();
+
+	WriteCompletedFrames();
+
+	_file.put(0x3B); //Trailer
+	_file.close();
+
+	_pendingFrames.clear();
+	_pendingDelays.clear();
+	_freeBuffers.clear();
+	_encodeQueue.clear();
+	_writeQueue.clear();
+}
+
+void GifEncoder::PaletteThread()
+{
+	while(true) {
+		std::unique_lock<std::mutex> lock(_mutex);
+		_frameAvailable.wait(lock, [this] { return _stopFlag || !_pendingFrames.empty(); });
+		if(_pendingFrames.empty()) {
+			//Stop requested and all frames were processed
+			break;
+		}
+
+		vector<uint32_t> frame = std::move(_pendingFrames.front());
+		shared_ptr<GifFrameJob> job(new GifFrameJob());
+		job->Delay = _pendingDelays.front();
+		_pendingFrames.pop_front();
+		_pendingDelays.pop_front();
+		lock.unlock();
+
+		BuildJob(frame.data(), *job);
+
+		lock.lock();
+		_freeBuffers.push_back(std::move(frame));
+		_encodeQueue.push_back(job);
+		_writeQueue.push_back(job);
+		_jobAvailable.notify_one();
+	}
+}
+
+void GifEncoder::LzwWorker()
+{
+	//Allocated once per worker and reused for every frame
+	vector<uint16_t> codeTree;
+
+	while(true) {
+		std::unique_lock<std::mutex> lock(_mutex);
+		_jobAvailable.wait(lock, [this] { return _stopWorkers || !_encodeQueue.empty(); });
+		if(_encodeQueue.empty()) {
+			break;
+		}
+
+		shared_ptr<GifFrameJob> job = _encodeQueue.front();
+		_encodeQueue.pop_front();
+		lock.unlock();
+
+		EncodeFrame(*job, codeTree);
+
+		lock.lock();
+		job->Done = true;
+		lock.unlock();
+
+		WriteCompletedFrames();
+	}
+}
+
+void GifEncoder::WriteCompletedFrames()
+{
+	//Frames can finish out of order - only write the ones at the front of the queue
+	std::lock_guard<std::mutex> writeLock(_writeMutex);
+
+	vector<shared_ptr<GifFrameJob>> jobs;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		while(!_writeQueue.empty() && _writeQueue.front()->Done) {
+			jobs.push_back(_writeQueue.front());
+			_writeQueue.pop_front();
+		}
+	}
+
+	if(jobs.empty()) {
+		return;
+	}
+
+	for(shared_ptr<GifFrameJob>& job : jobs) {
+		_file.write((char*)job->Output.data(), job->Output.size());
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	_queueUpdated.notify_all();
+}
+
+void GifEncoder::BuildJob(const uint32_t* frame, GifFrameJob& job)
+{
+	uint32_t left = 0;
+	uint32_t right = _width;
+	uint32_t top = 0;
+	uint32_t bottom = _height;
+
+	if(!_firstFrame) {
+		//Find the bounding rectangle of the pixels that changed since the previous frame
+		left = _width;
+		right = 0;
+		top = _height;
+		bottom = 0;
+		for(uint32_t y = 0; y < _height; y++) {
+			const uint32_t* row = frame + y * _width;
+			const uint32_t* prevRow = _prevFrame.data() + y * _width;
+
+			uint32_t x = 0;
+			while(x < _width && ((row[x] ^ prevRow[x]) & 0xFFFFFF) == 0) {
+				x++;
+			}
+			if(x == _width) {
+				continue;
+			}
+
+			uint32_t lastX = _width - 1;
+			while(((row[lastX] ^ prevRow[lastX]) & 0xFFFFFF) == 0) {
+				lastX--;
+			}
+
+			left = std::min(left, x);
+			right = std::max(right, lastX + 1);
+			top = std::min(top, y);
+			bottom = y + 1;
+		}
+
+		if(right == 0) {
+			//Nothing changed, output a single transparent pixel to keep the frame's timing
+			job.Left = 0;
+			job.Top = 0;
+			job.Width = 1;
+			job.Height = 1;
+			job.BitDepth = 2;
+			job.Indexes.assign(1, kGifTransIndex);
+			return;
+		}
+	}
+
+	job.Left = left;
+	job.Top = top;
+	job.Width = right - left;
+	job.Height = bottom - top;
+	job.Indexes.resize(job.Width * job.Height);
+
+	if(!MapToCachedPalette(frame, job)) {
+		//Too many colors to fit in the current palette, start over with only this frame's colors
+		_paletteLookup.clear();
+		_paletteSize = 1;
+		if(!MapToCachedPalette(frame, job)) {
+			QuantizeFrame(frame, job);
+			_paletteLookup.clear();
+			_paletteSize = 1;
+		}
+	}
+
+	_firstFrame = false;
+}
+
+bool GifEncoder::MapToCachedPalette(const uint32_t* frame, GifFrameJob& job)
+{
+	uint8_t* out = job.Indexes.data();
+	uint32_t lastColor = 0xFFFFFFFF;
+	uint8_t lastIndex = 0;
+
+	for(uint32_t y = job.Top, yEnd = job.Top + job.Height; y < yEnd; y++) {
+		const uint32_t* row = frame + y * _width;
+		const uint32_t* prevRow = _prevFrame.data() + y * _width;
+		for(uint32_t x = job.Left, xEnd = job.Left + job.Width; x < xEnd; x++) {
+			uint32_t color = row[x] & 0xFFFFFF;
+			if(!_firstFrame && color == (prevRow[x] & 0xFFFFFF)) {
+				//Pixel is unchanged, leave it transparent
+				*out++ = kGifTransIndex;
+				continue;
+			}
+
+			if(color != lastColor) {
+				auto result = _paletteLookup.find(color);
+				if(result == _paletteLookup.end()) {
+					if(_paletteSize >= 256) {
+						return false;
+					}
+					_palette[_paletteSize] = color;
+					result = _paletteLookup.emplace(color, (uint8_t)_paletteSize).first;
+					_paletteSize++;
+				}
+				lastColor = color;
+				lastIndex = result->second;
+			}
+			*out++ = lastIndex;
+		}
+	}
+
+	job.BitDepth = 2;
+	while((1u << job.BitDepth) < _paletteSize) {
+		job.BitDepth++;
+	}
+	memcpy(job.Palette, _palette, sizeof(uint32_t) * _paletteSize);
+
+	//Colors are exact, the decoder's output now matches the input frame
+	for(uint32_t y = job.Top, yEnd = job.Top + job.Height; y < yEnd; y++) {
+		memcpy(_prevFrame.data() + y * _width + job.Left, frame + y * _width + job.Left, job.Width * sizeof(uint32_t));
+	}
+
+	return true;
+}
+
+void GifEncoder::QuantizeFrame(const uint32_t* frame, GifFrameJob& job)
+{
+	uint32_t pixelCount = job.Width * job.Height;
+	vector<uint32_t> current(pixelCount);
+	vector<uint32_t> previous(pixelCount);
+	vector<uint32_t> output(pixelCount);
+	for(uint32_t y = 0; y < job.Height; y++) {
+		uint32_t offset = (y + job.Top) * _width + job.Left;
+		memcpy(current.data() + y * job.Width, frame + offset, job.Width * sizeof(uint32_t));
+		memcpy(previous.data() + y * job.Width, _prevFrame.data() + offset, job.Width * sizeof(uint32_t));
+	}
+
+	const uint8_t* lastFrame = _firstFrame ? nullptr : (uint8_t*)previous.data();
+	GifPalette pal;
+	GifMakePalette(lastFrame, (uint8_t*)current.data(), job.Width, job.Height, 8, false, &pal);
+	GifThresholdImage(lastFrame, (uint8_t*)current.data(), (uint8_t*)output.data(), job.Width, job.Height, &pal);
+
+	job.BitDepth = 8;
+	for(int i = 0; i < 256; i++) {
+		job.Palette[i] = pal.r[i] | (pal.g[i] << 8) | (pal.b[i] << 16);
+	}
+
+	for(uint32_t i = 0; i < pixelCount; i++) {
+		//GifThresholdImage stores the palette index in the 4th byte
+		job.Indexes[i] = (uint8_t)(output[i] >> 24);
+	}
+
+	//Keep track of the quantized colors, which is what the decoder will display
+	for(uint32_t y = 0; y < job.Height; y++) {
+		memcpy(_prevFrame.data() + (y + job.Top) * _width + job.Left, output.data() + y * job.Width, job.Width * sizeof(uint32_t));
+	}
+}
+
+void GifEncoder::EncodeFrame(GifFrameJob& job, vector<uint16_t>& codeTree)
+{
+	vector<uint8_t>& out = job.Output;
+	out.clear();
+	out.reserve(job.Indexes.size() / 2 + 1024);
+
+	uint8_t header[] = {
+		0x21, 0xF9, 0x04, 0x05, //Graphic control extension: leave previous frame in place, frame has transparency
+		(uint8_t)job.Delay, (uint8_t)(job.Delay >> 8),
+		kGifTransIndex, 0,
+		0x2C, //Image descriptor
+		(uint8_t)job.Left, (uint8_t)(job.Left >> 8), (uint8_t)job.Top, (uint8_t)(job.Top >> 8),
+		(uint8_t)job.Width, (uint8_t)(job.Width >> 8), (uint8_t)job.Height, (uint8_t)(job.Height >> 8),
+		(uint8_t)(0x80 | (job.BitDepth - 1)) //Local color table with 2^bitDepth entries
+	};
+	out.insert(out.end(), header, header + sizeof(header));
+
+	uint32_t colorCount = 1 << job.BitDepth;
+	for(uint32_t i = 0; i < colorCount; i++) {
+		uint32_t color = i == kGifTransIndex ? 0 : job.Palette[i];
+		out.push_back((uint8_t)(color >> 16));
+		out.push_back((uint8_t)(color >> 8));
+		out.push_back((uint8_t)color);
+	}
+
+	//Same LZW compression as GifWriteLzwImage in gif.h, but the dictionary only has as many
+	//children per node as there are colors in the palette, which makes clears much cheaper
+	const uint32_t minCodeSize = job.BitDepth;
+	const uint32_t clearCode = 1 << minCodeSize;
+	out.push_back((uint8_t)minCodeSize);
+
+	codeTree.resize(4096 * colorCount);
+	std::fill(codeTree.begin(), codeTree.end(), 0);
+
+	GifLzwWriter writer(out);
+	int32_t curCode = -1;
+	uint32_t codeSize = minCodeSize + 1;
+	uint32_t maxCode = clearCode + 1;
+
+	writer.WriteCode(clearCode, codeSize);
+
+	for(uint8_t nextValue : job.Indexes) {
+		if(curCode < 0) {
+			curCode = nextValue;
+		} else if(codeTree[curCode * colorCount + nextValue]) {
+			curCode = codeTree[curCode * colorCount + nextValue];
+		} else {
+			writer.WriteCode((uint32_t)curCode, codeSize);
+
+			codeTree[curCode * colorCount + nextValue] = (uint16_t)++maxCode;
+			if(maxCode >= (1u << codeSize)) {
+				codeSize++;
+			}
+			if(maxCode == 4095) {
+				//Dictionary is full, clear it and start over
+				writer.WriteCode(clearCode, codeSize);
+				std::fill(codeTree.begin(), codeTree.end(), 0);
+				codeSize = minCodeSize + 1;
+				maxCode = clearCode + 1;
+			}
+
+			curCode = nextValue;
+		}
+	}
+
+	writer.WriteCode((uint32_t)curCode, codeSize);
+	writer.WriteCode(clearCode, codeSize);
+	writer.WriteCode(clearCode + 1, minCodeSize + 1);
+	writer.Finish();
+
+	out.push_back(0); //Block terminator
+}
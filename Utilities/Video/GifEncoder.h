@@ -0,0 +1,80 @@
+#pragma once
+#include "pch.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+struct GifFrameJob
+{
+	uint16_t Left = 0;
+	uint16_t Top = 0;
+	uint16_t Width = 0;
+	uint16_t Height = 0;
+	uint16_t Delay = 0;
+
+	uint8_t BitDepth = 8;
+	uint32_t Palette[256] = {};
+
+	vector<uint8_t> Indexes;
+	vector<uint8_t> Output;
+	bool Done = false;
+};
+
+//Multi-threaded GIF encoder
+//Frames are palettized in order on a dedicated thread (only the rectangle that changed since the
+//previous frame is kept), then LZW-compressed in parallel by a pool of workers and written in order.
+//Most emulated systems only ever output a few dozen distinct colors, so the palette is built from the
+//exact colors seen so far and reused across frames - the median-cut quantizer from gif.h is only used
+//when a frame contains more than 255 colors.
+class GifEncoder
+{
+private:
+	static constexpr uint32_t MaxQueuedFrames = 16;
+
+	ofstream _file;
+	uint32_t _width = 0;
+	uint32_t _height = 0;
+
+	std::thread _paletteThread;
+	vector<std::thread> _lzwWorkers;
+
+	std::mutex _mutex;
+	std::mutex _writeMutex;
+	std::condition_variable _frameAvailable;
+	std::condition_variable _jobAvailable;
+	std::condition_variable _queueUpdated;
+	bool _stopFlag = false;
+	bool _stopWorkers = false;
+
+	std::deque<vector<uint32_t>> _pendingFrames;
+	std::deque<uint16_t> _pendingDelays;
+	vector<vector<uint32_t>> _freeBuffers;
+	std::deque<shared_ptr<GifFrameJob>> _encodeQueue;
+	std::deque<shared_ptr<GifFrameJob>> _writeQueue;
+
+	//Only accessed by the palette thread
+	vector<uint32_t> _prevFrame;
+	bool _firstFrame = true;
+	unordered_map<uint32_t, uint8_t> _paletteLookup;
+	uint32_t _palette[256] = {};
+	uint32_t _paletteSize = 1;
+
+	void PaletteThread();
+	void LzwWorker();
+
+	void BuildJob(const uint32_t* frame, GifFrameJob& job);
+	bool MapToCachedPalette(const uint32_t* frame, GifFrameJob& job);
+	void QuantizeFrame(const uint32_t* frame, GifFrameJob& job);
+
+	static void EncodeFrame(GifFrameJob& job, vector<uint16_t>& codeTree);
+	void WriteCompletedFrames();
+
+public:
+	GifEncoder();
+	~GifEncoder();
+
+	bool Begin(string filename, uint32_t width, uint32_t height);
+	void AddFrame(const uint32_t* frameBuffer, uint16_t delay);
+	void End();
+};
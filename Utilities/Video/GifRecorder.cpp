@@ -1,10 +1,10 @@
 #include "pch.h"
 #include "GifRecorder.h"
-#include "gif.h"
+#include "GifEncoder.h"
 
 GifRecorder::GifRecorder()
 {
-	_gif.reset(new GifWriter());
+	_encoder.reset(new GifEncoder());
 	_frameCounter = 0;
 }
 
@@ -29,7 +29,7 @@ bool GifRecorder::StartRecording(uint32_t width, uint32_t height, uint32_t bpp,
 	_height = height;
 	_fps = fps;
 
-	_recording = GifBegin(_gif.get(), _outputFile.c_str(), width, height, 2, 8, false);
+	_recording = _encoder->Begin(_outputFile, width, height);
 	_frameCounter = 0;
 	return _recording;
 }
@@ -37,12 +37,17 @@ bool GifRecorder::StartRecording(uint32_t width, uint32_t height, uint32_t bpp,
 void GifRecorder::StopRecording()
 {
 	if(_recording) {
-		GifEnd(_gif.get());
+		_encoder->End();
+		_recording = false;
 	}
 }
 
 bool GifRecorder::AddFrame(void* frameBuffer, uint32_t width, uint32_t height, double fps)
 {
+	if(!_recording) {
+		return true;
+	}
+
 	if(_width != width || _height != height || _fps != fps) {
 		return false;
 	}
@@ -51,7 +56,7 @@ bool GifRecorder::AddFrame(void* frameBuffer, uint32_t width, uint32_t height, d
 	
 	if(fps < 55 || (_frameCounter % 6) != 0) {
 		//At 60 FPS, skip 1 of every 6 frames (max FPS for GIFs is 50fps)
-		GifWriteFrame(_gif.get(), (uint8_t*)frameBuffer, width, height, 2, 8, false);
+		_encoder->AddFrame((uint32_t*)frameBuffer, 2);
 	}
 
 	return true;
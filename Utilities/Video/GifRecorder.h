@@ -2,12 +2,12 @@
 #include "pch.h"
 #include "Utilities/Video/IVideoRecorder.h"
 
-struct GifWriter;
+class GifEncoder;
 
 class GifRecorder final : public IVideoRecorder
 {
 private:
-	std::unique_ptr<GifWriter> _gif;
+	std::unique_ptr<GifEncoder> _encoder;
 	bool _recording = false;
 	uint32_t _frameCounter = 0;
 	string _outputFile;
@@ -140,6 +140,12 @@ bool VirtualFile::IsArchive()
 	return !_innerFile.empty();
 }
 
+bool VirtualFile::IsLoaded()
+{
+	//Files created from a buffer/stream are always in memory, files on the disk are only loaded when their content is needed
+	return _data.size() > 0;
+}
+
 string VirtualFile::GetFilePath()
 {
 	return _path;
@@ -33,6 +33,7 @@ public:
 	
 	bool IsValid();
 	bool IsArchive();
+	bool IsLoaded();
 	string GetFilePath();
 	string GetFolderPath();
 	string GetFileName();
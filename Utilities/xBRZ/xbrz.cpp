@@ -14,12 +14,18 @@
 // ****************************************************************************
 
 #include "../pch.h"
+#include "../CpuFeatures.h"
 #include "xbrz.h"
 #include <cassert>
 #include <algorithm>
 #include <vector>
 #include <cmath>
 
+#if defined(__x86_64__) || defined(_M_X64)
+    #define XBRZ_AVX2
+    #include <immintrin.h>
+#endif
+
 namespace
 {
 template <uint32_t N> inline
@@ -167,15 +173,26 @@ struct DistYCbCrBuffer //30% perf boost compared to distYCbCr()!
 {
 public:
     static double dist(uint32_t pix1, uint32_t pix2)
+    {
+        return instance().distImpl(pix1, pix2);
+    }
+
+    //used by the vectorized preprocessing, which computes the same index as distImpl()
+    static const float* getTable()
+    {
+        return instance().buffer.data();
+    }
+
+private:
+    static const DistYCbCrBuffer& instance()
     {
 #if defined _MSC_VER && _MSC_VER < 1900
 #error function scope static initialization is not yet thread-safe!
 #endif
         static const DistYCbCrBuffer inst;
-        return inst.distImpl(pix1, pix2);
+        return inst;
     }
 
-private:
     DistYCbCrBuffer() : buffer(256 * 256 * 256)
     {
         for (uint32_t i = 0; i < 256 * 256 * 256; ++i) //startup time: 114 ms on Intel Core i5 (four cores)
@@ -295,6 +312,198 @@ BlendResult preProcessCorners(const Kernel_4x4& ker, const xbrz::ScalerCfg& cfg)
     return result;
 }
 
+//preprocess the corners of all pixels of a row [xFirst, xLast)
+template <class ColorDistance>
+void preProcessRowScalar(const uint32_t* s_m1, const uint32_t* s_0, const uint32_t* s_p1, const uint32_t* s_p2, int srcWidth, int xFirst, int xLast,
+                         const xbrz::ScalerCfg& cfg, BlendResult* results)
+{
+    for (int x = xFirst; x < xLast; ++x)
+    {
+        const int x_m1 = std::max(x - 1, 0);
+        const int x_p1 = std::min(x + 1, srcWidth - 1);
+        const int x_p2 = std::min(x + 2, srcWidth - 1);
+
+        Kernel_4x4 ker = {}; //perf: initialization is negligible
+        ker.a = s_m1[x_m1]; //read sequentially from memory as far as possible
+        ker.b = s_m1[x];
+        ker.c = s_m1[x_p1];
+        ker.d = s_m1[x_p2];
+
+        ker.e = s_0[x_m1];
+        ker.f = s_0[x];
+        ker.g = s_0[x_p1];
+        ker.h = s_0[x_p2];
+
+        ker.i = s_p1[x_m1];
+        ker.j = s_p1[x];
+        ker.k = s_p1[x_p1];
+        ker.l = s_p1[x_p2];
+
+        ker.m = s_p2[x_m1];
+        ker.n = s_p2[x];
+        ker.o = s_p2[x_p1];
+        ker.p = s_p2[x_p2];
+
+        results[x] = preProcessCorners<ColorDistance>(ker, cfg);
+    }
+}
+
+#ifdef XBRZ_AVX2
+//a1 < a2 ? a1 * d + 255 * (a2 - a1) : a2 * d + 255 * (a1 - a2)
+CPU_TARGET_AVX2 FORCE_INLINE
+__m256d applyAlphaAvx2(__m256d dist, __m128i alpha1, __m128i alpha2)
+{
+    const __m256d a1 = _mm256_div_pd(_mm256_cvtepi32_pd(alpha1), _mm256_set1_pd(255.0));
+    const __m256d a2 = _mm256_div_pd(_mm256_cvtepi32_pd(alpha2), _mm256_set1_pd(255.0));
+    const __m256d minAlpha = _mm256_min_pd(a1, a2);
+    const __m256d maxAlpha = _mm256_max_pd(a1, a2);
+    return _mm256_add_pd(_mm256_mul_pd(minAlpha, dist), _mm256_mul_pd(_mm256_set1_pd(255), _mm256_sub_pd(maxAlpha, minAlpha)));
+}
+
+//same result as ColorDistanceRGB/ColorDistanceARGB::dist() for 8 pairs of pixels, as 2x4 doubles
+CPU_TARGET_AVX2 FORCE_INLINE
+void distAvx2(const float* table, __m256i pix1, __m256i pix2, bool withAlpha, __m256d& distLo, __m256d& distHi)
+{
+    //the table index is (diff + 255) / 2 for each channel, i.e floor((col1 + (255 - col2)) / 2)
+    const __m256i inv = _mm256_xor_si256(pix2, _mm256_set1_epi32(-1));
+    const __m256i roundedUp = _mm256_avg_epu8(pix1, inv);
+    __m256i index = _mm256_sub_epi8(roundedUp, _mm256_and_si256(_mm256_xor_si256(pix1, inv), _mm256_set1_epi8(1)));
+    index = _mm256_and_si256(index, _mm256_set1_epi32(0x00ffffff));
+
+    const __m256 dist = _mm256_i32gather_ps(table, index, 4);
+    distLo = _mm256_cvtps_pd(_mm256_castps256_ps128(dist));
+    distHi = _mm256_cvtps_pd(_mm256_extractf128_ps(dist, 1));
+
+    if (withAlpha)
+    {
+        const __m256i alpha1 = _mm256_srli_epi32(pix1, 24);
+        const __m256i alpha2 = _mm256_srli_epi32(pix2, 24);
+        distLo = applyAlphaAvx2(distLo, _mm256_castsi256_si128(alpha1), _mm256_castsi256_si128(alpha2));
+        distHi = applyAlphaAvx2(distHi, _mm256_extracti128_si256(alpha1, 1), _mm256_extracti128_si256(alpha2, 1));
+    }
+}
+
+CPU_TARGET_AVX2 FORCE_INLINE
+__m256i loadAvx2(const uint32_t* ptr)
+{
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+}
+
+CPU_TARGET_AVX2 FORCE_INLINE
+int equalMaskAvx2(__m256i a, __m256i b)
+{
+    return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)));
+}
+
+//bit n is set if lane n of (lo1, hi1) < lane n of (lo2, hi2)
+CPU_TARGET_AVX2 FORCE_INLINE
+int lessMaskAvx2(__m256d lo1, __m256d lo2, __m256d hi1, __m256d hi2)
+{
+    return _mm256_movemask_pd(_mm256_cmp_pd(lo1, lo2, _CMP_LT_OQ)) | (_mm256_movemask_pd(_mm256_cmp_pd(hi1, hi2, _CMP_LT_OQ)) << 4);
+}
+
+//vectorized version of preProcessCorners() for 8 pixels at a time, returns the first pixel that was not processed
+//only processes pixels [1, srcWidth - 2), for which the kernel is entirely inside the row (no clamping needed)
+CPU_TARGET_AVX2
+int preProcessRowAvx2(const uint32_t* s_m1, const uint32_t* s_0, const uint32_t* s_p1, const uint32_t* s_p2, int srcWidth,
+                      const xbrz::ScalerCfg& cfg, bool withAlpha, BlendResult* results)
+{
+    const float* table = DistYCbCrBuffer::getTable();
+    const __m256d weight = _mm256_set1_pd(4);
+    const __m256d threshold = _mm256_set1_pd(cfg.dominantDirectionThreshold);
+
+    int x = 1;
+    for (; x + 8 + 2 <= srcWidth; x += 8)
+    {
+        const __m256i b = loadAvx2(s_m1 + x);
+        const __m256i c = loadAvx2(s_m1 + x + 1);
+        const __m256i e = loadAvx2(s_0 + x - 1);
+        const __m256i f = loadAvx2(s_0 + x);
+        const __m256i g = loadAvx2(s_0 + x + 1);
+        const __m256i h = loadAvx2(s_0 + x + 2);
+        const __m256i i = loadAvx2(s_p1 + x - 1);
+        const __m256i j = loadAvx2(s_p1 + x);
+        const __m256i k = loadAvx2(s_p1 + x + 1);
+        const __m256i l = loadAvx2(s_p1 + x + 2);
+        const __m256i n = loadAvx2(s_p2 + x);
+        const __m256i o = loadAvx2(s_p2 + x + 1);
+
+        const int eqFG = equalMaskAvx2(f, g);
+        const int eqJK = equalMaskAvx2(j, k);
+        const int eqFJ = equalMaskAvx2(f, j);
+        const int eqGK = equalMaskAvx2(g, k);
+        const int skip = (eqFG & eqJK) | (eqFJ & eqGK);
+
+        __m256d d1[2], d2[2], d3[2], d4[2], d5[2];
+        __m256d jg[2], fk[2];
+
+        //same order of operations as preProcessCorners(), for identical rounding
+        distAvx2(table, i, f, withAlpha, d1[0], d1[1]);
+        distAvx2(table, f, c, withAlpha, d2[0], d2[1]);
+        distAvx2(table, n, k, withAlpha, d3[0], d3[1]);
+        distAvx2(table, k, h, withAlpha, d4[0], d4[1]);
+        distAvx2(table, j, g, withAlpha, d5[0], d5[1]);
+        for (int half = 0; half < 2; half++)
+            jg[half] = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_add_pd(d1[half], d2[half]), d3[half]), d4[half]), _mm256_mul_pd(weight, d5[half]));
+
+        distAvx2(table, e, j, withAlpha, d1[0], d1[1]);
+        distAvx2(table, j, o, withAlpha, d2[0], d2[1]);
+        distAvx2(table, b, g, withAlpha, d3[0], d3[1]);
+        distAvx2(table, g, l, withAlpha, d4[0], d4[1]);
+        distAvx2(table, f, k, withAlpha, d5[0], d5[1]);
+        for (int half = 0; half < 2; half++)
+            fk[half] = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_add_pd(d1[half], d2[half]), d3[half]), d4[half]), _mm256_mul_pd(weight, d5[half]));
+
+        const int jgLess = lessMaskAvx2(jg[0], fk[0], jg[1], fk[1]);
+        const int fkLess = lessMaskAvx2(fk[0], jg[0], fk[1], jg[1]);
+        const int jgDominant = lessMaskAvx2(_mm256_mul_pd(threshold, jg[0]), fk[0], _mm256_mul_pd(threshold, jg[1]), fk[1]);
+        const int fkDominant = lessMaskAvx2(_mm256_mul_pd(threshold, fk[0]), jg[0], _mm256_mul_pd(threshold, fk[1]), jg[1]);
+
+        for (int lane = 0; lane < 8; lane++)
+        {
+            const int bit = 1 << lane;
+            BlendResult& result = results[x + lane];
+            result = {};
+            if (skip & bit)
+                continue;
+
+            if (jgLess & bit)
+            {
+                const BlendType blend = (jgDominant & bit) ? BLEND_DOMINANT : BLEND_NORMAL;
+                if (!(eqFG & bit) && !(eqFJ & bit))
+                    result.blend_f = blend;
+                if (!(eqJK & bit) && !(eqGK & bit))
+                    result.blend_k = blend;
+            }
+            else if (fkLess & bit)
+            {
+                const BlendType blend = (fkDominant & bit) ? BLEND_DOMINANT : BLEND_NORMAL;
+                if (!(eqFJ & bit) && !(eqJK & bit))
+                    result.blend_j = blend;
+                if (!(eqFG & bit) && !(eqGK & bit))
+                    result.blend_g = blend;
+            }
+        }
+    }
+    return x;
+}
+#endif
+
+template <class ColorDistance>
+void preProcessRow(const uint32_t* s_m1, const uint32_t* s_0, const uint32_t* s_p1, const uint32_t* s_p2, int srcWidth,
+                   const xbrz::ScalerCfg& cfg, BlendResult* results)
+{
+    int x = 0;
+#ifdef XBRZ_AVX2
+    if (srcWidth > 1 && CpuFeatures::IsEnabled(CpuTier::Avx2))
+    {
+        preProcessRowScalar<ColorDistance>(s_m1, s_0, s_p1, s_p2, srcWidth, 0, 1, cfg, results);
+        x = preProcessRowAvx2(s_m1, s_0, s_p1, s_p2, srcWidth, cfg, ColorDistance::hasAlpha, results);
+    }
+#endif
+    preProcessRowScalar<ColorDistance>(s_m1, s_0, s_p1, s_p2, srcWidth, x, srcWidth, cfg, results);
+}
+
 struct Kernel_3x3
 {
     uint32_t
@@ -348,6 +557,32 @@ template <> inline unsigned char rotateBlendInfo<ROT_180>(unsigned char b) { ret
 template <> inline unsigned char rotateBlendInfo<ROT_270>(unsigned char b) { return ((b << 6) | (b >> 2)) & 0xff; }
 
 
+enum BlendShape //result of the blending decision for one corner
+{
+    SHAPE_CORNER,
+    SHAPE_DIAGONAL,
+    SHAPE_SHALLOW,
+    SHAPE_STEEP,
+    SHAPE_STEEP_AND_SHALLOW
+};
+
+template <class Scaler, RotationDegree rotDeg>
+FORCE_INLINE
+void applyBlend(BlendShape shape, uint32_t px, uint32_t* target, int trgWidth)
+{
+    OutputMatrix<Scaler::scale, rotDeg> out(target, trgWidth);
+
+    switch (shape)
+    {
+        case SHAPE_CORNER:            Scaler::blendCorner(px, out); break;
+        case SHAPE_DIAGONAL:          Scaler::blendLineDiagonal(px, out); break;
+        case SHAPE_SHALLOW:           Scaler::blendLineShallow(px, out); break;
+        case SHAPE_STEEP:             Scaler::blendLineSteep(px, out); break;
+        case SHAPE_STEEP_AND_SHALLOW: Scaler::blendLineSteepAndShallow(px, out); break;
+    }
+}
+
+
 /*
 input kernel area naming convention:
 -------------
@@ -403,8 +638,7 @@ void blendPixel(const Kernel_3x3& ker,
 
         const uint32_t px = dist(e, f) <= dist(e, h) ? f : h; //choose most similar color
 
-        OutputMatrix<Scaler::scale, rotDeg> out(target, trgWidth);
-
+        BlendShape shape = SHAPE_CORNER;
         if (doLineBlend)
         {
             const double fg = dist(f, g); //test sample: 70% of values max(fg, hc) / min(fg, hc) are between 1.1 and 3.7 with median being 1.9
@@ -414,22 +648,11 @@ void blendPixel(const Kernel_3x3& ker,
             const bool haveSteepLine   = cfg.steepDirectionThreshold * hc <= fg && e != c && b != c;
 
             if (haveShallowLine)
-            {
-                if (haveSteepLine)
-                    Scaler::blendLineSteepAndShallow(px, out);
-                else
-                    Scaler::blendLineShallow(px, out);
-            }
+                shape = haveSteepLine ? SHAPE_STEEP_AND_SHALLOW : SHAPE_SHALLOW;
             else
-            {
-                if (haveSteepLine)
-                    Scaler::blendLineSteep(px, out);
-                else
-                    Scaler::blendLineDiagonal(px,out);
-            }
+                shape = haveSteepLine ? SHAPE_STEEP : SHAPE_DIAGONAL;
         }
-        else
-            Scaler::blendCorner(px, out);
+        applyBlend<Scaler, rotDeg>(shape, px, target, trgWidth);
     }
 
 #undef a
@@ -444,6 +667,173 @@ void blendPixel(const Kernel_3x3& ker,
 }
 
 
+#ifdef XBRZ_AVX2
+//corners of the current row that need blending: the blending decision (same as blendPixel()) is evaluated for
+//8 corners at a time, then the corners are blended in their original order (the blends of a pixel's rotations overlap)
+struct BlendTasks
+{
+    explicit BlendTasks(int capacity) : //capacity + 8: the last group of 8 corners is read and written past the end
+        b(capacity + 8), c(capacity + 8), d(capacity + 8), e(capacity + 8), f(capacity + 8), g(capacity + 8), h(capacity + 8), i(capacity + 8),
+        blend(capacity + 8), x(capacity), rot(capacity), px(capacity + 8), shape(capacity + 8), order(capacity) {}
+
+    //rotated kernel and blend info of each corner
+    std::vector<uint32_t> b, c, d, e, f, g, h, i;
+    std::vector<unsigned char> blend;
+    std::vector<int> x;
+    std::vector<RotationDegree> rot;
+
+    //result of the blending decision
+    std::vector<uint32_t> px;
+    std::vector<BlendShape> shape;
+
+    std::vector<int> order; //used by applyBlendTasks()
+
+    int count = 0;
+
+    template <RotationDegree rotDeg>
+    void add(const Kernel_3x3& ker, unsigned char blendInfo, int xPos)
+    {
+        const unsigned char rotBlend = rotateBlendInfo<rotDeg>(blendInfo);
+        if (getBottomR(rotBlend) < BLEND_NORMAL)
+            return;
+
+        b[count] = get_b<rotDeg>(ker);
+        c[count] = get_c<rotDeg>(ker);
+        d[count] = get_d<rotDeg>(ker);
+        e[count] = get_e<rotDeg>(ker);
+        f[count] = get_f<rotDeg>(ker);
+        g[count] = get_g<rotDeg>(ker);
+        h[count] = get_h<rotDeg>(ker);
+        i[count] = get_i<rotDeg>(ker);
+        blend[count] = rotBlend;
+        x[count] = xPos;
+        rot[count] = rotDeg;
+        count++;
+    }
+};
+
+//bit n is set if ColorDistance::dist() < equalColorTolerance for lane n
+CPU_TARGET_AVX2 FORCE_INLINE
+int eqMaskAvx2(const float* table, __m256i pix1, __m256i pix2, bool withAlpha, __m256d tolerance)
+{
+    __m256d distLo, distHi;
+    distAvx2(table, pix1, pix2, withAlpha, distLo, distHi);
+    return lessMaskAvx2(distLo, tolerance, distHi, tolerance);
+}
+
+//bit n is set if lane n of (lo1, hi1) <= lane n of (lo2, hi2)
+CPU_TARGET_AVX2 FORCE_INLINE
+int lessEqualMaskAvx2(__m256d lo1, __m256d lo2, __m256d hi1, __m256d hi2)
+{
+    return _mm256_movemask_pd(_mm256_cmp_pd(lo1, lo2, _CMP_LE_OQ)) | (_mm256_movemask_pd(_mm256_cmp_pd(hi1, hi2, _CMP_LE_OQ)) << 4);
+}
+
+//vectorized version of the blending decision in blendPixel(), for 8 corners at a time
+//all distances are computed for every corner (blendPixel() only computes the ones it needs), the results are identical
+CPU_TARGET_AVX2
+void evaluateBlendAvx2(BlendTasks& tasks, const xbrz::ScalerCfg& cfg, bool withAlpha)
+{
+    const float* table = DistYCbCrBuffer::getTable();
+    const __m256d tolerance = _mm256_set1_pd(cfg.equalColorTolerance);
+    const __m256d threshold = _mm256_set1_pd(cfg.steepDirectionThreshold);
+
+    for (int t = 0; t < tasks.count; t += 8)
+    {
+        const __m256i b = loadAvx2(&tasks.b[t]);
+        const __m256i c = loadAvx2(&tasks.c[t]);
+        const __m256i d = loadAvx2(&tasks.d[t]);
+        const __m256i e = loadAvx2(&tasks.e[t]);
+        const __m256i f = loadAvx2(&tasks.f[t]);
+        const __m256i g = loadAvx2(&tasks.g[t]);
+        const __m256i h = loadAvx2(&tasks.h[t]);
+        const __m256i i = loadAvx2(&tasks.i[t]);
+
+        const int eqEG = eqMaskAvx2(table, e, g, withAlpha, tolerance);
+        const int eqEC = eqMaskAvx2(table, e, c, withAlpha, tolerance);
+        const int eqEI = eqMaskAvx2(table, e, i, withAlpha, tolerance);
+        const int eqLShape = eqMaskAvx2(table, g, h, withAlpha, tolerance) & eqMaskAvx2(table, h, i, withAlpha, tolerance) &
+                             eqMaskAvx2(table, i, f, withAlpha, tolerance) & eqMaskAvx2(table, f, c, withAlpha, tolerance);
+
+        __m256d ef[2], eh[2], fg[2], hc[2];
+        distAvx2(table, e, f, withAlpha, ef[0], ef[1]);
+        distAvx2(table, e, h, withAlpha, eh[0], eh[1]);
+        distAvx2(table, f, g, withAlpha, fg[0], fg[1]);
+        distAvx2(table, h, c, withAlpha, hc[0], hc[1]);
+
+        const int pickF = lessEqualMaskAvx2(ef[0], eh[0], ef[1], eh[1]);
+        const int shallow = lessEqualMaskAvx2(_mm256_mul_pd(threshold, fg[0]), hc[0], _mm256_mul_pd(threshold, fg[1]), hc[1]) &
+                            ~equalMaskAvx2(e, g) & ~equalMaskAvx2(d, g);
+        const int steep = lessEqualMaskAvx2(_mm256_mul_pd(threshold, hc[0]), fg[0], _mm256_mul_pd(threshold, hc[1]), fg[1]) &
+                          ~equalMaskAvx2(e, c) & ~equalMaskAvx2(b, c);
+
+        //blend info of the 8 corners: bottom right >= BLEND_DOMINANT (bit 5), top right and bottom left != BLEND_NONE
+        const __m128i blend = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&tasks.blend[t]));
+        const int dominant = _mm_movemask_epi8(_mm_slli_epi16(blend, 2)) & 0xff;
+        const int topR = ~_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(blend, _mm_set1_epi8(0x0c)), _mm_setzero_si128())) & 0xff;
+        const int bottomL = ~_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(blend, _mm_set1_epi8((char)0xc0)), _mm_setzero_si128())) & 0xff;
+
+        //same conditions as doLineBlend in blendPixel()
+        const int noLineBlend = ~dominant & ((topR & ~eqEG) | (bottomL & ~eqEC) | (~eqEI & eqLShape));
+        const int lineBlend = ~noLineBlend;
+
+        const __m256i laneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+        const __m256i pickFMask = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(pickF), laneBits), laneBits);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&tasks.px[t]), _mm256_blendv_epi8(h, f, pickFMask));
+
+        static const BlendShape shapes[8] = { //index: line blend | shallow << 1 | steep << 2
+            SHAPE_CORNER, SHAPE_DIAGONAL, SHAPE_CORNER, SHAPE_SHALLOW, SHAPE_CORNER, SHAPE_STEEP, SHAPE_CORNER, SHAPE_STEEP_AND_SHALLOW
+        };
+        for (int lane = 0; lane < 8; lane++)
+            tasks.shape[t + lane] = shapes[((lineBlend >> lane) & 1) | (((shallow >> lane) & 1) << 1) | (((steep >> lane) & 1) << 2)];
+    }
+}
+
+template <class Scaler, RotationDegree rotDeg>
+void applyBlendGroup(const BlendTasks& tasks, int first, int last, BlendShape shape, uint32_t* out, int trgWidth)
+{
+    for (int k = first; k < last; k++)
+    {
+        const int n = tasks.order[k];
+        applyBlend<Scaler, rotDeg>(shape, tasks.px[n], out + tasks.x[n] * Scaler::scale, trgWidth);
+    }
+}
+
+template <class Scaler>
+void applyBlendTasks(BlendTasks& tasks, uint32_t* out, int trgWidth)
+{
+    //blend the corners grouped by rotation, then by shape: each blend function is called in a loop, and the rotations
+    //of each pixel are still applied in the same order as blendPixel() (corners of different pixels never overlap)
+    const int groupCount = 4 * 5;
+    int groupEnd[groupCount] = {};
+    for (int n = 0; n < tasks.count; n++)
+        groupEnd[tasks.rot[n] * 5 + tasks.shape[n]]++;
+    for (int k = 1; k < groupCount; k++)
+        groupEnd[k] += groupEnd[k - 1];
+
+    int groupStart[groupCount];
+    for (int k = 0; k < groupCount; k++)
+        groupStart[k] = k == 0 ? 0 : groupEnd[k - 1];
+
+    int next[groupCount];
+    std::copy(groupStart, groupStart + groupCount, next);
+    for (int n = 0; n < tasks.count; n++)
+        tasks.order[next[tasks.rot[n] * 5 + tasks.shape[n]]++] = n;
+
+    for (int k = 0; k < groupCount; k++)
+    {
+        const BlendShape shape = static_cast<BlendShape>(k % 5);
+        switch (static_cast<RotationDegree>(k / 5))
+        {
+            case ROT_0:   applyBlendGroup<Scaler, ROT_0  >(tasks, groupStart[k], groupEnd[k], shape, out, trgWidth); break;
+            case ROT_90:  applyBlendGroup<Scaler, ROT_90 >(tasks, groupStart[k], groupEnd[k], shape, out, trgWidth); break;
+            case ROT_180: applyBlendGroup<Scaler, ROT_180>(tasks, groupStart[k], groupEnd[k], shape, out, trgWidth); break;
+            case ROT_270: applyBlendGroup<Scaler, ROT_270>(tasks, groupStart[k], groupEnd[k], shape, out, trgWidth); break;
+        }
+    }
+}
+#endif
+
+
 template <class Scaler, class ColorDistance> //scaler policy: see "Scaler2x" reference implementation
 void scaleImage(const uint32_t* src, uint32_t* trg, int srcWidth, int srcHeight, const xbrz::ScalerCfg& cfg, int yFirst, int yLast)
 {
@@ -461,6 +851,14 @@ void scaleImage(const uint32_t* src, uint32_t* trg, int srcWidth, int srcHeight,
     std::fill(preProcBuffer, preProcBuffer + bufferSize, 0);
     static_assert(BLEND_NONE == 0, "");
 
+    //preprocessing results for the current row, computed for the whole row at once (allows the use of SIMD)
+    std::vector<BlendResult> rowResults(srcWidth);
+
+#ifdef XBRZ_AVX2
+    const bool vectorBlend = CpuFeatures::IsEnabled(CpuTier::Avx2);
+    BlendTasks blendTasks(vectorBlend ? srcWidth * 4 : 0);
+#endif
+
     //initialize preprocessing buffer for first row of current stripe: detect upper left and right corner blending
     //this cannot be optimized for adjacent processing stripes; we must not allow for a memory race condition!
     if (yFirst > 0)
@@ -472,34 +870,11 @@ void scaleImage(const uint32_t* src, uint32_t* trg, int srcWidth, int srcHeight,
         const uint32_t* s_p1 = src + srcWidth * std::min(y + 1, srcHeight - 1);
         const uint32_t* s_p2 = src + srcWidth * std::min(y + 2, srcHeight - 1);
 
+        preProcessRow<ColorDistance>(s_m1, s_0, s_p1, s_p2, srcWidth, cfg, rowResults.data());
+
         for (int x = 0; x < srcWidth; ++x)
         {
-            const int x_m1 = std::max(x - 1, 0);
-            const int x_p1 = std::min(x + 1, srcWidth - 1);
-            const int x_p2 = std::min(x + 2, srcWidth - 1);
-
-            Kernel_4x4 ker = {}; //perf: initialization is negligible
-            ker.a = s_m1[x_m1]; //read sequentially from memory as far as possible
-            ker.b = s_m1[x];
-            ker.c = s_m1[x_p1];
-            ker.d = s_m1[x_p2];
-
-            ker.e = s_0[x_m1];
-            ker.f = s_0[x];
-            ker.g = s_0[x_p1];
-            ker.h = s_0[x_p2];
-
-            ker.i = s_p1[x_m1];
-            ker.j = s_p1[x];
-            ker.k = s_p1[x_p1];
-            ker.l = s_p1[x_p2];
-
-            ker.m = s_p2[x_m1];
-            ker.n = s_p2[x];
-            ker.o = s_p2[x_p1];
-            ker.p = s_p2[x_p2];
-
-            const BlendResult res = preProcessCorners<ColorDistance>(ker, cfg);
+            const BlendResult& res = rowResults[x];
             /*
             preprocessing blend result:
             ---------
@@ -525,8 +900,15 @@ void scaleImage(const uint32_t* src, uint32_t* trg, int srcWidth, int srcHeight,
         const uint32_t* s_p1 = src + srcWidth * std::min(y + 1, srcHeight - 1);
         const uint32_t* s_p2 = src + srcWidth * std::min(y + 2, srcHeight - 1);
 
+        preProcessRow<ColorDistance>(s_m1, s_0, s_p1, s_p2, srcWidth, cfg, rowResults.data());
+
         unsigned char blend_xy1 = 0; //corner blending for current (x, y + 1) position
 
+#ifdef XBRZ_AVX2
+        uint32_t* const rowOut = out;
+        blendTasks.count = 0;
+#endif
+
         for (int x = 0; x < srcWidth; ++x, out += Scaler::scale)
         {
             //all those bounds checks have only insignificant impact on performance!
@@ -559,7 +941,7 @@ void scaleImage(const uint32_t* src, uint32_t* trg, int srcWidth, int srcHeight,
             //evaluate the four corners on bottom-right of current pixel
             unsigned char blend_xy = 0; //for current (x, y) position
             {
-                const BlendResult res = preProcessCorners<ColorDistance>(ker4, cfg);
+                const BlendResult& res = rowResults[x];
                 /*
                 preprocessing blend result:
                 ---------
@@ -601,12 +983,31 @@ void scaleImage(const uint32_t* src, uint32_t* trg, int srcWidth, int srcHeight,
                 ker3.h = ker4.j;
                 ker3.i = ker4.k;
 
+#ifdef XBRZ_AVX2
+                if (vectorBlend)
+                {
+                    blendTasks.add<ROT_0  >(ker3, blend_xy, x);
+                    blendTasks.add<ROT_90 >(ker3, blend_xy, x);
+                    blendTasks.add<ROT_180>(ker3, blend_xy, x);
+                    blendTasks.add<ROT_270>(ker3, blend_xy, x);
+                    continue;
+                }
+#endif
                 blendPixel<Scaler, ColorDistance, ROT_0  >(ker3, out, trgWidth, blend_xy, cfg);
                 blendPixel<Scaler, ColorDistance, ROT_90 >(ker3, out, trgWidth, blend_xy, cfg);
                 blendPixel<Scaler, ColorDistance, ROT_180>(ker3, out, trgWidth, blend_xy, cfg);
                 blendPixel<Scaler, ColorDistance, ROT_270>(ker3, out, trgWidth, blend_xy, cfg);
             }
         }
+
+#ifdef XBRZ_AVX2
+        //each pixel's corners only write to its own output block, which the rest of the row doesn't touch
+        if (vectorBlend && blendTasks.count > 0)
+        {
+            evaluateBlendAvx2(blendTasks, cfg, ColorDistance::hasAlpha);
+            applyBlendTasks<Scaler>(blendTasks, rowOut, trgWidth);
+        }
+#endif
     }
 }
 
@@ -975,6 +1376,8 @@ struct Scaler6x : public ColorGradient
 
 struct ColorDistanceRGB
 {
+    static const bool hasAlpha = false;
+
     static double dist(uint32_t pix1, uint32_t pix2, double luminanceWeight)
     {
         return DistYCbCrBuffer::dist(pix1, pix2);
@@ -987,6 +1390,8 @@ struct ColorDistanceRGB
 
 struct ColorDistanceARGB
 {
+    static const bool hasAlpha = true;
+
     static double dist(uint32_t pix1, uint32_t pix2, double luminanceWeight)
     {
         const double a1 = getAlpha(pix1) / 255.0 ;